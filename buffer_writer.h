@@ -0,0 +1,63 @@
+#ifndef COMMON_BUFFER_WRITER_H_
+#define COMMON_BUFFER_WRITER_H_
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+namespace common {
+namespace internal {
+
+/// @class BufferWriter
+/// snprintf style writer into a caller supplied buffer. Output past the end
+/// of the buffer is dropped but still counted, so length() always reports
+/// the size of the complete text.
+class BufferWriter {
+ public:
+  /// @param buffer  destination, may be nullptr when @p size is zero
+  /// @param size  size of @p buffer including room for the terminator
+  BufferWriter(char* buffer, std::size_t size)
+      : buffer_(size == 0u ? nullptr : buffer),
+        capacity_(size == 0u ? 0u : size - 1u),
+        length_(0u) {}
+
+  void Append(const char* data, std::size_t size) {
+    if (length_ < capacity_) {
+      std::memcpy(buffer_ + length_, data,
+                  size < capacity_ - length_ ? size : capacity_ - length_);
+    }
+    length_ += size;
+  }
+
+  void Append(const char* data) { Append(data, std::strlen(data)); }
+
+  template <typename T>
+  void AppendNumber(T value) {
+    // enough for any 64 bit integer or shortest round-trip double
+    char digits[32];
+    std::to_chars_result result =
+        std::to_chars(digits, digits + sizeof(digits), value);
+    Append(digits, static_cast<std::size_t>(result.ptr - digits));
+  }
+
+  /// Null terminates the buffer, if it has any room at all
+  /// @return  length of the complete text, excluding the terminator
+  std::size_t Finish() {
+    if (buffer_ != nullptr) {
+      buffer_[length_ < capacity_ ? length_ : capacity_] = '\0';
+    }
+    return length_;
+  }
+
+  std::size_t length() const { return length_; }
+
+ private:
+  char* const buffer_;
+  const std::size_t capacity_;
+  std::size_t length_;
+};
+
+}  // namespace internal
+}  // namespace common
+
+#endif  // COMMON_BUFFER_WRITER_H_
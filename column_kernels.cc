@@ -0,0 +1,416 @@
+#include "common/column_kernels.h"
+
+#include <atomic>
+
+#include "common/error.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define REGISTRY_HAS_AVX2_KERNELS 1
+// compiles one function for AVX2 without requiring it of the whole build
+#define REGISTRY_AVX2 __attribute__((target("avx2")))
+#else
+#define REGISTRY_HAS_AVX2_KERNELS 0
+#endif
+
+namespace registry {
+
+namespace {
+
+bool CpuHasAvx2() {
+#if REGISTRY_HAS_AVX2_KERNELS
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+std::atomic<KernelIsa>& ActiveIsa() {
+  static std::atomic<KernelIsa> isa(CpuHasAvx2() ? KernelIsa::kAvx2
+                                                 : KernelIsa::kScalar);
+  return isa;
+}
+
+bool UseAvx2() {
+  return ActiveIsa().load(std::memory_order_relaxed) == KernelIsa::kAvx2;
+}
+
+template <typename T>
+void ScalarFilterColumn(const T* values, std::size_t count, CompareOp op,
+                        T operand, std::uint64_t* bitmask) {
+  for (std::size_t i = 0; i < BitmaskWords(count); ++i) {
+    bitmask[i] = 0u;
+  }
+  internal::ScalarFilter(values, 0u, count, op, operand, bitmask);
+}
+
+template <typename T>
+ColumnAggregate<T> ScalarAggregateColumn(const T* values, std::size_t count) {
+  ColumnAggregate<T> aggregate{0u, T{}, T{}, 0};
+  internal::ScalarAccumulate(values, count, &aggregate);
+  return aggregate;
+}
+
+#if REGISTRY_HAS_AVX2_KERNELS
+
+// Each policy maps one column type to its AVX2 operations. Compare() returns
+// one bit per lane, lane 0 in bit 0.
+struct Int32Avx2 {
+  using T = std::int32_t;
+  using Vector = __m256i;
+  using SumVector = __m256i;
+  static constexpr std::size_t kLanes = 8u;
+
+  REGISTRY_AVX2 static Vector Broadcast(T value) {
+    return _mm256_set1_epi32(value);
+  }
+  REGISTRY_AVX2 static Vector Load(const T* values) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+  }
+  REGISTRY_AVX2 static int Equal(Vector a, Vector b) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+  }
+  REGISTRY_AVX2 static int Greater(Vector a, Vector b) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)));
+  }
+  REGISTRY_AVX2 static Vector Min(Vector a, Vector b) {
+    return _mm256_min_epi32(a, b);
+  }
+  REGISTRY_AVX2 static Vector Max(Vector a, Vector b) {
+    return _mm256_max_epi32(a, b);
+  }
+  REGISTRY_AVX2 static SumVector ZeroSum() { return _mm256_setzero_si256(); }
+  // four 64 bit lanes, so that sums of 32 bit values do not wrap early
+  REGISTRY_AVX2 static SumVector Add(SumVector sum, Vector values) {
+    sum = _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+    return _mm256_add_epi64(
+        sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+  }
+  REGISTRY_AVX2 static void Store(T* out, Vector values) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), values);
+  }
+  REGISTRY_AVX2 static void StoreSum(std::int64_t* out, SumVector sum) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), sum);
+  }
+};
+
+struct Int64Avx2 {
+  using T = std::int64_t;
+  using Vector = __m256i;
+  using SumVector = __m256i;
+  static constexpr std::size_t kLanes = 4u;
+
+  REGISTRY_AVX2 static Vector Broadcast(T value) {
+    return _mm256_set1_epi64x(value);
+  }
+  REGISTRY_AVX2 static Vector Load(const T* values) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+  }
+  REGISTRY_AVX2 static int Equal(Vector a, Vector b) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+  }
+  REGISTRY_AVX2 static int Greater(Vector a, Vector b) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b)));
+  }
+  // AVX2 has no 64 bit min and max
+  REGISTRY_AVX2 static Vector Min(Vector a, Vector b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+  }
+  REGISTRY_AVX2 static Vector Max(Vector a, Vector b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a));
+  }
+  REGISTRY_AVX2 static SumVector ZeroSum() { return _mm256_setzero_si256(); }
+  REGISTRY_AVX2 static SumVector Add(SumVector sum, Vector values) {
+    return _mm256_add_epi64(sum, values);
+  }
+  REGISTRY_AVX2 static void Store(T* out, Vector values) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), values);
+  }
+  REGISTRY_AVX2 static void StoreSum(std::int64_t* out, SumVector sum) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), sum);
+  }
+};
+
+struct FloatAvx2 {
+  using T = float;
+  using Vector = __m256;
+  using SumVector = __m256d;
+  static constexpr std::size_t kLanes = 8u;
+
+  REGISTRY_AVX2 static Vector Broadcast(T value) {
+    return _mm256_set1_ps(value);
+  }
+  REGISTRY_AVX2 static Vector Load(const T* values) {
+    return _mm256_loadu_ps(values);
+  }
+  template <int kPredicate>
+  REGISTRY_AVX2 static int Compare(Vector a, Vector b) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(a, b, kPredicate));
+  }
+  REGISTRY_AVX2 static Vector Min(Vector a, Vector b) {
+    return _mm256_min_ps(a, b);
+  }
+  REGISTRY_AVX2 static Vector Max(Vector a, Vector b) {
+    return _mm256_max_ps(a, b);
+  }
+  REGISTRY_AVX2 static SumVector ZeroSum() { return _mm256_setzero_pd(); }
+  REGISTRY_AVX2 static SumVector Add(SumVector sum, Vector values) {
+    sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm256_castps256_ps128(values)));
+    return _mm256_add_pd(sum,
+                         _mm256_cvtps_pd(_mm256_extractf128_ps(values, 1)));
+  }
+  REGISTRY_AVX2 static void Store(T* out, Vector values) {
+    _mm256_storeu_ps(out, values);
+  }
+  REGISTRY_AVX2 static void StoreSum(double* out, SumVector sum) {
+    _mm256_storeu_pd(out, sum);
+  }
+};
+
+struct DoubleAvx2 {
+  using T = double;
+  using Vector = __m256d;
+  using SumVector = __m256d;
+  static constexpr std::size_t kLanes = 4u;
+
+  REGISTRY_AVX2 static Vector Broadcast(T value) {
+    return _mm256_set1_pd(value);
+  }
+  REGISTRY_AVX2 static Vector Load(const T* values) {
+    return _mm256_loadu_pd(values);
+  }
+  template <int kPredicate>
+  REGISTRY_AVX2 static int Compare(Vector a, Vector b) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(a, b, kPredicate));
+  }
+  REGISTRY_AVX2 static Vector Min(Vector a, Vector b) {
+    return _mm256_min_pd(a, b);
+  }
+  REGISTRY_AVX2 static Vector Max(Vector a, Vector b) {
+    return _mm256_max_pd(a, b);
+  }
+  REGISTRY_AVX2 static SumVector ZeroSum() { return _mm256_setzero_pd(); }
+  REGISTRY_AVX2 static SumVector Add(SumVector sum, Vector values) {
+    return _mm256_add_pd(sum, values);
+  }
+  REGISTRY_AVX2 static void Store(T* out, Vector values) {
+    _mm256_storeu_pd(out, values);
+  }
+  REGISTRY_AVX2 static void StoreSum(double* out, SumVector sum) {
+    _mm256_storeu_pd(out, sum);
+  }
+};
+
+// Integers compare with only == and >, the other operators swap the
+// operands or invert the lanes
+template <typename Policy, CompareOp kOp>
+REGISTRY_AVX2 int CompareLanes(typename Policy::Vector value,
+                               typename Policy::Vector operand) {
+  constexpr int kAllLanes = (1 << Policy::kLanes) - 1;
+  if constexpr (std::is_floating_point<typename Policy::T>::value) {
+    // ordered predicates are false for NaN, kNotEqual is unordered and true
+    constexpr int kPredicate =
+        kOp == CompareOp::kLess           ? _CMP_LT_OQ
+        : kOp == CompareOp::kLessEqual    ? _CMP_LE_OQ
+        : kOp == CompareOp::kEqual        ? _CMP_EQ_OQ
+        : kOp == CompareOp::kNotEqual     ? _CMP_NEQ_UQ
+        : kOp == CompareOp::kGreaterEqual ? _CMP_GE_OQ
+                                          : _CMP_GT_OQ;
+    return Policy::template Compare<kPredicate>(value, operand);
+  } else if constexpr (kOp == CompareOp::kLess) {
+    return Policy::Greater(operand, value);
+  } else if constexpr (kOp == CompareOp::kLessEqual) {
+    return ~Policy::Greater(value, operand) & kAllLanes;
+  } else if constexpr (kOp == CompareOp::kEqual) {
+    return Policy::Equal(value, operand);
+  } else if constexpr (kOp == CompareOp::kNotEqual) {
+    return ~Policy::Equal(value, operand) & kAllLanes;
+  } else if constexpr (kOp == CompareOp::kGreaterEqual) {
+    return ~Policy::Greater(operand, value) & kAllLanes;
+  } else {
+    return Policy::Greater(value, operand);
+  }
+}
+
+template <typename Policy, CompareOp kOp>
+REGISTRY_AVX2 void FilterAvx2(const typename Policy::T* values,
+                              std::size_t count, typename Policy::T operand,
+                              std::uint64_t* bitmask) {
+  const typename Policy::Vector broadcast = Policy::Broadcast(operand);
+  const std::size_t words = count / 64u;
+  for (std::size_t word = 0; word < words; ++word) {
+    const typename Policy::T* block = values + word * 64u;
+    std::uint64_t bits = 0u;
+    for (std::size_t lane = 0; lane < 64u; lane += Policy::kLanes) {
+      bits |= static_cast<std::uint64_t>(CompareLanes<Policy, kOp>(
+                  Policy::Load(block + lane), broadcast))
+              << lane;
+    }
+    bitmask[word] = bits;
+  }
+  if (count % 64u != 0u) {
+    bitmask[words] = 0u;
+    internal::ScalarFilter(values, words * 64u, count, kOp, operand, bitmask);
+  }
+}
+
+template <typename Policy>
+void FilterAvx2(const typename Policy::T* values, std::size_t count,
+                CompareOp op, typename Policy::T operand,
+                std::uint64_t* bitmask) {
+  switch (op) {
+    case CompareOp::kLess:
+      return FilterAvx2<Policy, CompareOp::kLess>(values, count, operand,
+                                                  bitmask);
+    case CompareOp::kLessEqual:
+      return FilterAvx2<Policy, CompareOp::kLessEqual>(values, count, operand,
+                                                       bitmask);
+    case CompareOp::kEqual:
+      return FilterAvx2<Policy, CompareOp::kEqual>(values, count, operand,
+                                                   bitmask);
+    case CompareOp::kNotEqual:
+      return FilterAvx2<Policy, CompareOp::kNotEqual>(values, count, operand,
+                                                      bitmask);
+    case CompareOp::kGreaterEqual:
+      return FilterAvx2<Policy, CompareOp::kGreaterEqual>(values, count,
+                                                          operand, bitmask);
+    case CompareOp::kGreater:
+      return FilterAvx2<Policy, CompareOp::kGreater>(values, count, operand,
+                                                     bitmask);
+      // no default. Let -werror=switch catch missing enum cases
+  }
+}
+
+template <typename Policy>
+REGISTRY_AVX2 ColumnAggregate<typename Policy::T> AggregateAvx2(
+    const typename Policy::T* values, std::size_t count) {
+  using T = typename Policy::T;
+  using Sum = typename ColumnAggregate<T>::Sum;
+  ColumnAggregate<T> aggregate{0u, T{}, T{}, 0};
+  const std::size_t vectorized = count / Policy::kLanes * Policy::kLanes;
+  if (vectorized != 0u) {
+    typename Policy::Vector min = Policy::Load(values);
+    typename Policy::Vector max = min;
+    typename Policy::SumVector sum = Policy::ZeroSum();
+    for (std::size_t i = 0; i < vectorized; i += Policy::kLanes) {
+      const typename Policy::Vector lanes = Policy::Load(values + i);
+      min = Policy::Min(min, lanes);
+      max = Policy::Max(max, lanes);
+      sum = Policy::Add(sum, lanes);
+    }
+    T mins[Policy::kLanes];
+    T maxes[Policy::kLanes];
+    Sum sums[4];
+    Policy::Store(mins, min);
+    Policy::Store(maxes, max);
+    Policy::StoreSum(sums, sum);
+    aggregate.count = vectorized;
+    aggregate.min = mins[0];
+    aggregate.max = maxes[0];
+    for (std::size_t lane = 1; lane < Policy::kLanes; ++lane) {
+      aggregate.min = mins[lane] < aggregate.min ? mins[lane] : aggregate.min;
+      aggregate.max = aggregate.max < maxes[lane] ? maxes[lane] : aggregate.max;
+    }
+    // wrapping, as the lanes did
+    using Accumulator = std::conditional_t<std::is_floating_point<T>::value,
+                                           double, std::uint64_t>;
+    Accumulator total = 0;
+    for (Sum lane : sums) {
+      total += static_cast<Accumulator>(lane);
+    }
+    aggregate.sum = static_cast<Sum>(total);
+  }
+  internal::ScalarAccumulate(values + vectorized, count - vectorized,
+                             &aggregate);
+  return aggregate;
+}
+
+#endif  // REGISTRY_HAS_AVX2_KERNELS
+
+template <typename Policy, typename T>
+void DispatchFilter(const T* values, std::size_t count, CompareOp op,
+                    T operand, std::uint64_t* bitmask) {
+#if REGISTRY_HAS_AVX2_KERNELS
+  if (UseAvx2()) {
+    FilterAvx2<Policy>(values, count, op, operand, bitmask);
+    return;
+  }
+#endif
+  ScalarFilterColumn(values, count, op, operand, bitmask);
+}
+
+template <typename Policy, typename T>
+ColumnAggregate<T> DispatchAggregate(const T* values, std::size_t count) {
+#if REGISTRY_HAS_AVX2_KERNELS
+  if (UseAvx2()) {
+    return AggregateAvx2<Policy>(values, count);
+  }
+#endif
+  return ScalarAggregateColumn(values, count);
+}
+
+#if !REGISTRY_HAS_AVX2_KERNELS
+// only named by the dispatch templates
+struct Int32Avx2 {};
+struct Int64Avx2 {};
+struct FloatAvx2 {};
+struct DoubleAvx2 {};
+#endif
+
+}  // namespace
+
+KernelIsa GetKernelIsa() {
+  return ActiveIsa().load(std::memory_order_relaxed);
+}
+
+common::ErrorOr<KernelIsa> SetKernelIsa(KernelIsa isa) {
+  if (isa == KernelIsa::kAvx2 && !CpuHasAvx2()) {
+    return common::Error::kUnavailable;
+  }
+  return ActiveIsa().exchange(isa, std::memory_order_relaxed);
+}
+
+namespace internal {
+
+void Filter(const std::int32_t* values, std::size_t count, CompareOp op,
+            std::int32_t operand, std::uint64_t* bitmask) {
+  DispatchFilter<Int32Avx2>(values, count, op, operand, bitmask);
+}
+
+void Filter(const std::int64_t* values, std::size_t count, CompareOp op,
+            std::int64_t operand, std::uint64_t* bitmask) {
+  DispatchFilter<Int64Avx2>(values, count, op, operand, bitmask);
+}
+
+void Filter(const float* values, std::size_t count, CompareOp op,
+            float operand, std::uint64_t* bitmask) {
+  DispatchFilter<FloatAvx2>(values, count, op, operand, bitmask);
+}
+
+void Filter(const double* values, std::size_t count, CompareOp op,
+            double operand, std::uint64_t* bitmask) {
+  DispatchFilter<DoubleAvx2>(values, count, op, operand, bitmask);
+}
+
+ColumnAggregate<std::int32_t> Aggregate(const std::int32_t* values,
+                                        std::size_t count) {
+  return DispatchAggregate<Int32Avx2>(values, count);
+}
+
+ColumnAggregate<std::int64_t> Aggregate(const std::int64_t* values,
+                                        std::size_t count) {
+  return DispatchAggregate<Int64Avx2>(values, count);
+}
+
+ColumnAggregate<float> Aggregate(const float* values, std::size_t count) {
+  return DispatchAggregate<FloatAvx2>(values, count);
+}
+
+ColumnAggregate<double> Aggregate(const double* values, std::size_t count) {
+  return DispatchAggregate<DoubleAvx2>(values, count);
+}
+
+}  // namespace internal
+
+}  // namespace registry
@@ -0,0 +1,234 @@
+#ifndef REGISTRY_COLUMN_KERNELS_H_
+#define REGISTRY_COLUMN_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "common/error_or.h"
+
+namespace registry {
+
+/// Comparison of a column value against an operand, value op operand
+enum class CompareOp {
+  kLess,
+  kLessEqual,
+  kEqual,
+  kNotEqual,
+  kGreaterEqual,
+  kGreater,
+};
+
+/// Instruction set the vectorized kernels run on
+enum class KernelIsa {
+  kScalar,
+  kAvx2,
+};
+
+/// Min, max, sum and count of a column or of its selected rows. min and max
+/// are T{} when count is 0. Integer sums wrap on overflow; floating point
+/// sums are accumulated in double, in an order that depends on the kernel
+/// path, so the last bits may differ between KernelIsa values.
+template <typename T>
+struct ColumnAggregate {
+  using Sum = std::conditional_t<
+      std::is_floating_point<T>::value, double,
+      std::conditional_t<std::is_signed<T>::value, std::int64_t,
+                         std::uint64_t>>;
+
+  std::size_t count;
+  T min;
+  T max;
+  Sum sum;
+};
+
+/// @return  the number of uint64_t words of a bitmask over @p count rows
+constexpr std::size_t BitmaskWords(std::size_t count) {
+  return (count + 63u) / 64u;
+}
+
+/// @return  the kernel path in use: the best the CPU supports, unless
+///          changed with SetKernelIsa()
+KernelIsa GetKernelIsa();
+
+/// Selects the kernel path, e.g. to compare paths in tests and benchmarks
+/// @return  the previous path, or Error::kUnavailable if the CPU does not
+///          support @p isa
+common::ErrorOr<KernelIsa> SetKernelIsa(KernelIsa isa);
+
+namespace internal {
+
+// types with vectorized kernels, every other scalar uses the templates below
+template <typename T>
+struct HasVectorKernels
+    : std::integral_constant<bool, std::is_same<T, std::int32_t>::value ||
+                                       std::is_same<T, std::int64_t>::value ||
+                                       std::is_same<T, float>::value ||
+                                       std::is_same<T, double>::value> {};
+
+template <typename T>
+bool Compare(T value, CompareOp op, T operand) {
+  switch (op) {
+    case CompareOp::kLess:
+      return value < operand;
+    case CompareOp::kLessEqual:
+      return value <= operand;
+    case CompareOp::kEqual:
+      return value == operand;
+    case CompareOp::kNotEqual:
+      return value != operand;
+    case CompareOp::kGreaterEqual:
+      return value >= operand;
+    case CompareOp::kGreater:
+      return value > operand;
+      // no default. Let -werror=switch catch missing enum cases
+  }
+  return false;
+}
+
+// Sets the bits of values [begin, end) in @p bitmask, whose other bits
+// between begin and end must be clear
+template <typename T>
+void ScalarFilter(const T* values, std::size_t begin, std::size_t end,
+                  CompareOp op, T operand, std::uint64_t* bitmask) {
+  for (std::size_t i = begin; i < end; ++i) {
+    bitmask[i / 64u] |= std::uint64_t{Compare(values[i], op, operand)}
+                        << (i % 64u);
+  }
+}
+
+template <typename T>
+void ScalarAccumulate(const T* values, std::size_t count,
+                      ColumnAggregate<T>* aggregate) {
+  using Sum = typename ColumnAggregate<T>::Sum;
+  if (count == 0u) {
+    return;
+  }
+  T min = aggregate->count == 0u ? values[0] : aggregate->min;
+  T max = aggregate->count == 0u ? values[0] : aggregate->max;
+  // unsigned so that integer sums wrap rather than overflow
+  using Accumulator = std::conditional_t<std::is_floating_point<T>::value,
+                                         double, std::uint64_t>;
+  Accumulator sum = static_cast<Accumulator>(aggregate->sum);
+  for (std::size_t i = 0; i < count; ++i) {
+    min = values[i] < min ? values[i] : min;
+    max = max < values[i] ? values[i] : max;
+    sum += static_cast<Accumulator>(values[i]);
+  }
+  aggregate->count += count;
+  aggregate->min = min;
+  aggregate->max = max;
+  aggregate->sum = static_cast<Sum>(sum);
+}
+
+template <typename T>
+void Merge(const ColumnAggregate<T>& from, ColumnAggregate<T>* into) {
+  if (from.count == 0u) {
+    return;
+  }
+  if (into->count == 0u) {
+    *into = from;
+    return;
+  }
+  into->count += from.count;
+  into->min = from.min < into->min ? from.min : into->min;
+  into->max = into->max < from.max ? from.max : into->max;
+  if constexpr (std::is_floating_point<T>::value) {
+    into->sum += from.sum;
+  } else {
+    into->sum = static_cast<typename ColumnAggregate<T>::Sum>(
+        static_cast<std::uint64_t>(into->sum) +
+        static_cast<std::uint64_t>(from.sum));
+  }
+}
+
+// Dispatching kernels, defined in column_kernels.cc
+void Filter(const std::int32_t* values, std::size_t count, CompareOp op,
+            std::int32_t operand, std::uint64_t* bitmask);
+void Filter(const std::int64_t* values, std::size_t count, CompareOp op,
+            std::int64_t operand, std::uint64_t* bitmask);
+void Filter(const float* values, std::size_t count, CompareOp op,
+            float operand, std::uint64_t* bitmask);
+void Filter(const double* values, std::size_t count, CompareOp op,
+            double operand, std::uint64_t* bitmask);
+
+ColumnAggregate<std::int32_t> Aggregate(const std::int32_t* values,
+                                        std::size_t count);
+ColumnAggregate<std::int64_t> Aggregate(const std::int64_t* values,
+                                        std::size_t count);
+ColumnAggregate<float> Aggregate(const float* values, std::size_t count);
+ColumnAggregate<double> Aggregate(const double* values, std::size_t count);
+
+}  // namespace internal
+
+/// Sets bit i of @p bitmask, BitmaskWords(count) words, to whether
+/// values[i] op operand, and clears the bits past @p count. A NaN compares
+/// as with the built-in operators: only kNotEqual holds.
+template <typename T>
+void FilterColumn(const T* values, std::size_t count, CompareOp op,
+                  T operand, std::uint64_t* bitmask) {
+  if constexpr (internal::HasVectorKernels<T>::value) {
+    internal::Filter(values, count, op, operand, bitmask);
+  } else {
+    for (std::size_t i = 0; i < BitmaskWords(count); ++i) {
+      bitmask[i] = 0u;
+    }
+    internal::ScalarFilter(values, 0u, count, op, operand, bitmask);
+  }
+}
+
+/// @return  the aggregate of the @p count values. min and max of values
+///          that include a NaN are unspecified.
+template <typename T>
+ColumnAggregate<T> AggregateColumn(const T* values, std::size_t count) {
+  if constexpr (internal::HasVectorKernels<T>::value) {
+    return internal::Aggregate(values, count);
+  } else {
+    ColumnAggregate<T> aggregate{0u, T{}, T{}, 0};
+    internal::ScalarAccumulate(values, count, &aggregate);
+    return aggregate;
+  }
+}
+
+/// @return  the aggregate of the values whose bit is set in @p selection,
+///          e.g. from FilterColumn(). Fully selected words of 64 rows use the
+///          vectorized kernels, empty words are skipped.
+template <typename T>
+ColumnAggregate<T> AggregateColumn(const T* values, std::size_t count,
+                                   const std::uint64_t* selection) {
+  ColumnAggregate<T> aggregate{0u, T{}, T{}, 0};
+  for (std::size_t word = 0; word < BitmaskWords(count); ++word) {
+    const std::size_t begin = word * 64u;
+    const std::size_t size = count - begin < 64u ? count - begin : 64u;
+    const std::uint64_t bits =
+        size == 64u ? selection[word]
+                    : selection[word] & ((std::uint64_t{1} << size) - 1u);
+    if (bits == ~std::uint64_t{0}) {
+      internal::Merge(AggregateColumn(values + begin, 64u), &aggregate);
+      continue;
+    }
+    for (std::uint64_t rest = bits; rest != 0u; rest &= rest - 1u) {
+      internal::ScalarAccumulate(values + begin + __builtin_ctzll(rest), 1u,
+                                 &aggregate);
+    }
+  }
+  return aggregate;
+}
+
+/// @return  the number of bits set among the first @p count of @p bitmask
+inline std::size_t CountSelected(const std::uint64_t* bitmask,
+                                 std::size_t count) {
+  std::size_t selected = 0u;
+  for (std::size_t word = 0; word < count / 64u; ++word) {
+    selected += static_cast<std::size_t>(__builtin_popcountll(bitmask[word]));
+  }
+  if (count % 64u != 0u) {
+    selected += static_cast<std::size_t>(__builtin_popcountll(
+        bitmask[count / 64u] & ((std::uint64_t{1} << (count % 64u)) - 1u)));
+  }
+  return selected;
+}
+
+}  // namespace registry
+
+#endif  // REGISTRY_COLUMN_KERNELS_H_
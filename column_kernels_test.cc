@@ -0,0 +1,172 @@
+#include "common/column_kernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace registry {
+
+namespace {
+
+constexpr CompareOp kOps[] = {CompareOp::kLess,         CompareOp::kLessEqual,
+                              CompareOp::kEqual,        CompareOp::kNotEqual,
+                              CompareOp::kGreaterEqual, CompareOp::kGreater};
+
+// the paths this CPU can run
+std::vector<KernelIsa> Isas() {
+  std::vector<KernelIsa> isas = {KernelIsa::kScalar};
+  const KernelIsa current = GetKernelIsa();
+  if (SetKernelIsa(KernelIsa::kAvx2).HasValue()) {
+    isas.push_back(KernelIsa::kAvx2);
+  }
+  SetKernelIsa(current);
+  return isas;
+}
+
+template <typename T>
+std::vector<T> RandomValues(std::size_t count, std::mt19937* random) {
+  // a small range, so that operands hit equal values
+  std::uniform_int_distribution<int> distribution(-20, 20);
+  std::vector<T> values(count);
+  for (T& value : values) {
+    value = static_cast<T>(distribution(*random));
+  }
+  return values;
+}
+
+template <typename T>
+void CheckKernels() {
+  std::mt19937 random(42);
+  const KernelIsa current = GetKernelIsa();
+  for (KernelIsa isa : Isas()) {
+    ASSERT_TRUE(SetKernelIsa(isa).HasValue());
+    for (std::size_t count : {0u, 1u, 7u, 8u, 63u, 64u, 65u, 200u, 1000u}) {
+      const std::vector<T> values = RandomValues<T>(count, &random);
+      for (CompareOp op : kOps) {
+        for (T operand : {T(-21), T(0), T(5), T(21)}) {
+          // garbage in the words, the kernels must overwrite them
+          std::vector<std::uint64_t> bitmask(BitmaskWords(count), ~0ull);
+          FilterColumn(values.data(), count, op, operand, bitmask.data());
+          std::size_t expected_selected = 0u;
+          for (std::size_t i = 0; i < count; ++i) {
+            const bool expected = internal::Compare(values[i], op, operand);
+            expected_selected += expected ? 1u : 0u;
+            ASSERT_EQ((bitmask[i / 64u] >> (i % 64u)) & 1u, expected ? 1u : 0u)
+                << "count " << count << " row " << i;
+          }
+          if (count % 64u != 0u) {
+            EXPECT_EQ(bitmask.back() >> (count % 64u), 0u);
+          }
+          EXPECT_EQ(CountSelected(bitmask.data(), count), expected_selected);
+
+          const ColumnAggregate<T> selected =
+              AggregateColumn(values.data(), count, bitmask.data());
+          ASSERT_EQ(selected.count, expected_selected);
+          double sum = 0.0;
+          T min = T{};
+          T max = T{};
+          bool first = true;
+          for (std::size_t i = 0; i < count; ++i) {
+            if (internal::Compare(values[i], op, operand)) {
+              min = first || values[i] < min ? values[i] : min;
+              max = first || max < values[i] ? values[i] : max;
+              sum += static_cast<double>(values[i]);
+              first = false;
+            }
+          }
+          EXPECT_EQ(selected.min, min);
+          EXPECT_EQ(selected.max, max);
+          EXPECT_DOUBLE_EQ(static_cast<double>(selected.sum), sum);
+        }
+      }
+
+      const ColumnAggregate<T> all = AggregateColumn(values.data(), count);
+      EXPECT_EQ(all.count, count);
+      if (count != 0u) {
+        T min = values[0];
+        T max = values[0];
+        double sum = 0.0;
+        for (T value : values) {
+          min = value < min ? value : min;
+          max = max < value ? value : max;
+          sum += static_cast<double>(value);
+        }
+        EXPECT_EQ(all.min, min);
+        EXPECT_EQ(all.max, max);
+        EXPECT_DOUBLE_EQ(static_cast<double>(all.sum), sum);
+      } else {
+        EXPECT_EQ(all.min, T{});
+        EXPECT_EQ(all.sum, 0);
+      }
+    }
+  }
+  SetKernelIsa(current);
+}
+
+}  // namespace
+
+TEST(ColumnKernelsTest, Int32Test) { CheckKernels<std::int32_t>(); }
+
+TEST(ColumnKernelsTest, Int64Test) { CheckKernels<std::int64_t>(); }
+
+TEST(ColumnKernelsTest, FloatTest) { CheckKernels<float>(); }
+
+TEST(ColumnKernelsTest, DoubleTest) { CheckKernels<double>(); }
+
+TEST(ColumnKernelsTest, ScalarOnlyTypesTest) {
+  CheckKernels<std::uint32_t>();
+  CheckKernels<char>();
+  const bool flags[] = {true, false, true, true};
+  std::uint64_t bitmask = 0u;
+  FilterColumn(flags, 4u, CompareOp::kEqual, true, &bitmask);
+  EXPECT_EQ(bitmask, 0xDu);
+  EXPECT_EQ(AggregateColumn(flags, 4u).sum, 3u);
+}
+
+TEST(ColumnKernelsTest, WideValuesTest) {
+  const KernelIsa current = GetKernelIsa();
+  for (KernelIsa isa : Isas()) {
+    SetKernelIsa(isa);
+    // int32 sums do not wrap at 32 bits, int64 sums wrap at 64
+    const std::vector<std::int32_t> large(100, 2000000000);
+    EXPECT_EQ(AggregateColumn(large.data(), large.size()).sum,
+              200000000000ll);
+    std::vector<std::int64_t> extremes(37, 1);
+    extremes[3] = std::numeric_limits<std::int64_t>::max();
+    extremes[30] = std::numeric_limits<std::int64_t>::min();
+    const ColumnAggregate<std::int64_t> aggregate =
+        AggregateColumn(extremes.data(), extremes.size());
+    EXPECT_EQ(aggregate.min, std::numeric_limits<std::int64_t>::min());
+    EXPECT_EQ(aggregate.max, std::numeric_limits<std::int64_t>::max());
+    EXPECT_EQ(aggregate.sum, 34);
+
+    std::vector<double> nans(20, 1.0);
+    nans[9] = std::nan("");
+    std::uint64_t bitmask = 0u;
+    FilterColumn(nans.data(), nans.size(), CompareOp::kNotEqual, 1.0,
+                 &bitmask);
+    EXPECT_EQ(bitmask, 1u << 9);
+    FilterColumn(nans.data(), nans.size(), CompareOp::kGreaterEqual, 1.0,
+                 &bitmask);
+    EXPECT_EQ(bitmask, 0xFFFFFu & ~(1u << 9));
+  }
+  SetKernelIsa(current);
+}
+
+TEST(ColumnKernelsTest, SetKernelIsaTest) {
+  const KernelIsa current = GetKernelIsa();
+  EXPECT_EQ(SetKernelIsa(KernelIsa::kScalar).ValueOrDie(), current);
+  EXPECT_EQ(GetKernelIsa(), KernelIsa::kScalar);
+  common::ErrorOr<KernelIsa> avx2 = SetKernelIsa(KernelIsa::kAvx2);
+  if (avx2.HasError()) {
+    EXPECT_EQ(avx2.ErrorOrDie(), common::Error::kUnavailable);
+    EXPECT_EQ(GetKernelIsa(), KernelIsa::kScalar);
+  }
+  SetKernelIsa(current);
+}
+
+}  // namespace registry
@@ -0,0 +1,215 @@
+#include "common/column_table.h"
+
+#include <cstring>
+#include <utility>
+
+namespace registry {
+
+namespace {
+
+// @return  the bytes of a value of @p type, 0 for strings and enums
+std::size_t WidthOf(TypeEnum type) {
+  switch (type) {
+    case TypeEnum::kInt32:
+      return sizeof(std::int32_t);
+    case TypeEnum::kUnsignedInt32:
+      return sizeof(std::uint32_t);
+    case TypeEnum::kInt64:
+      return sizeof(std::int64_t);
+    case TypeEnum::kUnsignedInt64:
+      return sizeof(std::uint64_t);
+    case TypeEnum::kBoolean:
+      return sizeof(bool);
+    case TypeEnum::kChar:
+      return sizeof(char);
+    case TypeEnum::kFloat:
+      return sizeof(float);
+    case TypeEnum::kDouble:
+      return sizeof(double);
+    case TypeEnum::kString:
+    case TypeEnum::kEnum:
+      return 0u;
+      // no default. Let -werror=switch catch missing enum cases
+  }
+  return 0u;
+}
+
+template <typename T>
+void AppendAs(const Value& value, internal::ColumnBuffer* buffer) {
+  const T typed = value.Get<T>().ValueOrDie();
+  buffer->Append(&typed, sizeof(typed));
+}
+
+void AppendFixed(const Value& value, internal::ColumnBuffer* buffer) {
+  switch (value.type()) {
+    case TypeEnum::kInt32:
+      return AppendAs<std::int32_t>(value, buffer);
+    case TypeEnum::kUnsignedInt32:
+      return AppendAs<std::uint32_t>(value, buffer);
+    case TypeEnum::kInt64:
+      return AppendAs<std::int64_t>(value, buffer);
+    case TypeEnum::kUnsignedInt64:
+      return AppendAs<std::uint64_t>(value, buffer);
+    case TypeEnum::kBoolean:
+      return AppendAs<bool>(value, buffer);
+    case TypeEnum::kChar:
+      return AppendAs<char>(value, buffer);
+    case TypeEnum::kFloat:
+      return AppendAs<float>(value, buffer);
+    case TypeEnum::kDouble:
+      return AppendAs<double>(value, buffer);
+    case TypeEnum::kString:
+    case TypeEnum::kEnum:
+      return;
+      // no default. Let -werror=switch catch missing enum cases
+  }
+}
+
+}  // namespace
+
+namespace internal {
+
+ColumnBuffer::ColumnBuffer(const ColumnBuffer& other) : ColumnBuffer() {
+  *this = other;
+}
+
+ColumnBuffer& ColumnBuffer::operator=(const ColumnBuffer& other) {
+  if (this != &other) {
+    size_ = 0u;
+    Reserve(other.size_);
+    if (other.size_ != 0u) {
+      std::memcpy(data_.get(), other.data_.get(), other.size_);
+    }
+    size_ = other.size_;
+  }
+  return *this;
+}
+
+ColumnBuffer::ColumnBuffer(ColumnBuffer&& other) noexcept
+    : data_(std::move(other.data_)),
+      size_(other.size_),
+      capacity_(other.capacity_) {
+  other.size_ = 0u;
+  other.capacity_ = 0u;
+}
+
+ColumnBuffer& ColumnBuffer::operator=(ColumnBuffer&& other) noexcept {
+  data_ = std::move(other.data_);
+  size_ = other.size_;
+  capacity_ = other.capacity_;
+  other.size_ = 0u;
+  other.capacity_ = 0u;
+  return *this;
+}
+
+void ColumnBuffer::Append(const void* bytes, std::size_t size) {
+  if (size_ + size > capacity_) {
+    Reserve(capacity_ * 2u > size_ + size ? capacity_ * 2u : size_ + size);
+  }
+  std::memcpy(data_.get() + size_, bytes, size);
+  size_ += size;
+}
+
+void ColumnBuffer::Reserve(std::size_t capacity) {
+  if (capacity <= capacity_) {
+    return;
+  }
+  // rounded up to whole cache lines
+  capacity = (capacity + 63u) / 64u * 64u;
+  std::unique_ptr<unsigned char[], Free> data(static_cast<unsigned char*>(
+      ::operator new(capacity, std::align_val_t{64})));
+  if (size_ != 0u) {
+    std::memcpy(data.get(), data_.get(), size_);
+  }
+  data_ = std::move(data);
+  capacity_ = capacity;
+}
+
+}  // namespace internal
+
+common::ErrorOr<ColumnTable> ColumnTable::Create(
+    std::vector<ColumnSpec> specs) {
+  ColumnTable table;
+  table.columns_.reserve(specs.size());
+  for (ColumnSpec& spec : specs) {
+    if (spec.type == TypeEnum::kEnum ||
+        table.FindColumn(spec.name).HasValue()) {
+      return common::Error::kInvalidArgument;
+    }
+    const std::size_t width = WidthOf(spec.type);
+    table.columns_.push_back(
+        Column{std::move(spec), width, internal::ColumnBuffer(), {}, {}});
+  }
+  return table;
+}
+
+common::ErrorOr<std::size_t> ColumnTable::FindColumn(
+    std::string_view name) const {
+  for (std::size_t i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].spec.name == name) {
+      return i;
+    }
+  }
+  return common::Error::kNotFound;
+}
+
+void ColumnTable::Reserve(std::size_t rows) {
+  for (Column& column : columns_) {
+    if (column.width != 0u) {
+      column.values.Reserve(rows * column.width);
+    } else {
+      column.ends.reserve(rows);
+    }
+  }
+}
+
+common::ErrorOr<std::size_t> ColumnTable::AppendRow(
+    const std::vector<Value>& row) {
+  if (row.size() != columns_.size()) {
+    return common::Error::kInvalidArgument;
+  }
+  for (std::size_t i = 0; i < row.size(); ++i) {
+    if (row[i].type() != columns_[i].spec.type) {
+      return common::Error::kInvalidArgument;
+    }
+  }
+  for (std::size_t i = 0; i < row.size(); ++i) {
+    Column& column = columns_[i];
+    if (column.width != 0u) {
+      AppendFixed(row[i], &column.values);
+      continue;
+    }
+    const std::string_view text = row[i].Get<std::string_view>().ValueOrDie();
+    column.arena.append(text.data(), text.size());
+    column.ends.push_back(column.arena.size());
+  }
+  return num_rows_++;
+}
+
+common::ErrorOr<std::string_view> ColumnTable::StringAt(std::size_t column,
+                                                        std::size_t row) const {
+  common::ErrorOr<const Column*> found = Find(column, TypeEnum::kString);
+  if (found.HasError()) {
+    return found.ErrorOrDie();
+  }
+  if (row >= num_rows_) {
+    return common::Error::kOutOfRange;
+  }
+  const Column& strings = *found.ValueOrDie();
+  const std::uint64_t begin = row == 0u ? 0u : strings.ends[row - 1u];
+  return std::string_view(strings.arena.data() + begin,
+                          static_cast<std::size_t>(strings.ends[row] - begin));
+}
+
+common::ErrorOr<const ColumnTable::Column*> ColumnTable::Find(
+    std::size_t column, TypeEnum type) const {
+  if (column >= columns_.size()) {
+    return common::Error::kOutOfRange;
+  }
+  if (columns_[column].spec.type != type) {
+    return common::Error::kInvalidArgument;
+  }
+  return &columns_[column];
+}
+
+}  // namespace registry
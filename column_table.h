@@ -0,0 +1,169 @@
+#ifndef REGISTRY_COLUMN_TABLE_H_
+#define REGISTRY_COLUMN_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "common/column_kernels.h"
+#include "common/error.h"
+#include "common/error_or.h"
+#include "common/type_traits.h"
+#include "common/value.h"
+
+namespace registry {
+namespace internal {
+
+// Growable byte buffer, 64 byte aligned for the vectorized kernels
+class ColumnBuffer {
+ public:
+  ColumnBuffer() : size_(0u), capacity_(0u) {}
+  ColumnBuffer(const ColumnBuffer& other);
+  ColumnBuffer& operator=(const ColumnBuffer& other);
+  ColumnBuffer(ColumnBuffer&& other) noexcept;
+  ColumnBuffer& operator=(ColumnBuffer&& other) noexcept;
+
+  const unsigned char* data() const { return data_.get(); }
+  std::size_t size() const { return size_; }
+
+  void Append(const void* bytes, std::size_t size);
+  void Reserve(std::size_t capacity);
+
+ private:
+  struct Free {
+    void operator()(unsigned char* data) const {
+      ::operator delete(data, std::align_val_t{64});
+    }
+  };
+
+  std::unique_ptr<unsigned char[], Free> data_;
+  std::size_t size_;
+  std::size_t capacity_;
+};
+
+}  // namespace internal
+
+/// Name and type of a ColumnTable column
+struct ColumnSpec {
+  std::string name;
+  TypeEnum type;
+};
+
+/// @class ColumnTable
+/// Typed records stored by column: each column of a TypeTrait scalar type is
+/// one contiguous array, strings are an array of end offsets into an arena.
+/// Filters and aggregates run over a whole column at a time with the kernels
+/// of column_kernels.h, vectorized for int32, int64, float and double.
+/// Selections are bitmasks, one bit per row, so that filters on several
+/// columns combine with bitwise and.
+class ColumnTable {
+ public:
+  /// @return  a table without rows, or Error::kInvalidArgument if a column
+  ///          is an enum or a name is repeated
+  static common::ErrorOr<ColumnTable> Create(std::vector<ColumnSpec> specs);
+
+  std::size_t num_rows() const { return num_rows_; }
+  std::size_t num_columns() const { return columns_.size(); }
+
+  /// @return  the position of the column @p name, or Error::kNotFound
+  common::ErrorOr<std::size_t> FindColumn(std::string_view name) const;
+
+  /// @return  the spec of column @p column, which must exist
+  const ColumnSpec& spec(std::size_t column) const {
+    return columns_[column].spec;
+  }
+
+  /// Reserves storage for @p rows rows in every fixed width column
+  void Reserve(std::size_t rows);
+
+  /// Appends a row of values in column order, each of its column's type
+  /// @return  the row number, or Error::kInvalidArgument if @p row does not
+  ///          match the columns, in which case nothing is appended
+  common::ErrorOr<std::size_t> AppendRow(const std::vector<Value>& row);
+
+  /// @return  the num_rows() values of @p column, Error::kOutOfRange if
+  ///          there is no such column or Error::kInvalidArgument if it is
+  ///          not of type T
+  template <typename T>
+  common::ErrorOr<const T*> ColumnData(std::size_t column) const {
+    static_assert(internal::IsScalarValue<T>::value && !std::is_enum<T>::value,
+                  "Columns hold the scalar TypeTrait types, read strings "
+                  "with StringAt()");
+    common::ErrorOr<const Column*> found = Find(column, TypeTrait<T>::type);
+    if (found.HasError()) {
+      return found.ErrorOrDie();
+    }
+    return reinterpret_cast<const T*>(found.ValueOrDie()->values.data());
+  }
+
+  /// @return  the string at @p row of @p column, which points into the table
+  ///          until the next append, or Error::kOutOfRange or
+  ///          Error::kInvalidArgument as for ColumnData()
+  common::ErrorOr<std::string_view> StringAt(std::size_t column,
+                                             std::size_t row) const;
+
+  /// Sets @p bitmask to BitmaskWords(num_rows()) words, bit i being whether
+  /// row i of @p column op @p operand
+  /// @return  the number of rows selected, or an error as for ColumnData()
+  template <typename T>
+  common::ErrorOr<std::size_t> Filter(
+      std::size_t column, CompareOp op, T operand,
+      std::vector<std::uint64_t>* bitmask) const {
+    common::ErrorOr<const T*> values = ColumnData<T>(column);
+    if (values.HasError()) {
+      return values.ErrorOrDie();
+    }
+    bitmask->resize(BitmaskWords(num_rows_));
+    FilterColumn(values.ValueOrDie(), num_rows_, op, operand, bitmask->data());
+    return CountSelected(bitmask->data(), num_rows_);
+  }
+
+  /// @return  the aggregate of @p column over every row, or over the rows
+  ///          selected by @p selection if given; an error as for
+  ///          ColumnData(), or Error::kInvalidArgument if @p selection is
+  ///          shorter than BitmaskWords(num_rows())
+  template <typename T>
+  common::ErrorOr<ColumnAggregate<T>> Aggregate(
+      std::size_t column,
+      const std::vector<std::uint64_t>* selection = nullptr) const {
+    common::ErrorOr<const T*> values = ColumnData<T>(column);
+    if (values.HasError()) {
+      return values.ErrorOrDie();
+    }
+    if (selection == nullptr) {
+      return AggregateColumn(values.ValueOrDie(), num_rows_);
+    }
+    if (selection->size() < BitmaskWords(num_rows_)) {
+      return common::Error::kInvalidArgument;
+    }
+    return AggregateColumn(values.ValueOrDie(), num_rows_, selection->data());
+  }
+
+ private:
+  struct Column {
+    ColumnSpec spec;
+    // bytes per value, 0 for strings
+    std::size_t width;
+    // the values of fixed width columns
+    internal::ColumnBuffer values;
+    // strings: the end offset of each row in arena
+    std::vector<std::uint64_t> ends;
+    std::string arena;
+  };
+
+  ColumnTable() : num_rows_(0u) {}
+
+  common::ErrorOr<const Column*> Find(std::size_t column, TypeEnum type) const;
+
+  std::vector<Column> columns_;
+  std::size_t num_rows_;
+};
+
+}  // namespace registry
+
+#endif  // REGISTRY_COLUMN_TABLE_H_
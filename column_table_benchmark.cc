@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/column_table.h"
+
+namespace registry {
+namespace {
+
+// The same records as a row-wise std::vector<Row> and as a ColumnTable
+struct Row {
+  int64_t id;
+  double price;
+  int32_t quantity;
+  bool active;
+  std::string name;
+};
+
+std::vector<Row> MakeRows(int64_t count) {
+  std::vector<Row> rows;
+  rows.reserve(count);
+  uint64_t seed = 12345u;
+  for (int64_t i = 0; i < count; ++i) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    rows.push_back(Row{i, static_cast<double>(seed >> 44) * 0.01,
+                       static_cast<int32_t>(seed >> 60), (seed >> 33) % 2 == 0,
+                       "item-" + std::to_string(i)});
+  }
+  return rows;
+}
+
+ColumnTable MakeTable(const std::vector<Row>& rows) {
+  ColumnTable table = ColumnTable::Create({{"id", TypeEnum::kInt64},
+                                           {"price", TypeEnum::kDouble},
+                                           {"quantity", TypeEnum::kInt32},
+                                           {"active", TypeEnum::kBoolean},
+                                           {"name", TypeEnum::kString}})
+                          .ValueOrDie();
+  table.Reserve(rows.size());
+  for (const Row& row : rows) {
+    table.AppendRow({Value(row.id), Value(row.price), Value(row.quantity),
+                     Value(row.active), Value(row.name)});
+  }
+  return table;
+}
+
+// range(1) selects the kernels: 0 scalar, 1 AVX2
+bool SelectIsa(benchmark::State& state) {
+  const KernelIsa isa =
+      state.range(1) == 0 ? KernelIsa::kScalar : KernelIsa::kAvx2;
+  if (SetKernelIsa(isa).HasError()) {
+    state.SkipWithError("Kernels not supported by this CPU");
+    return false;
+  }
+  return true;
+}
+
+// sum(price) where quantity >= 8
+void BM_RowFilterSum(benchmark::State& state) {
+  const std::vector<Row> rows = MakeRows(state.range(0));
+  for (auto _ : state) {
+    double sum = 0.0;
+    size_t count = 0u;
+    for (const Row& row : rows) {
+      if (row.quantity >= 8) {
+        sum += row.price;
+        ++count;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RowFilterSum)->Arg(1 << 12)->Arg(1 << 20);
+
+void BM_ColumnFilterSum(benchmark::State& state) {
+  if (!SelectIsa(state)) {
+    return;
+  }
+  const ColumnTable table = MakeTable(MakeRows(state.range(0)));
+  std::vector<uint64_t> selection;
+  for (auto _ : state) {
+    table.Filter<int32_t>(2, CompareOp::kGreaterEqual, 8, &selection);
+    benchmark::DoNotOptimize(table.Aggregate<double>(1, &selection));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColumnFilterSum)
+    ->Args({1 << 12, 0})
+    ->Args({1 << 12, 1})
+    ->Args({1 << 20, 0})
+    ->Args({1 << 20, 1});
+
+// min, max and sum of id
+void BM_RowAggregate(benchmark::State& state) {
+  const std::vector<Row> rows = MakeRows(state.range(0));
+  for (auto _ : state) {
+    int64_t min = rows[0].id;
+    int64_t max = rows[0].id;
+    int64_t sum = 0;
+    for (const Row& row : rows) {
+      min = row.id < min ? row.id : min;
+      max = max < row.id ? row.id : max;
+      sum += row.id;
+    }
+    benchmark::DoNotOptimize(min);
+    benchmark::DoNotOptimize(max);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RowAggregate)->Arg(1 << 12)->Arg(1 << 20);
+
+void BM_ColumnAggregate(benchmark::State& state) {
+  if (!SelectIsa(state)) {
+    return;
+  }
+  const ColumnTable table = MakeTable(MakeRows(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.Aggregate<int64_t>(0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ColumnAggregate)
+    ->Args({1 << 12, 0})
+    ->Args({1 << 12, 1})
+    ->Args({1 << 20, 0})
+    ->Args({1 << 20, 1});
+
+}  // namespace
+}  // namespace registry
@@ -0,0 +1,125 @@
+#include "common/column_table.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace registry {
+
+namespace {
+
+ColumnTable MakeTable() {
+  return ColumnTable::Create({{"id", TypeEnum::kInt64},
+                              {"price", TypeEnum::kDouble},
+                              {"quantity", TypeEnum::kInt32},
+                              {"active", TypeEnum::kBoolean},
+                              {"name", TypeEnum::kString}})
+      .ValueOrDie();
+}
+
+}  // namespace
+
+TEST(ColumnTableTest, CreateTest) {
+  ColumnTable table = MakeTable();
+  EXPECT_EQ(table.num_columns(), 5u);
+  EXPECT_EQ(table.num_rows(), 0u);
+  EXPECT_EQ(table.FindColumn("quantity").ValueOrDie(), 2u);
+  EXPECT_EQ(table.FindColumn("missing").ErrorOrDie(),
+            common::Error::kNotFound);
+  EXPECT_EQ(table.spec(4).type, TypeEnum::kString);
+
+  EXPECT_EQ(ColumnTable::Create({{"a", TypeEnum::kInt32},
+                                 {"a", TypeEnum::kFloat}})
+                .ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(ColumnTable::Create({{"e", TypeEnum::kEnum}}).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+TEST(ColumnTableTest, AppendTest) {
+  ColumnTable table = MakeTable();
+  EXPECT_EQ(table
+                .AppendRow({Value(int64_t{1}), Value(2.5), Value(int32_t{3}),
+                            Value(true), Value("first")})
+                .ValueOrDie(),
+            0u);
+  EXPECT_EQ(table
+                .AppendRow({Value(int64_t{2}), Value(4.0), Value(int32_t{5}),
+                            Value(false), Value("")})
+                .ValueOrDie(),
+            1u);
+  // wrong arity or types append nothing
+  EXPECT_EQ(table.AppendRow({Value(int64_t{3})}).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(table
+                .AppendRow({Value(int64_t{3}), Value(1.0f), Value(int32_t{1}),
+                            Value(true), Value("x")})
+                .ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(table.num_rows(), 2u);
+
+  const int64_t* ids = table.ColumnData<int64_t>(0).ValueOrDie();
+  EXPECT_EQ(ids[0], 1);
+  EXPECT_EQ(ids[1], 2);
+  EXPECT_EQ(table.ColumnData<double>(1).ValueOrDie()[1], 4.0);
+  EXPECT_FALSE(table.ColumnData<bool>(3).ValueOrDie()[1]);
+  EXPECT_EQ(table.StringAt(4, 0).ValueOrDie(), "first");
+  EXPECT_EQ(table.StringAt(4, 1).ValueOrDie(), "");
+
+  EXPECT_EQ(table.ColumnData<int32_t>(0).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(table.ColumnData<int32_t>(9).ErrorOrDie(),
+            common::Error::kOutOfRange);
+  EXPECT_EQ(table.StringAt(0, 0).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(table.StringAt(4, 2).ErrorOrDie(), common::Error::kOutOfRange);
+}
+
+TEST(ColumnTableTest, FilterAggregateTest) {
+  ColumnTable table = MakeTable();
+  constexpr int kRows = 1000;
+  table.Reserve(kRows);
+  for (int i = 0; i < kRows; ++i) {
+    table.AppendRow({Value(int64_t{i}), Value(i * 0.5), Value(int32_t{i % 10}),
+                     Value(i % 2 == 0), Value("row-" + std::to_string(i))});
+  }
+  EXPECT_EQ(table.StringAt(4, 999).ValueOrDie(), "row-999");
+
+  const ColumnAggregate<int64_t> ids = table.Aggregate<int64_t>(0).ValueOrDie();
+  EXPECT_EQ(ids.count, 1000u);
+  EXPECT_EQ(ids.min, 0);
+  EXPECT_EQ(ids.max, 999);
+  EXPECT_EQ(ids.sum, 999 * 1000 / 2);
+
+  // quantity >= 7 on even rows leaves quantity 8
+  std::vector<uint64_t> quantity;
+  EXPECT_EQ(table
+                .Filter<int32_t>(2, CompareOp::kGreaterEqual, 7, &quantity)
+                .ValueOrDie(),
+            300u);
+  std::vector<uint64_t> active;
+  EXPECT_EQ(table.Filter<bool>(3, CompareOp::kEqual, true, &active)
+                .ValueOrDie(),
+            500u);
+  for (size_t i = 0; i < quantity.size(); ++i) {
+    quantity[i] &= active[i];
+  }
+  const ColumnAggregate<double> prices =
+      table.Aggregate<double>(1, &quantity).ValueOrDie();
+  EXPECT_EQ(prices.count, 100u);
+  EXPECT_EQ(prices.min, 4.0);
+  EXPECT_EQ(prices.max, 499.0);
+  // rows 8, 18, ..., 998 at half their row number
+  EXPECT_DOUBLE_EQ(prices.sum, (8 + 998) * 100 / 2 * 0.5);
+
+  EXPECT_EQ(table.Filter<float>(1, CompareOp::kLess, 1.0f, &active)
+                .ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  std::vector<uint64_t> short_selection(3u, ~0ull);
+  EXPECT_EQ(table.Aggregate<double>(1, &short_selection).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+}  // namespace registry
@@ -0,0 +1,165 @@
+#ifndef COMMON_ENUM_FROM_STRING_H_
+#define COMMON_ENUM_FROM_STRING_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "common/enum_traits.h"
+#include "common/error.h"
+#include "common/error_or.h"
+
+namespace common {
+namespace internal {
+
+constexpr std::uint64_t HashEnumName(std::string_view name) {
+  // FNV-1a
+  std::uint64_t hash = 0xCBF29CE484222325ull;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Second level hash, picks a slot for a name hash and bucket displacement
+constexpr std::size_t EnumNameSlot(std::uint64_t hash,
+                                   std::uint32_t displacement,
+                                   std::size_t size) {
+  std::uint64_t x = hash ^ (displacement * 0x9E3779B97F4A7C15ull);
+  x ^= x >> 31;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 29;
+  return static_cast<std::size_t>(x % size);
+}
+
+constexpr std::size_t EnumNameBucket(std::uint64_t hash, std::size_t buckets) {
+  return static_cast<std::size_t>((hash >> 32) % buckets);
+}
+
+template <typename T, std::size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)> EnumNames(
+    std::index_sequence<I...>) {
+  return {{std::string_view(
+      EnumTrait<T>::to_string(EnumListTrait<T>::values()[I]))...}};
+}
+
+/// Minimal perfect hash over N names built with hash and displace: names
+/// are grouped into buckets by their hash, and each bucket, largest first,
+/// gets the first displacement that sends all of its names to free slots.
+template <std::size_t N>
+struct EnumNameTable {
+  constexpr static std::size_t kBuckets = N / 2u + 1u;
+
+  std::array<std::uint32_t, kBuckets> displacements;
+  // index into the names / values arrays per slot
+  std::array<std::uint32_t, N> slot_index;
+};
+
+template <std::size_t N>
+constexpr EnumNameTable<N> BuildEnumNameTable(
+    const std::array<std::string_view, N>& names) {
+  constexpr std::size_t kBuckets = EnumNameTable<N>::kBuckets;
+  constexpr std::uint32_t kMaxDisplacement = 1u << 20;
+
+  std::array<std::uint64_t, N> hashes{};
+  std::array<std::size_t, kBuckets> bucket_sizes{};
+  for (std::size_t i = 0u; i < N; ++i) {
+    hashes[i] = HashEnumName(names[i]);
+    ++bucket_sizes[EnumNameBucket(hashes[i], kBuckets)];
+  }
+
+  // buckets by decreasing size
+  std::array<std::size_t, kBuckets> order{};
+  for (std::size_t b = 0u; b < kBuckets; ++b) {
+    order[b] = b;
+  }
+  for (std::size_t i = 1u; i < kBuckets; ++i) {
+    for (std::size_t j = i; j > 0u && bucket_sizes[order[j]] >
+                                          bucket_sizes[order[j - 1u]];
+         --j) {
+      const std::size_t swap = order[j];
+      order[j] = order[j - 1u];
+      order[j - 1u] = swap;
+    }
+  }
+
+  EnumNameTable<N> table{};
+  std::array<bool, N> used{};
+  for (std::size_t b : order) {
+    if (bucket_sizes[b] == 0u) {
+      break;
+    }
+    std::uint32_t displacement = 0u;
+    for (;; ++displacement) {
+      if (displacement == kMaxDisplacement) {
+        throw "Enum names are not unique";
+      }
+      std::array<bool, N> taken = used;
+      bool fits = true;
+      for (std::size_t i = 0u; i < N && fits; ++i) {
+        if (EnumNameBucket(hashes[i], kBuckets) != b) {
+          continue;
+        }
+        const std::size_t slot = EnumNameSlot(hashes[i], displacement, N);
+        fits = !taken[slot];
+        taken[slot] = true;
+      }
+      if (fits) {
+        used = taken;
+        break;
+      }
+    }
+    table.displacements[b] = displacement;
+    for (std::size_t i = 0u; i < N; ++i) {
+      if (EnumNameBucket(hashes[i], kBuckets) == b) {
+        table.slot_index[EnumNameSlot(hashes[i], displacement, N)] =
+            static_cast<std::uint32_t>(i);
+      }
+    }
+  }
+  return table;
+}
+
+template <typename T>
+struct EnumNameLookup {
+  constexpr static std::size_t kSize = EnumTrait<T>::num_values();
+
+  static constexpr std::array<std::string_view, kSize> kNames =
+      EnumNames<T>(std::make_index_sequence<kSize>());
+
+  static constexpr EnumNameTable<kSize> kTable = BuildEnumNameTable(kNames);
+};
+
+}  // namespace internal
+
+/// Parses the EnumTrait<T>::to_string() name of a value of T. The lookup
+/// uses a minimal perfect hash built at compile time from
+/// EnumListTrait<T>::values(), so it costs one hash of @p name and one
+/// string compare. Both traits must be constexpr.
+/// @return  the value, or Error::kNotFound for unknown names
+template <typename T>
+ErrorOr<T> FromString(std::string_view name) {
+  static_assert(!std::is_same<T, Error>::value,
+                "ErrorOr<Error> is ambiguous, use ParseErrorString()");
+  using Lookup = internal::EnumNameLookup<T>;
+  constexpr std::size_t kBuckets =
+      internal::EnumNameTable<Lookup::kSize>::kBuckets;
+  const std::uint64_t hash = internal::HashEnumName(name);
+  const std::size_t slot = internal::EnumNameSlot(
+      hash,
+      Lookup::kTable.displacements[internal::EnumNameBucket(hash, kBuckets)],
+      Lookup::kSize);
+  const std::uint32_t index = Lookup::kTable.slot_index[slot];
+  if (Lookup::kNames[index] != name) {
+    return Error::kNotFound;
+  }
+  return EnumListTrait<T>::values()[index];
+}
+
+}  // namespace common
+
+#endif  // COMMON_ENUM_FROM_STRING_H_
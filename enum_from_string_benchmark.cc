@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/enum_from_string.h"
+#include "common/enum_reflection.h"
+
+namespace benchmark_namespace {
+
+enum class Opcode {
+  kNop,
+  kLoad,
+  kStore,
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kDivide,
+  kModulo,
+  kAnd,
+  kOr,
+  kXor,
+  kShiftLeft,
+  kShiftRight,
+  kCompare,
+  kJump,
+  kJumpIfZero,
+  kJumpIfNotZero,
+  kCall,
+  kReturn,
+  kPush,
+  kPop,
+  kAllocate,
+  kFree,
+  kHalt,
+};
+
+}  // namespace benchmark_namespace
+
+COMMON_REFLECT_ENUM(benchmark_namespace::Opcode,
+                    benchmark_namespace::Opcode::kNop)
+
+namespace benchmark_namespace {
+namespace {
+
+// every name once, then an unknown one
+std::vector<std::string> Inputs() {
+  std::vector<std::string> inputs;
+  for (Opcode opcode : common::EnumListTrait<Opcode>::values()) {
+    inputs.push_back(common::EnumTrait<Opcode>::to_string(opcode));
+  }
+  inputs.push_back("kJumpIfPositive");
+  return inputs;
+}
+
+common::ErrorOr<Opcode> LinearSearch(std::string_view name) {
+  for (Opcode opcode : common::EnumListTrait<Opcode>::values()) {
+    if (name == common::EnumTrait<Opcode>::to_string(opcode)) {
+      return opcode;
+    }
+  }
+  return common::Error::kNotFound;
+}
+
+void BM_PerfectHash(benchmark::State& state) {
+  const std::vector<std::string> inputs = Inputs();
+  for (auto _ : state) {
+    for (const std::string& input : inputs) {
+      benchmark::DoNotOptimize(common::FromString<Opcode>(input));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_PerfectHash);
+
+void BM_LinearSearch(benchmark::State& state) {
+  const std::vector<std::string> inputs = Inputs();
+  for (auto _ : state) {
+    for (const std::string& input : inputs) {
+      benchmark::DoNotOptimize(LinearSearch(input));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_LinearSearch);
+
+void BM_UnorderedMap(benchmark::State& state) {
+  std::unordered_map<std::string_view, Opcode> map;
+  for (Opcode opcode : common::EnumListTrait<Opcode>::values()) {
+    map.emplace(common::EnumTrait<Opcode>::to_string(opcode), opcode);
+  }
+  const std::vector<std::string> inputs = Inputs();
+  for (auto _ : state) {
+    for (const std::string& input : inputs) {
+      auto it = map.find(input);
+      benchmark::DoNotOptimize(it == map.end()
+                                   ? common::ErrorOr<Opcode>(
+                                         common::Error::kNotFound)
+                                   : common::ErrorOr<Opcode>(it->second));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * inputs.size());
+}
+BENCHMARK(BM_UnorderedMap);
+
+}  // namespace
+}  // namespace benchmark_namespace
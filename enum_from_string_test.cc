@@ -0,0 +1,74 @@
+#include "common/enum_from_string.h"
+
+#include <string>
+
+#include "common/enum_reflection.h"
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Fruit { kApple, kBanana, kCherry, kDate, kElderberry, kFig };
+
+enum class Single { kOnly };
+
+enum class Gaps : int { kLow = -3, kMid = 7, kHigh = 40 };
+
+}  // namespace test_namespace
+
+COMMON_REFLECT_ENUM(test_namespace::Fruit, test_namespace::Fruit::kApple)
+COMMON_REFLECT_ENUM(test_namespace::Single, test_namespace::Single::kOnly)
+COMMON_REFLECT_ENUM_RANGE(test_namespace::Gaps, test_namespace::Gaps::kMid,
+                          -8, 64)
+
+namespace test_namespace {
+
+template <typename T>
+void ExpectRoundTrip() {
+  for (T value : common::EnumListTrait<T>::values()) {
+    common::ErrorOr<T> parsed =
+        common::FromString<T>(common::EnumTrait<T>::to_string(value));
+    ASSERT_TRUE(parsed.HasValue()) << common::EnumTrait<T>::to_string(value);
+    EXPECT_EQ(parsed.ValueOrDie(), value);
+  }
+}
+
+TEST(EnumFromStringTest, RoundTripTest) {
+  ExpectRoundTrip<Fruit>();
+  ExpectRoundTrip<Single>();
+  ExpectRoundTrip<Gaps>();
+}
+
+TEST(EnumFromStringTest, UnknownTest) {
+  for (const char* name :
+       {"", "kapple", "kApple ", "Apple", "kApples", "kBanan", "Unknown"}) {
+    common::ErrorOr<Fruit> parsed = common::FromString<Fruit>(name);
+    ASSERT_TRUE(parsed.HasError()) << name;
+    EXPECT_EQ(parsed.ErrorOrDie(), common::Error::kNotFound);
+  }
+  EXPECT_TRUE(common::FromString<Single>("kOnlyNot").HasError());
+  EXPECT_TRUE(common::FromString<Gaps>("kLow").HasValue());
+  EXPECT_TRUE(common::FromString<Gaps>("kMiddle").HasError());
+}
+
+TEST(EnumFromStringTest, StringViewTest) {
+  const std::string text = "kCherry,kFig";
+  const std::string_view view(text);
+  EXPECT_EQ(common::FromString<Fruit>(view.substr(0, 7)).ValueOrDie(),
+            Fruit::kCherry);
+  EXPECT_EQ(common::FromString<Fruit>(view.substr(8)).ValueOrDie(),
+            Fruit::kFig);
+  EXPECT_TRUE(common::FromString<Fruit>(view).HasError());
+}
+
+TEST(EnumFromStringTest, TableTest) {
+  using Lookup = common::internal::EnumNameLookup<Fruit>;
+  // every slot holds a distinct name
+  bool seen[Lookup::kSize] = {};
+  for (std::uint32_t index : Lookup::kTable.slot_index) {
+    ASSERT_LT(index, Lookup::kSize);
+    EXPECT_FALSE(seen[index]);
+    seen[index] = true;
+  }
+}
+
+}  // namespace test_namespace
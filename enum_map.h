@@ -0,0 +1,174 @@
+#ifndef COMMON_ENUM_MAP_H_
+#define COMMON_ENUM_MAP_H_
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "common/enum_set.h"
+#include "common/enum_traits.h"
+
+namespace common {
+
+/// @class EnumMap
+/// Map from every value of the enum K to a V, stored in a std::array indexed
+/// by the position of the key in EnumListTrait<K>::values(), which must be
+/// constexpr. Lookups are a single indexed load for contiguous enums.
+/// Every key always has a value, default constructed unless given.
+template <typename K, typename V>
+class EnumMap {
+  using Index = internal::EnumIndex<K>;
+
+ public:
+  constexpr static std::size_t kSize = Index::kSize;
+
+  constexpr EnumMap() : values_{} {}
+
+  /// Keys that are not listed by EnumListTrait<K> are ignored
+  constexpr EnumMap(std::initializer_list<std::pair<K, V>> entries)
+      : values_{} {
+    for (const std::pair<K, V>& entry : entries) {
+      const std::size_t index = Index::Of(entry.first);
+      if (index < kSize) {
+        values_[index] = entry.second;
+      }
+    }
+  }
+
+  /// @p key must be listed by EnumListTrait<K>
+  constexpr V& operator[](K key) { return values_[Index::Of(key)]; }
+  constexpr const V& operator[](K key) const {
+    return values_[Index::Of(key)];
+  }
+
+  /// @return  the value of @p key, or nullptr if the key is not listed
+  constexpr V* Find(K key) {
+    const std::size_t index = Index::Of(key);
+    return index < kSize ? &values_[index] : nullptr;
+  }
+  constexpr const V* Find(K key) const {
+    const std::size_t index = Index::Of(key);
+    return index < kSize ? &values_[index] : nullptr;
+  }
+
+  /// Calls @p f with each key and its value, in EnumListTrait<K> order
+  template <typename F>
+  constexpr void ForEach(F&& f) {
+    for (std::size_t i = 0u; i < kSize; ++i) {
+      f(Index::kValues[i], values_[i]);
+    }
+  }
+  template <typename F>
+  constexpr void ForEach(F&& f) const {
+    for (std::size_t i = 0u; i < kSize; ++i) {
+      f(Index::kValues[i], values_[i]);
+    }
+  }
+
+  constexpr std::size_t size() const { return kSize; }
+
+  /// The values in EnumListTrait<K> order
+  constexpr std::array<V, kSize>& values() { return values_; }
+  constexpr const std::array<V, kSize>& values() const { return values_; }
+
+ private:
+  std::array<V, kSize> values_;
+};
+
+/// @class SparseEnumMap
+/// EnumMap whose keys may be absent, tracked by an EnumSet. Values of absent
+/// keys are default constructed and kept in place, so V must be default
+/// constructible and Erase() resets the value rather than destroying it.
+template <typename K, typename V>
+class SparseEnumMap {
+  using Index = internal::EnumIndex<K>;
+
+ public:
+  constexpr static std::size_t kSize = Index::kSize;
+
+  constexpr SparseEnumMap() : values_{}, present_() {}
+
+  /// Keys that are not listed by EnumListTrait<K> are ignored
+  constexpr SparseEnumMap(std::initializer_list<std::pair<K, V>> entries)
+      : values_{}, present_() {
+    for (const std::pair<K, V>& entry : entries) {
+      Insert(entry.first, entry.second);
+    }
+  }
+
+  /// Sets the value of @p key, ignored if the key is not listed
+  constexpr void Insert(K key, V value) {
+    const std::size_t index = Index::Of(key);
+    if (index < kSize) {
+      values_[index] = std::move(value);
+      present_.Insert(key);
+    }
+  }
+
+  constexpr void Erase(K key) {
+    const std::size_t index = Index::Of(key);
+    if (index < kSize) {
+      values_[index] = V();
+      present_.Erase(key);
+    }
+  }
+
+  constexpr bool Contains(K key) const { return present_.Contains(key); }
+
+  /// @return  the value of @p key, or nullptr if it is absent
+  constexpr V* Find(K key) {
+    const std::size_t index = Index::Of(key);
+    return index < kSize && Present(index) ? &values_[index] : nullptr;
+  }
+  constexpr const V* Find(K key) const {
+    const std::size_t index = Index::Of(key);
+    return index < kSize && Present(index) ? &values_[index] : nullptr;
+  }
+
+  /// Calls @p f with each present key and its value, in EnumListTrait<K>
+  /// order
+  template <typename F>
+  constexpr void ForEach(F&& f) {
+    ForEachIndex(
+        [this, &f](std::size_t i) { f(Index::kValues[i], values_[i]); });
+  }
+  template <typename F>
+  constexpr void ForEach(F&& f) const {
+    ForEachIndex(
+        [this, &f](std::size_t i) { f(Index::kValues[i], values_[i]); });
+  }
+
+  constexpr void Clear() {
+    ForEachIndex([this](std::size_t i) { values_[i] = V(); });
+    present_.Clear();
+  }
+
+  constexpr std::size_t size() const { return present_.size(); }
+  constexpr bool empty() const { return present_.empty(); }
+
+  /// The present keys
+  constexpr const EnumSet<K>& keys() const { return present_; }
+
+ private:
+  constexpr bool Present(std::size_t index) const {
+    return (present_.words()[index / 64u] >> (index % 64u)) & 1u;
+  }
+
+  // walks the presence words directly, no key lookups
+  template <typename F>
+  constexpr void ForEachIndex(F&& f) const {
+    for (std::size_t w = 0u; w < EnumSet<K>::kWords; ++w) {
+      for (auto bits = present_.words()[w]; bits != 0u; bits &= bits - 1u) {
+        f(w * 64u + static_cast<std::size_t>(__builtin_ctzll(bits)));
+      }
+    }
+  }
+
+  std::array<V, kSize> values_;
+  EnumSet<K> present_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_ENUM_MAP_H_
@@ -0,0 +1,102 @@
+#include "common/enum_map.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/enum_reflection.h"
+#include "common/error.h"
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Stage { kParse, kPlan, kExecute };
+
+enum class Gaps : int { kA = -5, kB = 0, kC = 12 };
+
+}  // namespace test_namespace
+
+COMMON_REFLECT_ENUM(test_namespace::Stage, test_namespace::Stage::kParse)
+COMMON_REFLECT_ENUM_RANGE(test_namespace::Gaps, test_namespace::Gaps::kB, -8,
+                          16)
+
+namespace test_namespace {
+
+TEST(EnumMapTest, ConstexprTest) {
+  constexpr common::EnumMap<Stage, int> costs = {{Stage::kPlan, 3},
+                                                 {Stage::kExecute, 10}};
+  static_assert(costs[Stage::kParse] == 0, "");
+  static_assert(costs[Stage::kPlan] == 3, "");
+  static_assert(costs[Stage::kExecute] == 10, "");
+  static_assert(costs.size() == 3u, "");
+  static_assert(sizeof(costs) == 3u * sizeof(int), "");
+  EXPECT_EQ(costs.Find(static_cast<Stage>(7)), nullptr);
+}
+
+TEST(EnumMapTest, ErrorCountersTest) {
+  common::EnumMap<common::Error, int> counts;
+  ++counts[common::Error::kNotFound];
+  ++counts[common::Error::kNotFound];
+  ++counts[common::Error::kInternal];
+  EXPECT_EQ(counts[common::Error::kNotFound], 2);
+  EXPECT_EQ(counts[common::Error::kInternal], 1);
+  int total = 0;
+  counts.ForEach([&total](common::Error, int count) { total += count; });
+  EXPECT_EQ(total, 3);
+}
+
+TEST(EnumMapTest, IterationOrderTest) {
+  common::EnumMap<Gaps, std::string> names = {
+      {Gaps::kC, "c"}, {Gaps::kA, "a"}, {Gaps::kB, "b"}};
+  std::vector<std::pair<Gaps, std::string>> entries;
+  names.ForEach([&entries](Gaps key, std::string& value) {
+    entries.emplace_back(key, value);
+    value += "!";
+  });
+  ASSERT_EQ(entries.size(), 3u);
+  EXPECT_EQ(entries[0].first, Gaps::kA);
+  EXPECT_EQ(entries[1].first, Gaps::kB);
+  EXPECT_EQ(entries[2].first, Gaps::kC);
+  EXPECT_EQ(entries[2].second, "c");
+  EXPECT_EQ(*names.Find(Gaps::kC), "c!");
+  EXPECT_EQ(names.Find(static_cast<Gaps>(1)), nullptr);
+  EXPECT_EQ(names.values()[0], "a!");
+}
+
+TEST(SparseEnumMapTest, InsertEraseTest) {
+  common::SparseEnumMap<Gaps, std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.Find(Gaps::kA), nullptr);
+  map.Insert(Gaps::kC, "c");
+  map.Insert(Gaps::kA, "a");
+  map.Insert(static_cast<Gaps>(3), "ignored");
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_TRUE(map.Contains(Gaps::kA));
+  EXPECT_FALSE(map.Contains(Gaps::kB));
+  EXPECT_EQ(*map.Find(Gaps::kC), "c");
+  EXPECT_EQ(map.Find(Gaps::kB), nullptr);
+
+  std::vector<Gaps> keys;
+  map.ForEach([&keys](Gaps key, const std::string&) { keys.push_back(key); });
+  EXPECT_EQ(keys, (std::vector<Gaps>{Gaps::kA, Gaps::kC}));
+  EXPECT_EQ(map.keys(), (common::EnumSet<Gaps>{Gaps::kA, Gaps::kC}));
+
+  map.Erase(Gaps::kA);
+  EXPECT_EQ(map.Find(Gaps::kA), nullptr);
+  EXPECT_EQ(map.size(), 1u);
+  map.Clear();
+  EXPECT_TRUE(map.empty());
+  map.Insert(Gaps::kC, "again");
+  EXPECT_EQ(*map.Find(Gaps::kC), "again");
+}
+
+TEST(SparseEnumMapTest, ConstexprTest) {
+  constexpr common::SparseEnumMap<Stage, int> map = {{Stage::kExecute, 4}};
+  static_assert(map.size() == 1u, "");
+  static_assert(map.Contains(Stage::kExecute), "");
+  static_assert(!map.Contains(Stage::kPlan), "");
+  static_assert(*map.Find(Stage::kExecute) == 4, "");
+  static_assert(map.Find(Stage::kParse) == nullptr, "");
+}
+
+}  // namespace test_namespace
@@ -0,0 +1,198 @@
+#ifndef COMMON_ENUM_REFLECTION_H_
+#define COMMON_ENUM_REFLECTION_H_
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#include "common/enum_traits.h"
+
+namespace common {
+namespace internal {
+
+// The enumerator name of V is recovered from the function signature, which
+// GCC and Clang spell as "... V = ns::Enum::kName; ..." or "... V = ns::kName]"
+// for declared enumerators and "V = (ns::Enum)5" for any other value.
+template <typename E, E V>
+constexpr std::string_view EnumValueSignature() {
+  return __PRETTY_FUNCTION__;
+}
+
+constexpr std::string_view ParseEnumValueName(std::string_view signature) {
+  std::size_t start = signature.find(" V = ");
+  if (start == std::string_view::npos) {
+    return std::string_view();
+  }
+  start += 5u;
+  const std::size_t end = signature.find_first_of(";]", start);
+  std::string_view value = signature.substr(start, end - start);
+  if (value.empty() || value[0] == '(' || value[0] == '-' ||
+      (value[0] >= '0' && value[0] <= '9')) {
+    return std::string_view();
+  }
+  const std::size_t scope = value.rfind("::");
+  return scope == std::string_view::npos ? value : value.substr(scope + 2u);
+}
+
+template <typename E, int Min, std::size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)> EnumRangeNames(
+    std::index_sequence<I...>) {
+  return {{ParseEnumValueName(
+      EnumValueSignature<E, static_cast<E>(Min + static_cast<int>(I))>())...}};
+}
+
+template <std::size_t N>
+constexpr std::size_t CountNames(const std::array<std::string_view, N>& names) {
+  std::size_t count = 0u;
+  for (std::size_t i = 0u; i < N; ++i) {
+    count += names[i].empty() ? 0u : 1u;
+  }
+  return count;
+}
+
+template <std::size_t N>
+constexpr std::size_t CountNameChars(
+    const std::array<std::string_view, N>& names) {
+  std::size_t count = 0u;
+  for (std::size_t i = 0u; i < N; ++i) {
+    count += names[i].empty() ? 0u : names[i].size() + 1u;
+  }
+  return count;
+}
+
+// all non-empty names, each null terminated
+template <std::size_t C, std::size_t N>
+constexpr std::array<char, C> JoinNames(
+    const std::array<std::string_view, N>& names) {
+  std::array<char, C> chars{};
+  std::size_t offset = 0u;
+  for (std::size_t i = 0u; i < N; ++i) {
+    for (char c : names[i]) {
+      chars[offset++] = c;
+    }
+    if (!names[i].empty()) {
+      chars[offset++] = '\0';
+    }
+  }
+  return chars;
+}
+
+// pointer into the joined names per range value, nullptr for gaps
+template <std::size_t N, std::size_t C>
+constexpr std::array<const char*, N> NamePointers(
+    const std::array<std::string_view, N>& names,
+    const std::array<char, C>& chars) {
+  std::array<const char*, N> pointers{};
+  std::size_t offset = 0u;
+  for (std::size_t i = 0u; i < N; ++i) {
+    if (names[i].empty()) {
+      pointers[i] = nullptr;
+    } else {
+      pointers[i] = chars.data() + offset;
+      offset += names[i].size() + 1u;
+    }
+  }
+  return pointers;
+}
+
+template <typename E, int Min, std::size_t Count, std::size_t N>
+constexpr std::array<E, Count> RangeValues(
+    const std::array<std::string_view, N>& names) {
+  std::array<E, Count> values{};
+  std::size_t count = 0u;
+  for (std::size_t i = 0u; i < N; ++i) {
+    if (!names[i].empty()) {
+      values[count++] = static_cast<E>(Min + static_cast<int>(i));
+    }
+  }
+  return values;
+}
+
+/// Enumerators of E with values in [Min, Max], gathered at compile time.
+/// Every table is a constexpr array, lookups are array indexing.
+template <typename E, int Min, int Max>
+struct EnumReflection {
+  static_assert(Min <= Max, "Empty reflection range");
+
+  constexpr static std::size_t kRange =
+      static_cast<std::size_t>(Max - Min) + 1u;
+
+  // name per value in the range, empty for values without an enumerator
+  static constexpr std::array<std::string_view, kRange> kRangeNames =
+      EnumRangeNames<E, Min>(std::make_index_sequence<kRange>());
+
+  constexpr static std::size_t kCount = CountNames(kRangeNames);
+  static_assert(kCount > 0u, "No enumerators found in the reflection range");
+
+  static constexpr std::array<char, CountNameChars(kRangeNames)> kChars =
+      JoinNames<CountNameChars(kRangeNames)>(kRangeNames);
+
+  static constexpr std::array<const char*, kRange> kNames =
+      NamePointers(kRangeNames, kChars);
+
+  static constexpr std::array<E, kCount> kValues =
+      RangeValues<E, Min, kCount>(kRangeNames);
+
+  static constexpr const char* Name(E e) {
+    const long long value = static_cast<long long>(e);
+    if (value < Min || value > Max) {
+      return "Unknown";
+    }
+    // tested through kRangeNames, GCC does not always treat comparing a
+    // pointer into kChars against nullptr as a constant expression
+    const std::size_t index = static_cast<std::size_t>(value - Min);
+    return kRangeNames[index].empty() ? "Unknown" : kNames[index];
+  }
+};
+
+template <typename E, E Default, int Min, int Max>
+struct ReflectedEnumTrait {
+  constexpr static std::size_t num_values() {
+    return EnumReflection<E, Min, Max>::kCount;
+  }
+  constexpr static E default_value() { return Default; }
+  constexpr static const char* to_string(E e) {
+    return EnumReflection<E, Min, Max>::Name(e);
+  }
+};
+
+template <typename E, int Min, int Max>
+struct ReflectedEnumListTrait {
+  static constexpr std::array<E, EnumReflection<E, Min, Max>::kCount>
+  values() {
+    return EnumReflection<E, Min, Max>::kValues;
+  }
+};
+
+}  // namespace internal
+
+/// Default range of values searched by COMMON_REFLECT_ENUM
+constexpr int kEnumReflectionMin = 0;
+constexpr int kEnumReflectionMax = 127;
+
+}  // namespace common
+
+/// Specializes common::EnumTrait and common::EnumListTrait for @p type from
+/// its enumerators with values in [min, max]: num_values() counts them,
+/// to_string() returns the enumerator name (e.g. "kRed") and values() lists
+/// them in ascending order. Must be used at global namespace scope. The enum
+/// needs a fixed underlying type (every enum class has one) so that casting
+/// range values without an enumerator is well formed.
+#define COMMON_REFLECT_ENUM_RANGE(type, default_value, min, max)             \
+  namespace common {                                                        \
+  template <>                                                               \
+  struct EnumTrait<type>                                                    \
+      : internal::ReflectedEnumTrait<type, default_value, min, max> {};     \
+  template <>                                                               \
+  struct EnumListTrait<type>                                                \
+      : internal::ReflectedEnumListTrait<type, min, max> {};                \
+  }
+
+/// COMMON_REFLECT_ENUM_RANGE over [kEnumReflectionMin, kEnumReflectionMax]
+#define COMMON_REFLECT_ENUM(type, default_value)                    \
+  COMMON_REFLECT_ENUM_RANGE(type, default_value,                   \
+                            ::common::kEnumReflectionMin,          \
+                            ::common::kEnumReflectionMax)
+
+#endif  // COMMON_ENUM_REFLECTION_H_
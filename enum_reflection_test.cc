@@ -0,0 +1,63 @@
+#include "common/enum_reflection.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Color { kRed, kGreen, kBlue };
+
+enum class Sparse : std::int16_t { kFirst = 1, kSecond = 5, kThird = 9 };
+
+enum Unscoped : int { kUnscopedA = 2, kUnscopedB = 3 };
+
+}  // namespace test_namespace
+
+COMMON_REFLECT_ENUM(test_namespace::Color, test_namespace::Color::kGreen)
+COMMON_REFLECT_ENUM(test_namespace::Sparse, test_namespace::Sparse::kFirst)
+COMMON_REFLECT_ENUM_RANGE(test_namespace::Unscoped, test_namespace::kUnscopedB,
+                          -4, 4)
+
+namespace test_namespace {
+
+TEST(EnumReflectionTest, TraitTest) {
+  using Trait = common::EnumTrait<Color>;
+  static_assert(Trait::num_values() == 3u, "");
+  static_assert(Trait::default_value() == Color::kGreen, "");
+  static_assert(Trait::to_string(Color::kBlue)[1] == 'B', "");
+  EXPECT_STREQ(Trait::to_string(Color::kRed), "kRed");
+  EXPECT_STREQ(Trait::to_string(Color::kGreen), "kGreen");
+  EXPECT_STREQ(Trait::to_string(Color::kBlue), "kBlue");
+  EXPECT_STREQ(Trait::to_string(static_cast<Color>(3)), "Unknown");
+  EXPECT_STREQ(Trait::to_string(static_cast<Color>(1000)), "Unknown");
+
+  constexpr auto values = common::EnumListTrait<Color>::values();
+  static_assert(values.size() == 3u, "");
+  EXPECT_EQ(values[0], Color::kRed);
+  EXPECT_EQ(values[1], Color::kGreen);
+  EXPECT_EQ(values[2], Color::kBlue);
+}
+
+TEST(EnumReflectionTest, SparseTest) {
+  using Trait = common::EnumTrait<Sparse>;
+  static_assert(Trait::num_values() == 3u, "");
+  constexpr auto values = common::EnumListTrait<Sparse>::values();
+  EXPECT_EQ(values[0], Sparse::kFirst);
+  EXPECT_EQ(values[1], Sparse::kSecond);
+  EXPECT_EQ(values[2], Sparse::kThird);
+  EXPECT_STREQ(Trait::to_string(Sparse::kSecond), "kSecond");
+  EXPECT_STREQ(Trait::to_string(static_cast<Sparse>(2)), "Unknown");
+  EXPECT_STREQ(Trait::to_string(static_cast<Sparse>(-1)), "Unknown");
+}
+
+TEST(EnumReflectionTest, UnscopedTest) {
+  using Trait = common::EnumTrait<Unscoped>;
+  static_assert(Trait::num_values() == 2u, "");
+  EXPECT_EQ(Trait::default_value(), kUnscopedB);
+  EXPECT_STREQ(Trait::to_string(kUnscopedA), "kUnscopedA");
+  EXPECT_EQ(common::EnumListTrait<Unscoped>::values()[1], kUnscopedB);
+}
+
+}  // namespace test_namespace
@@ -0,0 +1,386 @@
+#ifndef COMMON_ENUM_SET_H_
+#define COMMON_ENUM_SET_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+
+#include "common/enum_traits.h"
+
+namespace common {
+namespace internal {
+
+template <typename T, std::size_t N>
+constexpr bool IsContiguous(const std::array<T, N>& values) {
+  for (std::size_t i = 0u; i < N; ++i) {
+    if (static_cast<long long>(values[i]) !=
+        static_cast<long long>(values[0]) + static_cast<long long>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// positions into values, ordered by value
+template <typename T, std::size_t N>
+constexpr std::array<std::uint32_t, N> SortedPositions(
+    const std::array<T, N>& values) {
+  std::array<std::uint32_t, N> positions{};
+  for (std::size_t i = 0u; i < N; ++i) {
+    positions[i] = static_cast<std::uint32_t>(i);
+  }
+  for (std::size_t i = 1u; i < N; ++i) {
+    for (std::size_t j = i;
+         j > 0u && static_cast<long long>(values[positions[j]]) <
+                       static_cast<long long>(values[positions[j - 1u]]);
+         --j) {
+      const std::uint32_t swap = positions[j];
+      positions[j] = positions[j - 1u];
+      positions[j - 1u] = swap;
+    }
+  }
+  return positions;
+}
+
+/// Maps the values of T to their position in EnumListTrait<T>::values(),
+/// which must be constexpr. Enums whose values are contiguous are indexed
+/// with a subtraction, others with a binary search.
+template <typename T>
+struct EnumIndex {
+  constexpr static std::size_t kSize = EnumTrait<T>::num_values();
+
+  static constexpr std::array<T, kSize> kValues = EnumListTrait<T>::values();
+
+  constexpr static bool kContiguous = IsContiguous(kValues);
+
+  static constexpr std::array<std::uint32_t, kSize> kSorted =
+      SortedPositions(kValues);
+
+  /// @return  the position of @p value, or kSize if it is not listed
+  static constexpr std::size_t Of(T value) {
+    const long long key = static_cast<long long>(value);
+    if (kSize == 0u) {
+      return kSize;
+    }
+    if (kContiguous) {
+      const long long index = key - static_cast<long long>(kValues[0]);
+      return index >= 0 && index < static_cast<long long>(kSize)
+                 ? static_cast<std::size_t>(index)
+                 : kSize;
+    }
+    std::size_t low = 0u;
+    std::size_t high = kSize;
+    while (low < high) {
+      const std::size_t mid = low + (high - low) / 2u;
+      if (static_cast<long long>(kValues[kSorted[mid]]) < key) {
+        low = mid + 1u;
+      } else {
+        high = mid;
+      }
+    }
+    return low < kSize && static_cast<long long>(kValues[kSorted[low]]) == key
+               ? kSorted[low]
+               : kSize;
+  }
+};
+
+}  // namespace internal
+
+/// @class EnumSet
+/// Set of values of the enum T, one bit per value of
+/// EnumListTrait<T>::values(), which must be constexpr. Sets of up to 64
+/// values are a single word. The set is trivially copyable and holds nothing
+/// but its words, so arrays of sets can be scanned with the bulk functions
+/// below.
+template <typename T>
+class EnumSet {
+  using Index = internal::EnumIndex<T>;
+
+ public:
+  constexpr static std::size_t kSize = Index::kSize;
+  constexpr static std::size_t kWords = kSize > 64u ? (kSize + 63u) / 64u : 1u;
+
+  using Word = std::uint64_t;
+  using Words = std::array<Word, kWords>;
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = T;
+
+    constexpr T operator*() const {
+      return Index::kValues[word_ * 64u +
+                            static_cast<std::size_t>(__builtin_ctzll(bits_))];
+    }
+
+    constexpr Iterator& operator++() {
+      bits_ &= bits_ - 1u;
+      Skip();
+      return *this;
+    }
+
+    constexpr Iterator operator++(int) {
+      Iterator copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    constexpr bool operator==(const Iterator& other) const {
+      return word_ == other.word_ && bits_ == other.bits_;
+    }
+    constexpr bool operator!=(const Iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class EnumSet;
+
+    constexpr Iterator(const Words* words, std::size_t word)
+        : words_(words),
+          word_(word),
+          bits_(word < kWords ? (*words)[word] : 0u) {
+      Skip();
+    }
+
+    // moves to the next non-empty word, or to the end
+    constexpr void Skip() {
+      while (bits_ == 0u && word_ < kWords) {
+        ++word_;
+        bits_ = word_ < kWords ? (*words_)[word_] : 0u;
+      }
+    }
+
+    const Words* words_;
+    std::size_t word_;
+    Word bits_;
+  };
+
+  constexpr EnumSet() : words_{} {}
+
+  constexpr EnumSet(std::initializer_list<T> values) : words_{} {
+    for (T value : values) {
+      Insert(value);
+    }
+  }
+
+  /// @return  a set with every value of T
+  static constexpr EnumSet All() {
+    EnumSet set;
+    for (std::size_t i = 0u; i < kSize; ++i) {
+      set.words_[i / 64u] |= Word{1} << (i % 64u);
+    }
+    return set;
+  }
+
+  /// @param words  bit i of word i / 64 is EnumListTrait<T>::values()[i]
+  static constexpr EnumSet FromWords(const Words& words) {
+    EnumSet set;
+    set.words_ = words;
+    set.words_[kWords - 1u] &= All().words_[kWords - 1u];
+    return set;
+  }
+
+  /// Values that are not listed by EnumListTrait<T> are ignored
+  constexpr void Insert(T value) {
+    const std::size_t index = Index::Of(value);
+    if (index < kSize) {
+      words_[index / 64u] |= Word{1} << (index % 64u);
+    }
+  }
+
+  constexpr void Erase(T value) {
+    const std::size_t index = Index::Of(value);
+    if (index < kSize) {
+      words_[index / 64u] &= ~(Word{1} << (index % 64u));
+    }
+  }
+
+  constexpr bool Contains(T value) const {
+    const std::size_t index = Index::Of(value);
+    return index < kSize && (words_[index / 64u] >> (index % 64u)) & 1u;
+  }
+
+  constexpr void Clear() { words_ = Words{}; }
+
+  /// @return  true if every value of @p other is in this set
+  constexpr bool ContainsAll(const EnumSet& other) const {
+    Word missing = 0u;
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      missing |= other.words_[i] & ~words_[i];
+    }
+    return missing == 0u;
+  }
+
+  /// @return  true if the sets share a value
+  constexpr bool Intersects(const EnumSet& other) const {
+    Word common = 0u;
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      common |= other.words_[i] & words_[i];
+    }
+    return common != 0u;
+  }
+
+  constexpr std::size_t size() const {
+    std::size_t count = 0u;
+    for (Word word : words_) {
+      count += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+    return count;
+  }
+
+  constexpr bool empty() const {
+    Word any = 0u;
+    for (Word word : words_) {
+      any |= word;
+    }
+    return any == 0u;
+  }
+
+  constexpr const Words& words() const { return words_; }
+
+  constexpr Iterator begin() const { return Iterator(&words_, 0u); }
+  constexpr Iterator end() const { return Iterator(&words_, kWords); }
+
+  /// Calls @p f with each value in the set, in EnumListTrait<T> order
+  template <typename F>
+  constexpr void ForEach(F&& f) const {
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      for (Word bits = words_[i]; bits != 0u; bits &= bits - 1u) {
+        f(Index::kValues[i * 64u +
+                         static_cast<std::size_t>(__builtin_ctzll(bits))]);
+      }
+    }
+  }
+
+  constexpr EnumSet& operator|=(const EnumSet& other) {
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      words_[i] |= other.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr EnumSet& operator&=(const EnumSet& other) {
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      words_[i] &= other.words_[i];
+    }
+    return *this;
+  }
+
+  /// Difference
+  constexpr EnumSet& operator-=(const EnumSet& other) {
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      words_[i] &= ~other.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr EnumSet& operator^=(const EnumSet& other) {
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      words_[i] ^= other.words_[i];
+    }
+    return *this;
+  }
+
+  friend constexpr EnumSet operator|(EnumSet a, const EnumSet& b) {
+    return a |= b;
+  }
+  friend constexpr EnumSet operator&(EnumSet a, const EnumSet& b) {
+    return a &= b;
+  }
+  friend constexpr EnumSet operator-(EnumSet a, const EnumSet& b) {
+    return a -= b;
+  }
+  friend constexpr EnumSet operator^(EnumSet a, const EnumSet& b) {
+    return a ^= b;
+  }
+
+  /// Complement within the values of T
+  constexpr EnumSet operator~() const { return All() - *this; }
+
+  friend constexpr bool operator==(const EnumSet& a, const EnumSet& b) {
+    Word diff = 0u;
+    for (std::size_t i = 0u; i < kWords; ++i) {
+      diff |= a.words_[i] ^ b.words_[i];
+    }
+    return diff == 0u;
+  }
+  friend constexpr bool operator!=(const EnumSet& a, const EnumSet& b) {
+    return !(a == b);
+  }
+
+ private:
+  Words words_;
+};
+
+// Bulk queries over arrays of sets. The loops have no data dependent
+// branches so that the compiler can vectorize them.
+
+/// Sets matches[i] to whether sets[i] contains every value of @p required
+template <typename T>
+void ContainsAll(const EnumSet<T>* sets, std::size_t count,
+                 const EnumSet<T>& required, bool* matches) {
+  for (std::size_t i = 0u; i < count; ++i) {
+    typename EnumSet<T>::Word missing = 0u;
+    for (std::size_t w = 0u; w < EnumSet<T>::kWords; ++w) {
+      missing |= required.words()[w] & ~sets[i].words()[w];
+    }
+    matches[i] = missing == 0u;
+  }
+}
+
+/// Sets matches[i] to whether sets[i] shares a value with @p any
+template <typename T>
+void Intersects(const EnumSet<T>* sets, std::size_t count,
+                const EnumSet<T>& any, bool* matches) {
+  for (std::size_t i = 0u; i < count; ++i) {
+    typename EnumSet<T>::Word common = 0u;
+    for (std::size_t w = 0u; w < EnumSet<T>::kWords; ++w) {
+      common |= any.words()[w] & sets[i].words()[w];
+    }
+    matches[i] = common != 0u;
+  }
+}
+
+/// @return  the number of sets that contain every value of @p required
+template <typename T>
+std::size_t CountContainingAll(const EnumSet<T>* sets, std::size_t count,
+                               const EnumSet<T>& required) {
+  std::size_t matches = 0u;
+  for (std::size_t i = 0u; i < count; ++i) {
+    typename EnumSet<T>::Word missing = 0u;
+    for (std::size_t w = 0u; w < EnumSet<T>::kWords; ++w) {
+      missing |= required.words()[w] & ~sets[i].words()[w];
+    }
+    matches += missing == 0u ? 1u : 0u;
+  }
+  return matches;
+}
+
+/// Writes the indices of the sets that contain every value of @p required
+/// to @p indices, which must have room for @p count entries
+/// @return  the number of indices written
+template <typename T>
+std::size_t SelectContainingAll(const EnumSet<T>* sets, std::size_t count,
+                                const EnumSet<T>& required,
+                                std::uint32_t* indices) {
+  std::size_t selected = 0u;
+  for (std::size_t i = 0u; i < count; ++i) {
+    typename EnumSet<T>::Word missing = 0u;
+    for (std::size_t w = 0u; w < EnumSet<T>::kWords; ++w) {
+      missing |= required.words()[w] & ~sets[i].words()[w];
+    }
+    indices[selected] = static_cast<std::uint32_t>(i);
+    selected += missing == 0u ? 1u : 0u;
+  }
+  return selected;
+}
+
+}  // namespace common
+
+#endif  // COMMON_ENUM_SET_H_
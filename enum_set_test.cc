@@ -0,0 +1,196 @@
+#include "common/enum_set.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/enum_reflection.h"
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Flag { kRead, kWrite, kExecute, kDelete };
+
+// listed out of order and with gaps
+enum class Level : int { kHigh = 30, kLow = -2, kMedium = 7 };
+
+// more values than fit in one word
+enum class Wide : int { kFirst = 0, kLast = 149 };
+
+}  // namespace test_namespace
+
+COMMON_REFLECT_ENUM(test_namespace::Flag, test_namespace::Flag::kRead)
+
+namespace common {
+
+template <>
+struct EnumTrait<test_namespace::Level> {
+  constexpr static size_t num_values() { return 3; }
+  constexpr static test_namespace::Level default_value() {
+    return test_namespace::Level::kLow;
+  }
+  constexpr static const char* to_string(test_namespace::Level) {
+    return "Level";
+  }
+};
+
+template <>
+struct EnumListTrait<test_namespace::Level> {
+  static constexpr std::array<test_namespace::Level, 3> values() {
+    return {{test_namespace::Level::kHigh, test_namespace::Level::kLow,
+             test_namespace::Level::kMedium}};
+  }
+};
+
+template <>
+struct EnumTrait<test_namespace::Wide> {
+  constexpr static size_t num_values() { return 150; }
+  constexpr static test_namespace::Wide default_value() {
+    return test_namespace::Wide::kFirst;
+  }
+  constexpr static const char* to_string(test_namespace::Wide) {
+    return "Wide";
+  }
+};
+
+template <>
+struct EnumListTrait<test_namespace::Wide> {
+  template <std::size_t... I>
+  static constexpr std::array<test_namespace::Wide, 150> Make(
+      std::index_sequence<I...>) {
+    return {{static_cast<test_namespace::Wide>(I)...}};
+  }
+  static constexpr std::array<test_namespace::Wide, 150> values() {
+    return Make(std::make_index_sequence<150>());
+  }
+};
+
+}  // namespace common
+
+namespace test_namespace {
+
+using FlagSet = common::EnumSet<Flag>;
+using LevelSet = common::EnumSet<Level>;
+using WideSet = common::EnumSet<Wide>;
+
+Wide W(int value) { return static_cast<Wide>(value); }
+
+TEST(EnumSetTest, SizeTest) {
+  static_assert(sizeof(FlagSet) == sizeof(std::uint64_t), "");
+  static_assert(sizeof(WideSet) == 3u * sizeof(std::uint64_t), "");
+  static_assert(std::is_trivially_copyable<WideSet>::value, "");
+  EXPECT_EQ(FlagSet::kWords, 1u);
+  EXPECT_EQ(WideSet::kWords, 3u);
+}
+
+TEST(EnumSetTest, ConstexprTest) {
+  constexpr FlagSet read_write = {Flag::kRead, Flag::kWrite};
+  constexpr FlagSet write_execute = {Flag::kWrite, Flag::kExecute};
+  static_assert((read_write | write_execute).size() == 3u, "");
+  static_assert((read_write & write_execute) == FlagSet{Flag::kWrite}, "");
+  static_assert((read_write - write_execute) == FlagSet{Flag::kRead}, "");
+  static_assert((read_write ^ write_execute) ==
+                    FlagSet({Flag::kRead, Flag::kExecute}),
+                "");
+  static_assert(~read_write == FlagSet({Flag::kExecute, Flag::kDelete}), "");
+  static_assert(FlagSet::All().size() == 4u, "");
+  static_assert(read_write.Contains(Flag::kWrite), "");
+  static_assert(!read_write.Contains(Flag::kDelete), "");
+  static_assert(FlagSet::All().ContainsAll(read_write), "");
+  static_assert(!read_write.ContainsAll(write_execute), "");
+  static_assert(read_write.Intersects(write_execute), "");
+  static_assert(*read_write.begin() == Flag::kRead, "");
+  static_assert(FlagSet().empty(), "");
+}
+
+TEST(EnumSetTest, InsertEraseTest) {
+  FlagSet set;
+  EXPECT_TRUE(set.empty());
+  set.Insert(Flag::kDelete);
+  set.Insert(Flag::kDelete);
+  set.Insert(Flag::kRead);
+  EXPECT_EQ(set.size(), 2u);
+  EXPECT_TRUE(set.Contains(Flag::kDelete));
+  set.Erase(Flag::kDelete);
+  EXPECT_FALSE(set.Contains(Flag::kDelete));
+  // not listed by EnumListTrait
+  set.Insert(static_cast<Flag>(17));
+  EXPECT_FALSE(set.Contains(static_cast<Flag>(17)));
+  EXPECT_EQ(set.size(), 1u);
+  set.Clear();
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(EnumSetTest, SparseTest) {
+  LevelSet set = {Level::kMedium, Level::kHigh};
+  EXPECT_TRUE(set.Contains(Level::kHigh));
+  EXPECT_TRUE(set.Contains(Level::kMedium));
+  EXPECT_FALSE(set.Contains(Level::kLow));
+  EXPECT_FALSE(set.Contains(static_cast<Level>(8)));
+  EXPECT_EQ(set.words()[0], 0b101u);
+  // iteration follows EnumListTrait order
+  std::vector<Level> values(set.begin(), set.end());
+  EXPECT_EQ(values, (std::vector<Level>{Level::kHigh, Level::kMedium}));
+  EXPECT_EQ(~set, LevelSet{Level::kLow});
+}
+
+TEST(EnumSetTest, WideTest) {
+  WideSet set = {W(0), W(63), W(64), W(127), W(128), W(149)};
+  EXPECT_EQ(set.size(), 6u);
+  std::vector<Wide> values;
+  set.ForEach([&values](Wide value) { values.push_back(value); });
+  EXPECT_EQ(values, (std::vector<Wide>{W(0), W(63), W(64), W(127), W(128),
+                                       W(149)}));
+  std::vector<Wide> iterated;
+  for (Wide value : set) {
+    iterated.push_back(value);
+  }
+  EXPECT_EQ(iterated, values);
+  EXPECT_FALSE(set.Contains(W(150)));
+  EXPECT_EQ(WideSet::All().size(), 150u);
+  EXPECT_EQ((~set).size(), 144u);
+  EXPECT_TRUE((~set & set).empty());
+
+  WideSet::Words words;
+  words.fill(~std::uint64_t{0});
+  EXPECT_EQ(WideSet::FromWords(words), WideSet::All());
+}
+
+TEST(EnumSetTest, BulkTest) {
+  std::vector<WideSet> sets(100);
+  for (int i = 0; i < 100; ++i) {
+    sets[i].Insert(W(i));
+    if (i % 3 == 0) {
+      sets[i].Insert(W(140));
+    }
+    if (i % 5 == 0) {
+      sets[i].Insert(W(7));
+    }
+  }
+  const WideSet required = {W(7), W(140)};
+
+  std::unique_ptr<bool[]> matches(new bool[sets.size()]);
+  common::ContainsAll(sets.data(), sets.size(), required,
+                      matches.get());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(matches[i], i % 15 == 0) << i;
+  }
+  EXPECT_EQ(common::CountContainingAll(sets.data(), sets.size(), required),
+            7u);
+
+  std::vector<std::uint32_t> indices(sets.size());
+  const std::size_t selected = common::SelectContainingAll(
+      sets.data(), sets.size(), required, indices.data());
+  ASSERT_EQ(selected, 7u);
+  for (std::size_t i = 0; i < selected; ++i) {
+    EXPECT_EQ(indices[i], 15u * i);
+  }
+
+  common::Intersects(sets.data(), sets.size(), WideSet{W(99), W(140)},
+                     matches.get());
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(matches[i], i % 3 == 0 || i == 99) << i;
+  }
+}
+
+}  // namespace test_namespace
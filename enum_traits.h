@@ -2,7 +2,9 @@
 #define COMMON_ENUM_TRAITS_H_
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <utility>
 
 namespace common {
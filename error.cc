@@ -1,30 +1,229 @@
 #include "common/error.h"
 
+#include <atomic>
+#include <cstring>
+
+#include "common/buffer_writer.h"
+#include "common/memory/memory_metrics.h"
+
 namespace common {
 
-const char* ErrorString(Error error) {
-  switch (error) {
-    case Error::kNotFound:
-      return "Not found";
-    case Error::kUnavailable:
-      return "Unavailable";
-    case Error::kOutOfRange:
-      return "Out of range";
-    case Error::kInvalidArgument:
-      return "Invalid Argument";
-    case Error::kInternal:
-      return "Internal";
-      // no default. Let -werror=switch catch missing enum cases
+namespace {
+
+std::atomic<internal::ErrorSinkHook> g_error_sink_hook{nullptr};
+
+}  // namespace
+
+namespace internal {
+
+#ifdef COMMON_ERROR_SINK
+void NotifyErrorSink(const ErrorWithExplanation& error) {
+  ErrorSinkHook hook = g_error_sink_hook.load(std::memory_order_acquire);
+  if (hook != nullptr) {
+    hook(error);
   }
-  return "Unknown";
+}
+#endif
+
+void SetErrorSinkHook(ErrorSinkHook hook) {
+  g_error_sink_hook.store(hook, std::memory_order_release);
 }
 
+}  // namespace internal
+
+#ifdef COMMON_ERROR_METRICS
+ErrorWithExplanation::ErrorWithExplanation(Error error_code,
+                                           std::string_view explanation,
+                                           ErrorSite site)
+    : ErrorWithExplanation(error_code, Kind::kInline) {
+  internal::RecordErrorEvent(ErrorEvent::kErrorWithExplanation, error_code,
+                             site);
+#else
 ErrorWithExplanation::ErrorWithExplanation(Error error_code,
-                                           const std::string& explanation)
-    : error_code_(error_code), explanation_(explanation) {}
+                                           std::string_view explanation)
+    : ErrorWithExplanation(error_code, Kind::kInline) {
+#endif
+  if (explanation.size() <= kInlineCapacity) {
+    std::memcpy(storage_.chars, explanation.data(), explanation.size());
+    size_ = static_cast<std::uint8_t>(explanation.size());
+  } else {
+    kind_ = Kind::kHeap;
+    char* copy = new char[explanation.size()];
+    TrackAllocation(MemoryMetrics::kErrorTag, explanation.size());
+    std::memcpy(copy, explanation.data(), explanation.size());
+    storage_.view.data = copy;
+    storage_.view.size = explanation.size();
+  }
+#ifdef COMMON_ERROR_SINK
+  internal::NotifyErrorSink(*this);
+#endif
+}
+
+ErrorWithExplanation::ErrorWithExplanation(const ErrorWithExplanation& other) {
+  CopyFrom(other);
+}
+
+ErrorWithExplanation::ErrorWithExplanation(ErrorWithExplanation&& other)
+    : error_code_(other.error_code_),
+      kind_(other.kind_),
+      size_(other.size_),
+      arg_types_(other.arg_types_),
+      storage_(other.storage_) {
+  other.kind_ = Kind::kLiteral;
+  other.storage_.view.data = "";
+  other.storage_.view.size = 0u;
+}
+
+ErrorWithExplanation::~ErrorWithExplanation() { Release(); }
+
+ErrorWithExplanation& ErrorWithExplanation::operator=(
+    const ErrorWithExplanation& other) {
+  if (this != &other) {
+    Release();
+    CopyFrom(other);
+  }
+  return *this;
+}
+
+ErrorWithExplanation& ErrorWithExplanation::operator=(
+    ErrorWithExplanation&& other) {
+  if (this != &other) {
+    Release();
+    error_code_ = other.error_code_;
+    kind_ = other.kind_;
+    size_ = other.size_;
+    arg_types_ = other.arg_types_;
+    storage_ = other.storage_;
+    other.kind_ = Kind::kLiteral;
+    other.storage_.view.data = "";
+    other.storage_.view.size = 0u;
+  }
+  return *this;
+}
+
+ErrorWithExplanation ErrorWithExplanation::InlineCopy(bool* truncated) const {
+  if (truncated != nullptr) {
+    *truncated = kind_ == Kind::kHeap;
+  }
+  if (kind_ != Kind::kHeap) {
+    return *this;
+  }
+  ErrorWithExplanation copy(error_code_, Kind::kInline);
+  copy.size_ = static_cast<std::uint8_t>(kInlineCapacity);
+  std::memcpy(copy.storage_.chars, storage_.view.data, kInlineCapacity);
+  return copy;
+}
 
 std::string ErrorWithExplanation::Explain() const {
-  return std::string(ErrorString(error_code_)) + ": " + explanation_;
+  std::string explanation(Explain(nullptr, 0u), '\0');
+  // std::string always keeps room for the terminator
+  Explain(&explanation[0], explanation.size() + 1u);
+  return explanation;
+}
+
+std::size_t ErrorWithExplanation::Explain(char* buffer,
+                                          std::size_t size) const {
+  internal::BufferWriter writer(buffer, size);
+  writer.Append(ErrorString(error_code_));
+  writer.Append(": ", 2u);
+  WriteExplanation(&writer);
+  return writer.Finish();
+}
+
+void ErrorWithExplanation::WriteExplanation(
+    internal::BufferWriter* writer) const {
+  switch (kind_) {
+    case Kind::kLiteral:
+    case Kind::kHeap:
+      writer->Append(storage_.view.data, storage_.view.size);
+      break;
+    case Kind::kInline:
+      writer->Append(storage_.chars, size_);
+      break;
+    case Kind::kFormat: {
+      const char* text = storage_.format.text;
+      std::size_t next_arg = 0u;
+      while (*text != '\0') {
+        const char* placeholder = std::strstr(text, "{}");
+        if (placeholder == nullptr || next_arg >= size_) {
+          writer->Append(text);
+          break;
+        }
+        writer->Append(text, static_cast<std::size_t>(placeholder - text));
+        const Arg& arg = storage_.format.args[next_arg];
+        switch (arg_type(next_arg)) {
+          case ArgType::kSigned:
+            writer->AppendNumber(arg.i);
+            break;
+          case ArgType::kUnsigned:
+            writer->AppendNumber(arg.u);
+            break;
+          case ArgType::kDouble:
+            writer->AppendNumber(arg.d);
+            break;
+          case ArgType::kBool:
+            writer->Append(arg.u != 0u ? "true" : "false");
+            break;
+          case ArgType::kChar: {
+            const char c = static_cast<char>(arg.u);
+            writer->Append(&c, 1u);
+            break;
+          }
+          case ArgType::kString:
+            writer->Append(arg.s);
+            break;
+            // no default. Let -werror=switch catch missing enum cases
+        }
+        ++next_arg;
+        text = placeholder + 2;
+      }
+      break;
+    }
+      // no default. Let -werror=switch catch missing enum cases
+  }
+}
+
+void ErrorWithExplanation::FormatNow() {
+  char text[kInlineCapacity + 1u];
+  internal::BufferWriter writer(text, sizeof(text));
+  WriteExplanation(&writer);
+  const std::size_t size = writer.Finish();
+  if (size <= kInlineCapacity) {
+    std::memcpy(storage_.chars, text, size);
+    kind_ = Kind::kInline;
+    size_ = static_cast<std::uint8_t>(size);
+  } else {
+    char* copy = new char[size];
+    TrackAllocation(MemoryMetrics::kErrorTag, size);
+    // without Finish() the writer stops at size chars, no terminator
+    internal::BufferWriter copy_writer(copy, size + 1u);
+    WriteExplanation(&copy_writer);
+    kind_ = Kind::kHeap;
+    storage_.view.data = copy;
+    storage_.view.size = size;
+  }
+  arg_types_ = 0u;
+}
+
+void ErrorWithExplanation::CopyFrom(const ErrorWithExplanation& other) {
+  error_code_ = other.error_code_;
+  kind_ = other.kind_;
+  size_ = other.size_;
+  arg_types_ = other.arg_types_;
+  storage_ = other.storage_;
+  if (kind_ == Kind::kHeap) {
+    char* copy = new char[storage_.view.size];
+    TrackAllocation(MemoryMetrics::kErrorTag, storage_.view.size);
+    std::memcpy(copy, other.storage_.view.data, storage_.view.size);
+    storage_.view.data = copy;
+  }
+}
+
+void ErrorWithExplanation::Release() {
+  if (kind_ == Kind::kHeap) {
+    delete[] storage_.view.data;
+    TrackDeallocation(MemoryMetrics::kErrorTag, storage_.view.size);
+  }
 }
 
-}  // namespace common
\ No newline at end of file
+}  // namespace common
@@ -1,7 +1,20 @@
 #ifndef COMMON_ERROR_H_
 #define COMMON_ERROR_H_
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "common/enum_traits.h"
+
+#ifdef COMMON_ERROR_METRICS
+#include "common/error_site.h"
+#endif
 
 namespace common {
 
@@ -13,19 +26,312 @@ enum class Error {
   kInternal,
 };
 
-const char* ErrorString(Error error);
+namespace internal {
+
+// Indexed by Error, keep in the same order
+inline constexpr const char* kErrorStrings[] = {
+    "Not found", "Unavailable", "Out of range", "Invalid Argument", "Internal",
+};
+
+inline constexpr std::size_t kNumErrors =
+    sizeof(kErrorStrings) / sizeof(kErrorStrings[0]);
+
+static_assert(kNumErrors == static_cast<std::size_t>(Error::kInternal) + 1u,
+              "kErrorStrings must have one entry per Error");
 
+template <std::size_t... I>
+constexpr std::array<Error, sizeof...(I)> ErrorValues(
+    std::index_sequence<I...>) {
+  return {{static_cast<Error>(I)...}};
+}
+
+constexpr bool Equal(std::string_view a, const char* b) {
+  std::size_t i = 0u;
+  for (; i < a.size(); ++i) {
+    if (b[i] != a[i] || b[i] == '\0') {
+      return false;
+    }
+  }
+  return b[i] == '\0';
+}
+
+}  // namespace internal
+
+constexpr const char* ErrorString(Error error) {
+  return static_cast<std::size_t>(error) < internal::kNumErrors
+             ? internal::kErrorStrings[static_cast<std::size_t>(error)]
+             : "Unknown";
+}
+
+/// Reverse of ErrorString(), e.g. for error codes read from logs or RPCs
+/// @return  false if @p text is not the string of any Error
+constexpr bool ParseErrorString(std::string_view text, Error* error) {
+  for (std::size_t i = 0u; i < internal::kNumErrors; ++i) {
+    if (internal::Equal(text, internal::kErrorStrings[i])) {
+      *error = static_cast<Error>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <>
+struct EnumTrait<Error> {
+  constexpr static std::size_t num_values() { return internal::kNumErrors; }
+  constexpr static Error default_value() { return Error::kInternal; }
+  constexpr static const char* to_string(Error e) { return ErrorString(e); }
+};
+
+template <>
+struct EnumListTrait<Error> {
+  static constexpr std::array<Error, internal::kNumErrors> values() {
+    return internal::ErrorValues(
+        std::make_index_sequence<internal::kNumErrors>());
+  }
+};
+
+class ErrorWithExplanation;
+
+namespace internal {
+
+class BufferWriter;
+
+#ifdef COMMON_ERROR_METRICS
+/// Counts one error event, see common/error_metrics.h. Lock-free.
+void RecordErrorEvent(ErrorEvent event, Error error_code,
+                      const ErrorSite& site);
+#endif
+
+#ifdef COMMON_ERROR_SINK
+/// Hands a new error to the installed hook, see common/error_sink.h
+void NotifyErrorSink(const ErrorWithExplanation& error);
+#endif
+
+/// Receives every ErrorWithExplanation created while COMMON_ERROR_SINK is
+/// defined. nullptr, the default, disables the hook.
+using ErrorSinkHook = void (*)(const ErrorWithExplanation& error);
+void SetErrorSinkHook(ErrorSinkHook hook);
+
+}  // namespace internal
+
+/// @class ErrorWithExplanation
+/// Error code paired with a human readable explanation. The explanation is
+/// stored without allocating whenever possible:
+///  - explanations of up to kInlineCapacity chars are copied inline
+///  - with the kStatic tag the explanation is kept as a pointer, for string
+///    literals and other strings that outlive every copy of the error
+///  - Format() keeps a literal format string and its scalar arguments, the
+///    text is only produced when Explain() is called
+/// Only explanations longer than kInlineCapacity chars are copied to the
+/// heap, recorded under MemoryMetrics::kErrorTag when built with
+/// COMMON_MEMORY_TRACKING.
 class ErrorWithExplanation {
  public:
-  ErrorWithExplanation(Error error_code, const std::string& explanation);
+  constexpr static std::size_t kInlineCapacity = 40u;
+  constexpr static std::size_t kMaxFormatArgs = 4u;
+
+  /// Tag of the constructors keeping a pointer to the explanation
+  struct Static {};
+  constexpr static Static kStatic{};
+
+#ifdef COMMON_ERROR_METRICS
+  // With COMMON_ERROR_METRICS every constructor below records its call site
+
+  ErrorWithExplanation(Error error_code, std::string_view explanation,
+                       ErrorSite site = ErrorSite::Current());
+
+  template <std::size_t N>
+  ErrorWithExplanation(Error error_code, const char (&explanation)[N],
+                       ErrorSite site = ErrorSite::Current())
+      : ErrorWithExplanation(
+            error_code,
+            std::string_view(explanation, strnlen(explanation, N)), site) {}
+
+  ErrorWithExplanation(Error error_code, Static,
+                       std::string_view explanation,
+                       ErrorSite site = ErrorSite::Current())
+      : ErrorWithExplanation(error_code, Kind::kLiteral) {
+    storage_.view.data = explanation.data();
+    storage_.view.size = explanation.size();
+    internal::RecordErrorEvent(ErrorEvent::kErrorWithExplanation, error_code,
+                               site);
+#ifdef COMMON_ERROR_SINK
+    internal::NotifyErrorSink(*this);
+#endif
+  }
+#else
+  /// Copies @p explanation, inline when it fits
+  ErrorWithExplanation(Error error_code, std::string_view explanation);
+
+  /// Copies the chars of @p explanation up to the first null char, inline
+  /// when they fit
+  template <std::size_t N>
+  ErrorWithExplanation(Error error_code, const char (&explanation)[N])
+      : ErrorWithExplanation(
+            error_code,
+            std::string_view(explanation, strnlen(explanation, N))) {}
+
+  /// Keeps a pointer to @p explanation, which must outlive the error and
+  /// all of its copies, as string literals do
+  ErrorWithExplanation(Error error_code, Static, std::string_view explanation)
+      : ErrorWithExplanation(error_code, Kind::kLiteral) {
+    storage_.view.data = explanation.data();
+    storage_.view.size = explanation.size();
+#ifdef COMMON_ERROR_SINK
+    internal::NotifyErrorSink(*this);
+#endif
+  }
+#endif
+
+  ErrorWithExplanation(const ErrorWithExplanation& other);
+  ErrorWithExplanation(ErrorWithExplanation&& other);
+  ~ErrorWithExplanation();
+
+  ErrorWithExplanation& operator=(const ErrorWithExplanation& other);
+  ErrorWithExplanation& operator=(ErrorWithExplanation&& other);
+
+  /// Creates an error whose explanation is @p format with every "{}"
+  /// replaced by the next argument. Arguments may be integers, floating
+  /// point values, bools, chars or char arrays. Formatting is deferred until
+  /// Explain() is called, unless there is a char array argument: those are
+  /// formatted right away and the text is copied like any other runtime
+  /// string. @p format must be a string literal. With COMMON_ERROR_METRICS
+  /// the event is recorded without a call site.
+  template <std::size_t N, typename... Args>
+  static ErrorWithExplanation Format(Error error_code,
+                                     const char (&format)[N],
+                                     const Args&... args) {
+    static_assert(sizeof...(Args) <= kMaxFormatArgs,
+                  "Too many format arguments");
+    ErrorWithExplanation error(error_code, Kind::kFormat);
+    error.storage_.format.text = format;
+    error.size_ = 0u;
+    (error.AddArg(args), ...);
+    if constexpr ((std::is_array<Args>::value || ...)) {
+      error.FormatNow();
+    }
+#ifdef COMMON_ERROR_METRICS
+    internal::RecordErrorEvent(ErrorEvent::kErrorWithExplanation, error_code,
+                               ErrorSite{nullptr, 0});
+#endif
+#ifdef COMMON_ERROR_SINK
+    internal::NotifyErrorSink(error);
+#endif
+    return error;
+  }
+
+  /// The format is kept as a pointer, mutable buffers would not outlive it
+  template <std::size_t N, typename... Args>
+  static ErrorWithExplanation Format(Error error_code, char (&format)[N],
+                                     const Args&... args) = delete;
 
   Error error_code() const { return error_code_; }
 
+  /// @return  a copy that never allocates. Explanations stored on the heap
+  /// are truncated to kInlineCapacity chars.
+  /// @param truncated  set to whether the explanation was truncated, if not
+  ///                   nullptr
+  ErrorWithExplanation InlineCopy(bool* truncated = nullptr) const;
+
+  /// @return  "<ErrorString>: <explanation>", allocated once
   std::string Explain() const;
 
+  /// Writes the explanation into @p buffer, truncating to @p size - 1 chars
+  /// and always null terminating when @p size is not zero. Never allocates.
+  /// @return  length of the complete explanation, excluding the terminator
+  std::size_t Explain(char* buffer, std::size_t size) const;
+
  private:
+  enum class Kind : std::uint8_t { kLiteral, kInline, kHeap, kFormat };
+  enum class ArgType : std::uint8_t {
+    kSigned,
+    kUnsigned,
+    kDouble,
+    kBool,
+    kChar,
+    kString,
+  };
+
+  union Arg {
+    std::int64_t i;
+    std::uint64_t u;
+    double d;
+    const char* s;
+  };
+
+  struct View {
+    const char* data;
+    std::size_t size;
+  };
+
+  struct Formatted {
+    const char* text;
+    Arg args[kMaxFormatArgs];
+  };
+
+  union Storage {
+    View view;
+    char chars[kInlineCapacity];
+    Formatted format;
+  };
+
+  ErrorWithExplanation(Error error_code, Kind kind)
+      : error_code_(error_code), kind_(kind), size_(0u), arg_types_(0u) {}
+
+  template <typename T>
+  void AddArg(const T& value) {
+    Arg arg;
+    ArgType type;
+    if constexpr (std::is_same<T, bool>::value) {
+      arg.u = value ? 1u : 0u;
+      type = ArgType::kBool;
+    } else if constexpr (std::is_same<T, char>::value) {
+      arg.u = static_cast<unsigned char>(value);
+      type = ArgType::kChar;
+    } else if constexpr (std::is_integral<T>::value &&
+                         std::is_signed<T>::value) {
+      arg.i = value;
+      type = ArgType::kSigned;
+    } else if constexpr (std::is_integral<T>::value) {
+      arg.u = value;
+      type = ArgType::kUnsigned;
+    } else if constexpr (std::is_floating_point<T>::value) {
+      arg.d = value;
+      type = ArgType::kDouble;
+    } else {
+      static_assert(
+          std::is_array<T>::value &&
+              std::is_same<typename std::remove_extent<T>::type, char>::value,
+          "Unsupported format argument");
+      arg.s = value;
+      type = ArgType::kString;
+    }
+    storage_.format.args[size_] = arg;
+    arg_types_ |= static_cast<std::uint16_t>(static_cast<std::uint16_t>(type)
+                                              << (4u * size_));
+    ++size_;
+  }
+
+  ArgType arg_type(std::size_t index) const {
+    return static_cast<ArgType>((arg_types_ >> (4u * index)) & 0xFu);
+  }
+
+  // Appends the explanation, without the error string, to @p writer
+  void WriteExplanation(internal::BufferWriter* writer) const;
+  // Turns a kFormat error into a kInline or kHeap one, for arguments that
+  // may not outlive the error
+  void FormatNow();
+
+  void CopyFrom(const ErrorWithExplanation& other);
+  void Release();
+
   Error error_code_;
-  std::string explanation_;
+  Kind kind_;
+  // inline length for kInline, argument count for kFormat
+  std::uint8_t size_;
+  // 4 bits per format argument
+  std::uint16_t arg_types_;
+  Storage storage_;
 };
 
 }  // namespace common
@@ -0,0 +1,160 @@
+#include "common/error_context.h"
+
+#include <cstring>
+#include <new>
+
+#include "common/buffer_writer.h"
+
+namespace common {
+
+namespace {
+
+constexpr std::size_t kBlockHeaderSize =
+    (sizeof(void*) + sizeof(std::size_t) + alignof(std::max_align_t) - 1u) &
+    ~(alignof(std::max_align_t) - 1u);
+
+char* AlignUp(char* pointer, std::size_t alignment) {
+  const std::uintptr_t value = reinterpret_cast<std::uintptr_t>(pointer);
+  return reinterpret_cast<char*>((value + alignment - 1u) & ~(alignment - 1u));
+}
+
+ErrorFrame* NewFrame(const char* message, const char* file, int line,
+                     const ErrorFrame* next) {
+  ErrorFrame* frame = static_cast<ErrorFrame*>(
+      ErrorArena::ThreadLocal().Allocate(sizeof(ErrorFrame),
+                                         alignof(ErrorFrame)));
+  frame->message = message;
+  frame->file = file;
+  frame->line = line;
+  frame->key = nullptr;
+  frame->value = std::string_view();
+  frame->next = next;
+  return frame;
+}
+
+}  // namespace
+
+ErrorArena::~ErrorArena() {
+  while (head_ != nullptr) {
+    Block* next = head_->next;
+    ::operator delete(head_);
+    head_ = next;
+  }
+}
+
+ErrorArena& ErrorArena::ThreadLocal() {
+  thread_local ErrorArena arena;
+  return arena;
+}
+
+void* ErrorArena::Allocate(std::size_t size, std::size_t alignment) {
+  char* start = AlignUp(current_, alignment);
+  if (current_ == nullptr || start + size > end_) {
+    return AllocateSlow(size, alignment);
+  }
+  bytes_used_ += size;
+  current_ = start + size;
+  return start;
+}
+
+std::string_view ErrorArena::CopyString(std::string_view text) {
+  if (text.empty()) {
+    return std::string_view();
+  }
+  char* copy = static_cast<char*>(Allocate(text.size(), 1u));
+  std::memcpy(copy, text.data(), text.size());
+  return std::string_view(copy, text.size());
+}
+
+void ErrorArena::Reset() {
+  // keep one regular block around so steady state allocation never calls new
+  Block* keep = nullptr;
+  while (head_ != nullptr) {
+    Block* next = head_->next;
+    if (keep == nullptr && head_->size == kBlockSize) {
+      keep = head_;
+    } else {
+      ::operator delete(head_);
+    }
+    head_ = next;
+  }
+  head_ = keep;
+  if (keep != nullptr) {
+    keep->next = nullptr;
+    current_ = reinterpret_cast<char*>(keep) + kBlockHeaderSize;
+    end_ = reinterpret_cast<char*>(keep) + keep->size;
+  } else {
+    current_ = end_ = nullptr;
+  }
+  bytes_used_ = 0u;
+}
+
+void* ErrorArena::AllocateSlow(std::size_t size, std::size_t alignment) {
+  std::size_t block_size = kBlockHeaderSize + size + alignment;
+  if (block_size < kBlockSize) {
+    block_size = kBlockSize;
+  }
+  Block* block = static_cast<Block*>(::operator new(block_size));
+  block->next = head_;
+  block->size = block_size;
+  head_ = block;
+  current_ = reinterpret_cast<char*>(block) + kBlockHeaderSize;
+  end_ = reinterpret_cast<char*>(block) + block_size;
+  return Allocate(size, alignment);
+}
+
+ChainedError ChainedError::WithContext(const char* message, const char* file,
+                                       int line) const {
+  return ChainedError(error_code_, NewFrame(message, file, line, frames_));
+}
+
+ChainedError ChainedError::WithContext(const char* message, const char* file,
+                                       int line, const char* key,
+                                       std::string_view value) const {
+  ErrorFrame* frame = NewFrame(message, file, line, frames_);
+  frame->key = key;
+  frame->value = ErrorArena::ThreadLocal().CopyString(value);
+  return ChainedError(error_code_, frame);
+}
+
+ChainedError ChainedError::WithContext(const char* message, const char* file,
+                                       int line, const char* key,
+                                       std::int64_t value) const {
+  char digits[24];
+  internal::BufferWriter writer(digits, sizeof(digits));
+  writer.AppendNumber(value);
+  return WithContext(message, file, line, key,
+                     std::string_view(digits, writer.Finish()));
+}
+
+std::string ChainedError::Explain() const {
+  std::string explanation(Explain(nullptr, 0u), '\0');
+  // std::string always keeps room for the terminator
+  Explain(&explanation[0], explanation.size() + 1u);
+  return explanation;
+}
+
+std::size_t ChainedError::Explain(char* buffer, std::size_t size) const {
+  internal::BufferWriter writer(buffer, size);
+  writer.Append(ErrorString(error_code_));
+  for (const ErrorFrame* frame = frames_; frame != nullptr;
+       frame = frame->next) {
+    writer.Append(frame == frames_ ? ": " : "; ");
+    writer.Append(frame->message);
+    if (frame->key != nullptr) {
+      writer.Append(" [", 2u);
+      writer.Append(frame->key);
+      writer.Append("=", 1u);
+      writer.Append(frame->value.data(), frame->value.size());
+      writer.Append("]", 1u);
+    }
+    writer.Append(" (", 2u);
+    writer.Append(frame->file);
+    writer.Append(":", 1u);
+    writer.AppendNumber(frame->line);
+    writer.Append(")", 1u);
+  }
+  return writer.Finish();
+}
+
+}  // namespace common
@@ -0,0 +1,131 @@
+#ifndef COMMON_ERROR_CONTEXT_H_
+#define COMMON_ERROR_CONTEXT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "common/error.h"
+
+namespace common {
+
+/// @class ErrorArena
+/// Thread-local bump allocator backing ErrorFrame chains. Memory is handed
+/// out from chained blocks and only given back by Reset(), which is meant to
+/// be called once per request, typically through ErrorArenaScope.
+class ErrorArena {
+ public:
+  constexpr static std::size_t kBlockSize = 4096u;
+
+  ErrorArena() = default;
+  ~ErrorArena();
+
+  ErrorArena(const ErrorArena&) = delete;
+  ErrorArena& operator=(const ErrorArena&) = delete;
+
+  /// @return  the arena of the calling thread
+  static ErrorArena& ThreadLocal();
+
+  /// @return  @p size bytes aligned to @p alignment, valid until Reset()
+  void* Allocate(std::size_t size, std::size_t alignment);
+
+  /// Copies @p text into the arena
+  std::string_view CopyString(std::string_view text);
+
+  /// Releases every allocation. The first block is kept for reuse.
+  void Reset();
+
+  /// @return  bytes handed out since the last Reset()
+  std::size_t BytesUsed() const { return bytes_used_; }
+
+ private:
+  struct Block {
+    Block* next;
+    std::size_t size;
+  };
+
+  void* AllocateSlow(std::size_t size, std::size_t alignment);
+
+  Block* head_ = nullptr;
+  char* current_ = nullptr;
+  char* end_ = nullptr;
+  std::size_t bytes_used_ = 0u;
+};
+
+/// @class ErrorArenaScope
+/// Resets the calling thread's ErrorArena when leaving the scope, e.g. at the
+/// end of a request. No ChainedError created inside the scope may outlive it.
+class ErrorArenaScope {
+ public:
+  ErrorArenaScope() = default;
+  ~ErrorArenaScope() { ErrorArena::ThreadLocal().Reset(); }
+
+  ErrorArenaScope(const ErrorArenaScope&) = delete;
+  ErrorArenaScope& operator=(const ErrorArenaScope&) = delete;
+};
+
+/// One layer of context attached to an error as it propagates
+struct ErrorFrame {
+  const char* message;
+  const char* file;
+  int line;
+  // optional key / value pair, key is nullptr when absent
+  const char* key;
+  std::string_view value;
+  // next inner frame, nullptr for the frame closest to the error origin
+  const ErrorFrame* next;
+};
+
+/// @class ChainedError
+/// Error code plus a linked list of context frames, outermost first. The
+/// frames live in the thread-local ErrorArena, so adding context costs a
+/// pointer bump and copying a ChainedError copies two words. A ChainedError
+/// must not outlive the ErrorArenaScope it was created in.
+class ChainedError {
+ public:
+  ChainedError(Error error_code) : error_code_(error_code), frames_(nullptr) {}
+
+  Error error_code() const { return error_code_; }
+
+  /// @return  outermost frame, nullptr when no context was added
+  const ErrorFrame* frames() const { return frames_; }
+
+  /// @return  a copy of this error with one more, outermost, frame.
+  /// @p message and @p file must be string literals.
+  ChainedError WithContext(const char* message, const char* file,
+                           int line) const;
+
+  /// As above, with a key / value pair. @p value is copied into the arena.
+  ChainedError WithContext(const char* message, const char* file, int line,
+                           const char* key, std::string_view value) const;
+  ChainedError WithContext(const char* message, const char* file, int line,
+                           const char* key, std::int64_t value) const;
+
+  /// @return  "<ErrorString>: <message> [key=value] (file:line); ..." with
+  /// frames listed outermost first
+  std::string Explain() const;
+
+  /// Writes the explanation into @p buffer with snprintf style truncation
+  /// @return  length of the complete explanation, excluding the terminator
+  std::size_t Explain(char* buffer, std::size_t size) const;
+
+ private:
+  ChainedError(Error error_code, const ErrorFrame* frames)
+      : error_code_(error_code), frames_(frames) {}
+
+  Error error_code_;
+  const ErrorFrame* frames_;
+};
+
+}  // namespace common
+
+/// Adds a context frame carrying the current file and line to a ChainedError
+#define COMMON_ERROR_CONTEXT(error, message) \
+  (error).WithContext((message), __FILE__, __LINE__)
+
+/// As COMMON_ERROR_CONTEXT, with a key / value pair
+#define COMMON_ERROR_CONTEXT_KV(error, message, key, value) \
+  (error).WithContext((message), __FILE__, __LINE__, (key), (value))
+
+#endif  // COMMON_ERROR_CONTEXT_H_
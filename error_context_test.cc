@@ -0,0 +1,89 @@
+#include "common/error_context.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "common/error_or.h"
+
+namespace common {
+
+namespace {
+
+ExplainedErrorOr<int, ChainedError> OpenFile(bool fail) {
+  if (fail) {
+    return COMMON_ERROR_CONTEXT_KV(ChainedError(Error::kNotFound),
+                                   "opening file", "path", "/etc/app.conf");
+  }
+  return 3;
+}
+
+ExplainedErrorOr<int, ChainedError> LoadConfig(bool fail) {
+  ExplainedErrorOr<int, ChainedError> file = OpenFile(fail);
+  if (file.HasError()) {
+    return COMMON_ERROR_CONTEXT(file.ErrorOrDie(), "loading config");
+  }
+  return file.ValueOrDie() + 1;
+}
+
+}  // namespace
+
+TEST(ChainedErrorTest, NoContextTest) {
+  ErrorArenaScope scope;
+  ChainedError error(Error::kUnavailable);
+  EXPECT_EQ(error.frames(), nullptr);
+  EXPECT_EQ(error.Explain(), "Unavailable");
+}
+
+TEST(ChainedErrorTest, ContextChainTest) {
+  ErrorArenaScope scope;
+  ExplainedErrorOr<int, ChainedError> success = LoadConfig(false);
+  ASSERT_TRUE(success.HasValue());
+  EXPECT_EQ(success.ValueOrDie(), 4);
+  EXPECT_EQ(ErrorArena::ThreadLocal().BytesUsed(), 0u);
+
+  ExplainedErrorOr<int, ChainedError> failure = LoadConfig(true);
+  ASSERT_TRUE(failure.HasError());
+  const ChainedError& error = failure.ErrorOrDie();
+  EXPECT_EQ(error.error_code(), Error::kNotFound);
+  ASSERT_NE(error.frames(), nullptr);
+  EXPECT_STREQ(error.frames()->message, "loading config");
+  ASSERT_NE(error.frames()->next, nullptr);
+  EXPECT_STREQ(error.frames()->next->key, "path");
+  EXPECT_EQ(error.frames()->next->value, "/etc/app.conf");
+  EXPECT_EQ(error.frames()->next->next, nullptr);
+
+  const std::string explanation = error.Explain();
+  EXPECT_EQ(explanation.find("Not found: loading config ("), 0u);
+  EXPECT_NE(explanation.find("; opening file [path=/etc/app.conf] ("),
+            std::string::npos);
+
+  char buffer[10];
+  EXPECT_EQ(error.Explain(buffer, sizeof(buffer)), explanation.size());
+  EXPECT_STREQ(buffer, "Not found");
+}
+
+TEST(ChainedErrorTest, IntegerValueTest) {
+  ErrorArenaScope scope;
+  ChainedError error = ChainedError(Error::kOutOfRange)
+                           .WithContext("reading row", "table.cc", 12, "row",
+                                        std::int64_t{-42});
+  EXPECT_EQ(error.Explain(),
+            "Out of range: reading row [row=-42] (table.cc:12)");
+}
+
+TEST(ErrorArenaTest, ResetTest) {
+  ErrorArena arena;
+  void* small = arena.Allocate(16u, 8u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(small) % 8u, 0u);
+  void* large = arena.Allocate(3u * ErrorArena::kBlockSize, 64u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % 64u, 0u);
+  EXPECT_EQ(arena.BytesUsed(), 16u + 3u * ErrorArena::kBlockSize);
+
+  arena.Reset();
+  EXPECT_EQ(arena.BytesUsed(), 0u);
+  EXPECT_EQ(arena.CopyString("abc"), "abc");
+  EXPECT_EQ(arena.BytesUsed(), 3u);
+}
+
+}  // namespace common
@@ -0,0 +1,255 @@
+#include "common/error_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace common {
+
+namespace {
+
+constexpr std::size_t kNumErrorCodes = EnumTrait<Error>::num_values();
+constexpr std::size_t kNumEvents =
+    static_cast<std::size_t>(ErrorEvent::kErrorOrFailure) + 1u;
+// the extra, last, site collects unknown sites and table overflow
+constexpr std::size_t kUnknownSite = ErrorMetrics::kMaxSites;
+constexpr std::size_t kNumCounters =
+    (ErrorMetrics::kMaxSites + 1u) * kNumEvents * kNumErrorCodes;
+
+struct SiteSlot {
+  // 0 while free, claimed with a CAS
+  std::atomic<std::uint64_t> key;
+  std::atomic<const char*> file;
+  std::atomic<int> line;
+  // set once file and line are written
+  std::atomic<bool> ready;
+};
+
+SiteSlot g_sites[ErrorMetrics::kMaxSites];
+
+// Counters of one thread. Only the owning thread writes, so increments are a
+// relaxed load and store rather than a locked read-modify-write.
+struct alignas(64) CounterBlock {
+  std::atomic<std::uint64_t> counts[kNumCounters];
+  std::atomic<bool> in_use;
+  CounterBlock* next;
+};
+
+// blocks are never freed, a block released by an exiting thread is reused
+std::atomic<CounterBlock*> g_blocks{nullptr};
+
+CounterBlock* AcquireBlock() {
+  for (CounterBlock* block = g_blocks.load(std::memory_order_acquire);
+       block != nullptr; block = block->next) {
+    bool expected = false;
+    if (block->in_use.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire)) {
+      return block;
+    }
+  }
+  CounterBlock* block = new CounterBlock();
+  block->in_use.store(true, std::memory_order_relaxed);
+  block->next = g_blocks.load(std::memory_order_relaxed);
+  while (!g_blocks.compare_exchange_weak(block->next, block,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+  return block;
+}
+
+class ThreadCounters {
+ public:
+  ~ThreadCounters() {
+    if (block_ != nullptr) {
+      block_->in_use.store(false, std::memory_order_release);
+    }
+  }
+
+  CounterBlock* block() {
+    if (block_ == nullptr) {
+      block_ = AcquireBlock();
+    }
+    return block_;
+  }
+
+ private:
+  CounterBlock* block_ = nullptr;
+};
+
+thread_local ThreadCounters t_counters;
+
+std::uint64_t SiteKey(const ErrorSite& site) {
+  std::uint64_t key = reinterpret_cast<std::uintptr_t>(site.file);
+  key ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(site.line))
+         << 40;
+  key *= 0x9E3779B97F4A7C15ull;
+  return key == 0u ? 1u : key;
+}
+
+// Open addressing over g_sites, lock-free
+std::size_t SiteIndex(const ErrorSite& site) {
+  if (site.file == nullptr) {
+    return kUnknownSite;
+  }
+  const std::uint64_t key = SiteKey(site);
+  const std::size_t start = (key >> 32) % ErrorMetrics::kMaxSites;
+  for (std::size_t probe = 0; probe < ErrorMetrics::kMaxSites; ++probe) {
+    const std::size_t index = (start + probe) % ErrorMetrics::kMaxSites;
+    SiteSlot& slot = g_sites[index];
+    std::uint64_t current = slot.key.load(std::memory_order_acquire);
+    if (current == 0u &&
+        slot.key.compare_exchange_strong(current, key,
+                                         std::memory_order_acq_rel)) {
+      slot.file.store(site.file, std::memory_order_relaxed);
+      slot.line.store(site.line, std::memory_order_relaxed);
+      slot.ready.store(true, std::memory_order_release);
+      return index;
+    }
+    if (current == key) {
+      // different sites may share a key, the slot decides. The thread that
+      // claimed the slot publishes its site right after the key.
+      while (!slot.ready.load(std::memory_order_acquire)) {
+      }
+      if (slot.file.load(std::memory_order_relaxed) == site.file &&
+          slot.line.load(std::memory_order_relaxed) == site.line) {
+        return index;
+      }
+    }
+  }
+  return kUnknownSite;
+}
+
+std::size_t CounterIndex(std::size_t site, std::size_t event,
+                         std::size_t error_code) {
+  return (site * kNumEvents + event) * kNumErrorCodes + error_code;
+}
+
+const char* EventName(ErrorEvent event) {
+  switch (event) {
+    case ErrorEvent::kError:
+      return "error";
+    case ErrorEvent::kErrorWithExplanation:
+      return "error_with_explanation";
+    case ErrorEvent::kErrorOrFailure:
+      return "error_or_failure";
+      // no default. Let -werror=switch catch missing enum cases
+  }
+  return "unknown";
+}
+
+bool SameSite(const ErrorMetrics::Entry& a, const ErrorMetrics::Entry& b) {
+  if (a.file == nullptr || b.file == nullptr) {
+    return a.file == b.file;
+  }
+  return a.line == b.line && std::strcmp(a.file, b.file) == 0;
+}
+
+bool EntryLess(const ErrorMetrics::Entry& a, const ErrorMetrics::Entry& b) {
+  // unknown sites sort last
+  if ((a.file == nullptr) != (b.file == nullptr)) {
+    return b.file == nullptr;
+  }
+  const int file_order =
+      a.file == nullptr ? 0 : std::strcmp(a.file, b.file);
+  if (file_order != 0) {
+    return file_order < 0;
+  }
+  if (a.line != b.line) {
+    return a.line < b.line;
+  }
+  if (a.event != b.event) {
+    return a.event < b.event;
+  }
+  return a.error_code < b.error_code;
+}
+
+}  // namespace
+
+#ifdef COMMON_ERROR_METRICS
+namespace internal {
+
+void RecordErrorEvent(ErrorEvent event, Error error_code,
+                      const ErrorSite& site) {
+  ErrorMetrics::Record(event, error_code, site);
+}
+
+}  // namespace internal
+#endif
+
+void ErrorMetrics::Record(ErrorEvent event, Error error_code,
+                          const ErrorSite& site) {
+  std::atomic<std::uint64_t>& counter =
+      t_counters.block()->counts[CounterIndex(
+          SiteIndex(site), static_cast<std::size_t>(event),
+          static_cast<std::size_t>(error_code))];
+  counter.store(counter.load(std::memory_order_relaxed) + 1u,
+                std::memory_order_relaxed);
+}
+
+std::vector<ErrorMetrics::Entry> ErrorMetrics::Snapshot() {
+  std::vector<Entry> entries;
+  for (std::size_t site = 0; site <= kMaxSites; ++site) {
+    Entry entry{nullptr, 0, ErrorEvent::kError, Error::kNotFound, 0u};
+    if (site != kUnknownSite) {
+      if (!g_sites[site].ready.load(std::memory_order_acquire)) {
+        continue;
+      }
+      entry.file = g_sites[site].file.load(std::memory_order_relaxed);
+      entry.line = g_sites[site].line.load(std::memory_order_relaxed);
+    }
+    for (std::size_t event = 0; event < kNumEvents; ++event) {
+      for (std::size_t code = 0; code < kNumErrorCodes; ++code) {
+        std::uint64_t count = 0u;
+        for (CounterBlock* block = g_blocks.load(std::memory_order_acquire);
+             block != nullptr; block = block->next) {
+          count += block->counts[CounterIndex(site, event, code)].load(
+              std::memory_order_relaxed);
+        }
+        if (count != 0u) {
+          entry.event = static_cast<ErrorEvent>(event);
+          entry.error_code = static_cast<Error>(code);
+          entry.count = count;
+          entries.push_back(entry);
+        }
+      }
+    }
+  }
+  // the same file may be seen through different string addresses, e.g. from
+  // inline functions in several translation units
+  std::sort(entries.begin(), entries.end(), EntryLess);
+  std::vector<Entry> merged;
+  for (const Entry& entry : entries) {
+    if (!merged.empty() && SameSite(merged.back(), entry) &&
+        merged.back().event == entry.event &&
+        merged.back().error_code == entry.error_code) {
+      merged.back().count += entry.count;
+    } else {
+      merged.push_back(entry);
+    }
+  }
+  return merged;
+}
+
+std::string ErrorMetrics::ExportText() {
+  std::string text;
+  for (const Entry& entry : Snapshot()) {
+    text += "error_events_total{event=\"";
+    text += EventName(entry.event);
+    text += "\",code=\"";
+    text += ErrorString(entry.error_code);
+    text += "\",site=\"";
+    if (entry.file == nullptr) {
+      text += "unknown";
+    } else {
+      text += entry.file;
+      text += ':';
+      text += std::to_string(entry.line);
+    }
+    text += "\"} ";
+    text += std::to_string(entry.count);
+    text += '\n';
+  }
+  return text;
+}
+
+}  // namespace common
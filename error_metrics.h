@@ -0,0 +1,67 @@
+#ifndef COMMON_ERROR_METRICS_H_
+#define COMMON_ERROR_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/error.h"
+#include "common/error_site.h"
+
+namespace common {
+
+/// @class ErrorMetrics
+/// Opt-in error counters. When built with COMMON_ERROR_METRICS defined
+/// (bazel build --define error_metrics=true) the following are counted per
+/// Error code and call site:
+///  - Errors wrapped in COMMON_ERROR()
+///  - ErrorWithExplanation constructions
+///  - ErrorOrTemplate constructions from a failure
+/// Success paths are untouched. Recording is lock-free: each thread bumps
+/// its own cache-line aligned counter block and Snapshot() sums the blocks.
+/// Without COMMON_ERROR_METRICS the hooks compile away entirely and only
+/// explicit Record() calls are counted.
+class ErrorMetrics {
+ public:
+  /// Call sites beyond this many are counted under an unknown site
+  constexpr static std::size_t kMaxSites = 256u;
+
+  struct Entry {
+    // nullptr when the call site is unknown
+    const char* file;
+    int line;
+    ErrorEvent event;
+    Error error_code;
+    std::uint64_t count;
+  };
+
+  /// @return  all non-zero counters, summed over threads, ordered by file,
+  /// line, event and error code
+  static std::vector<Entry> Snapshot();
+
+  /// @return  one line per Snapshot() entry in the form
+  /// error_events_total{event="...",code="...",site="file:line"} count
+  static std::string ExportText();
+
+  /// Records an event directly. Mostly useful for tests and for error types
+  /// other than the ones listed above.
+  static void Record(ErrorEvent event, Error error_code,
+                     const ErrorSite& site);
+};
+
+}  // namespace common
+
+#ifdef COMMON_ERROR_METRICS
+/// Counts the creation of a plain Error at the current call site and
+/// evaluates to the error code, e.g. return COMMON_ERROR(Error::kNotFound);
+#define COMMON_ERROR(error_code)                                          \
+  ([](::common::Error code, ::common::ErrorSite site) {                  \
+    ::common::ErrorMetrics::Record(::common::ErrorEvent::kError, code, site); \
+    return code;                                                          \
+  }((error_code), ::common::ErrorSite::Current()))
+#else
+#define COMMON_ERROR(error_code) (error_code)
+#endif
+
+#endif  // COMMON_ERROR_METRICS_H_
@@ -0,0 +1,155 @@
+#include "common/error_metrics.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "common/error_or.h"
+
+namespace common {
+
+namespace {
+
+std::uint64_t CountFor(const char* file, int line, ErrorEvent event,
+                       Error error_code) {
+  std::uint64_t count = 0u;
+  for (const ErrorMetrics::Entry& entry : ErrorMetrics::Snapshot()) {
+    if (entry.file != nullptr && std::strcmp(entry.file, file) == 0 &&
+        entry.line == line && entry.event == event &&
+        entry.error_code == error_code) {
+      count += entry.count;
+    }
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(ErrorMetricsTest, RecordSnapshotTest) {
+  const ErrorSite site{"record_snapshot_test.cc", 10};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&site] {
+      for (int j = 0; j < 1000; ++j) {
+        ErrorMetrics::Record(ErrorEvent::kError, Error::kUnavailable, site);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ErrorMetrics::Record(ErrorEvent::kErrorOrFailure, Error::kNotFound, site);
+
+  EXPECT_EQ(CountFor(site.file, site.line, ErrorEvent::kError,
+                     Error::kUnavailable),
+            4000u);
+  EXPECT_EQ(CountFor(site.file, site.line, ErrorEvent::kErrorOrFailure,
+                     Error::kNotFound),
+            1u);
+  EXPECT_EQ(CountFor(site.file, site.line, ErrorEvent::kError,
+                     Error::kNotFound),
+            0u);
+}
+
+TEST(ErrorMetricsTest, DuplicateFileAddressTest) {
+  // the same file name reached through two different addresses
+  // sites are kept for the lifetime of the process
+  static char first[] = "duplicate_test.cc";
+  static char second[] = "duplicate_test.cc";
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{first, 3});
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{second, 3});
+  EXPECT_EQ(CountFor("duplicate_test.cc", 3, ErrorEvent::kError,
+                     Error::kInternal),
+            2u);
+}
+
+TEST(ErrorMetricsTest, SiteCollisionTest) {
+  // file names 2^40 bytes apart on lines 2 and 3 mix to the same site key
+  constexpr std::uintptr_t kApart = std::uintptr_t{1} << 40;
+  void* first = mmap(nullptr, 4096u, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  ASSERT_NE(first, MAP_FAILED);
+  void* second = mmap(
+      reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(first) ^ kApart),
+      4096u, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if (second == MAP_FAILED ||
+      reinterpret_cast<std::uintptr_t>(second) !=
+          (reinterpret_cast<std::uintptr_t>(first) ^ kApart)) {
+    GTEST_SKIP() << "address space not available";
+  }
+  // the pages stay mapped, sites are kept for the lifetime of the process
+  std::strcpy(static_cast<char*>(first), "collision_a.cc");
+  std::strcpy(static_cast<char*>(second), "collision_b.cc");
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{static_cast<char*>(first), 2});
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{static_cast<char*>(second), 3});
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{static_cast<char*>(second), 3});
+  EXPECT_EQ(CountFor("collision_a.cc", 2, ErrorEvent::kError,
+                     Error::kInternal),
+            1u);
+  EXPECT_EQ(CountFor("collision_b.cc", 3, ErrorEvent::kError,
+                     Error::kInternal),
+            2u);
+}
+
+TEST(ErrorMetricsTest, ExportTextTest) {
+  ErrorMetrics::Record(ErrorEvent::kErrorWithExplanation,
+                       Error::kOutOfRange, ErrorSite{"export_test.cc", 42});
+  ErrorMetrics::Record(ErrorEvent::kError, Error::kInternal,
+                       ErrorSite{nullptr, 0});
+  const std::string text = ErrorMetrics::ExportText();
+  EXPECT_NE(text.find("error_events_total{event=\"error_with_explanation\","
+                      "code=\"Out of range\",site=\"export_test.cc:42\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("error_events_total{event=\"error\",code=\"Internal\","
+                      "site=\"unknown\"}"),
+            std::string::npos);
+}
+
+#ifdef COMMON_ERROR_METRICS
+TEST(ErrorMetricsTest, HooksTest) {
+  const int error_line = __LINE__ + 1;
+  Error error = COMMON_ERROR(Error::kInvalidArgument);
+  EXPECT_EQ(error, Error::kInvalidArgument);
+  EXPECT_EQ(CountFor(__FILE__, error_line, ErrorEvent::kError,
+                     Error::kInvalidArgument),
+            1u);
+
+  const int explained_line = __LINE__ + 1;
+  ErrorWithExplanation explained(Error::kUnavailable, "backend down");
+  EXPECT_EQ(CountFor(__FILE__, explained_line,
+                     ErrorEvent::kErrorWithExplanation, Error::kUnavailable),
+            1u);
+
+  const int failure_line = __LINE__ + 1;
+  ErrorOr<int> failure(Error::kNotFound);
+  ErrorOr<int> success(3);
+  EXPECT_EQ(CountFor(__FILE__, failure_line, ErrorEvent::kErrorOrFailure,
+                     Error::kNotFound),
+            1u);
+
+  const int in_place_line = __LINE__ + 1;
+  ErrorOr<int> in_place(InPlaceError(), Error::kOutOfRange);
+  const int emplace_line = __LINE__ + 1;
+  success.Emplace(InPlaceError(), Error::kOutOfRange);
+  EXPECT_EQ(CountFor(__FILE__, in_place_line, ErrorEvent::kErrorOrFailure,
+                     Error::kOutOfRange),
+            1u);
+  EXPECT_EQ(CountFor(__FILE__, emplace_line, ErrorEvent::kErrorOrFailure,
+                     Error::kOutOfRange),
+            1u);
+}
+#endif
+
+}  // namespace common
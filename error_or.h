@@ -2,6 +2,7 @@
 #define COMMON_ERROR_OR_H_
 
 #include <cstdlib>
+#include <type_traits>
 #include <utility>
 
 #include "common/error.h"
@@ -9,24 +10,88 @@
 
 namespace common {
 
+#ifdef COMMON_ERROR_METRICS
+namespace internal {
+
+template <typename E, typename = void>
+struct HasErrorCode : std::false_type {};
+
+template <typename E>
+struct HasErrorCode<E, decltype(std::declval<const E&>().error_code(), void())>
+    : std::true_type {};
+
+// error types without an Error code are not counted
+template <typename E>
+void RecordErrorOrFailure(const E& failure, const ErrorSite& site) {
+  if constexpr (std::is_same<E, Error>::value) {
+    RecordErrorEvent(ErrorEvent::kErrorOrFailure, failure, site);
+  } else if constexpr (HasErrorCode<E>::value) {
+    RecordErrorEvent(ErrorEvent::kErrorOrFailure, failure.error_code(), site);
+  }
+}
+
+}  // namespace internal
+#endif
+
+/// Selects the ErrorOrTemplate constructor and Emplace() that build the value
+/// in place from their arguments
+struct InPlaceValue {};
+
+/// Selects the ErrorOrTemplate constructor and Emplace() that build the error
+/// in place. Constructed at the call site, it records where the error was
+/// created.
+struct InPlaceError {
+#ifdef COMMON_ERROR_METRICS
+  InPlaceError(ErrorSite site = ErrorSite::Current()) : site(site) {}
+
+  ErrorSite site;
+#endif
+};
+
 template <typename T, typename E>
 class ErrorOrTemplate {
  public:
+  /// Builds the value from @p args, with no intermediate T, e.g.
+  ///   ErrorOr<Matrix> result(InPlaceValue(), rows, columns);
+  template <typename... Args>
+  explicit ErrorOrTemplate(InPlaceValue, Args&&... args)
+      : case_(kSuccess), success_(std::forward<Args>(args)...) {}
+
+  /// Builds the error from @p args, with no intermediate E
+  template <typename... Args>
+  explicit ErrorOrTemplate([[maybe_unused]] InPlaceError tag, Args&&... args)
+      : case_(kFailure), failure_(std::forward<Args>(args)...) {
+#ifdef COMMON_ERROR_METRICS
+    internal::RecordErrorOrFailure(failure_, tag.site);
+#endif
+  }
+
   ErrorOrTemplate(const T& success) : case_(kSuccess), success_(success) {}
   ErrorOrTemplate(T&& success)
       : case_(kSuccess), success_(std::move(success)) {}
 
+#ifdef COMMON_ERROR_METRICS
+  ErrorOrTemplate(const E& failure, ErrorSite site = ErrorSite::Current())
+      : case_(kFailure), failure_(failure) {
+    internal::RecordErrorOrFailure(failure_, site);
+  }
+  ErrorOrTemplate(E&& failure, ErrorSite site = ErrorSite::Current())
+      : case_(kFailure), failure_(std::move(failure)) {
+    internal::RecordErrorOrFailure(failure_, site);
+  }
+#else
   ErrorOrTemplate(const E& failure) : case_(kFailure), failure_(failure) {}
   ErrorOrTemplate(E&& failure)
       : case_(kFailure), failure_(std::move(failure)) {}
+#endif
 
   ErrorOrTemplate(const ErrorOrTemplate& other) : case_(other.case_) {
     switch (case_) {
       case kFailure:
-        Construct<E>(&failure_, std::forward<const E&>(other.ErrorOrDie()));
+        Construct<E>(&failure_, other.ErrorOrDie());
         return;
       case kSuccess:
-        Construct<T>(&success_, std::forward<const T&>(other.ValueOrDie()));
+        Construct<T>(&success_, other.ValueOrDie());
         return;
         // no default. Let -werror=switch catch missing enum cases
     }
@@ -35,10 +100,10 @@ class ErrorOrTemplate {
   ErrorOrTemplate(ErrorOrTemplate&& other) : case_(other.case_) {
     switch (case_) {
       case kFailure:
-        Construct<E>(&failure_, std::forward<E&&>(other.MoveErrorOrDie()));
+        Construct<E>(&failure_, other.MoveErrorOrDie());
         return;
       case kSuccess:
-        Construct<T>(&success_, std::forward<T&&>(other.MoveValueOrDie()));
+        Construct<T>(&success_, other.MoveValueOrDie());
         return;
         // no default. Let -werror=switch catch missing enum cases
     }
@@ -55,14 +120,14 @@ class ErrorOrTemplate {
     switch (case_) {
       case kFailure:
         if (needs_construction) {
-          Construct<E>(&failure_, std::forward<const E&>(other.ErrorOrDie()));
+          Construct<E>(&failure_, other.ErrorOrDie());
         } else {
           failure_ = other.failure_;
         }
         break;
       case kSuccess:
         if (needs_construction) {
-          Construct<T>(&success_, std::forward<const T&>(other.ValueOrDie()));
+          Construct<T>(&success_, other.ValueOrDie());
         } else {
           success_ = other.success_;
         }
@@ -81,14 +146,14 @@ class ErrorOrTemplate {
     switch (case_) {
       case kFailure:
         if (needs_construction) {
-          Construct<E>(&failure_, std::forward<E&&>(other.MoveErrorOrDie()));
+          Construct<E>(&failure_, other.MoveErrorOrDie());
         } else {
           failure_ = other.MoveErrorOrDie();
         }
         break;
       case kSuccess:
         if (needs_construction) {
-          Construct<T>(&success_, std::forward<T&&>(other.MoveValueOrDie()));
+          Construct<T>(&success_, other.MoveValueOrDie());
         } else {
           success_ = other.MoveValueOrDie();
         }
@@ -98,6 +163,28 @@ class ErrorOrTemplate {
     return *this;
   }
 
+  /// Replaces the value or error with a value built from @p args, which must
+  /// not refer to the current value or error. If the constructor throws,
+  /// the value or error is left unchanged, see Replace() for the exception.
+  /// @return  the new value
+  template <typename... Args>
+  T& Emplace(InPlaceValue, Args&&... args) {
+    return *Replace<T>(&success_, kSuccess, std::forward<Args>(args)...);
+  }
+
+  /// Replaces the value or error with an error built from @p args, which must
+  /// not refer to the current value or error. If the constructor throws,
+  /// the value or error is left unchanged, see Replace() for the exception.
+  /// @return  the new error
+  template <typename... Args>
+  E& Emplace([[maybe_unused]] InPlaceError tag, Args&&... args) {
+    Replace<E>(&failure_, kFailure, std::forward<Args>(args)...);
+#ifdef COMMON_ERROR_METRICS
+    internal::RecordErrorOrFailure(failure_, tag.site);
+#endif
+    return failure_;
+  }
+
   bool HasError() const { return case_ == kFailure; }
 
   const E& ErrorOrDie() const {
@@ -131,6 +218,8 @@ class ErrorOrTemplate {
   }
 
  private:
+  enum Case { kFailure, kSuccess };
+
   void Destroy() {
     switch (case_) {
       case kFailure:
@@ -143,7 +232,32 @@ class ErrorOrTemplate {
     }
   }
 
-  enum { kFailure, kSuccess } case_;
+  // Destroys the value or error and builds a U from @p args at @p member.
+  // A constructor that may throw builds a temporary first, moved in once it
+  // exists, so that a throw leaves *this as it was. A U that can be neither
+  // built nor moved without throwing has nothing valid to fall back on, so
+  // its constructor throwing terminates instead.
+  template <typename U, typename... Args>
+  U* Replace(U* member, Case new_case, Args&&... args) {
+    if constexpr (std::is_nothrow_constructible<U, Args&&...>::value ||
+                  !std::is_nothrow_move_constructible<U>::value) {
+      Destroy();
+      case_ = new_case;
+      return ConstructOrTerminate<U>(member, std::forward<Args>(args)...);
+    } else {
+      U built(std::forward<Args>(args)...);
+      Destroy();
+      case_ = new_case;
+      return Construct<U>(member, std::move(built));
+    }
+  }
+
+  template <typename U, typename... Args>
+  static U* ConstructOrTerminate(U* member, Args&&... args) noexcept {
+    return Construct<U>(member, std::forward<Args>(args)...);
+  }
+
+  Case case_;
   union {
     E failure_;
     T success_;
@@ -153,8 +267,9 @@ class ErrorOrTemplate {
 template <typename T>
 using ErrorOr = ErrorOrTemplate<T, Error>;
 
-template <typename T>
-using ExplainedErrorOr = ErrorOrTemplate<T, ErrorWithExplanation>;
+/// Error type can be swapped for a richer one, e.g. ChainedError
+template <typename T, typename E = ErrorWithExplanation>
+using ExplainedErrorOr = ErrorOrTemplate<T, E>;
 
 }  // namespace common
 
@@ -0,0 +1,200 @@
+#ifndef COMMON_ERROR_OR_BATCH_H_
+#define COMMON_ERROR_OR_BATCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/error.h"
+#include "common/error_or.h"
+
+namespace common {
+
+/// @class ErrorOrBatch
+/// Structure-of-arrays alternative to std::vector<ErrorOrTemplate<T, E>> for
+/// bulk operations. Successes live in a dense value array indexed by element
+/// position, a validity bitmask records which positions hold a value and
+/// failures are kept in a sparse, index-sorted list. Positions holding an
+/// error keep a value initialized T in the dense array so that the array can
+/// be scanned without branching on the discriminant.
+/// @tparam T  success type, must be default constructible
+/// @tparam E  failure type
+template <typename T, typename E>
+class ErrorOrBatch {
+ public:
+  static_assert(std::is_default_constructible<T>::value,
+                "T must be default constructible");
+
+  ErrorOrBatch() = default;
+
+  /// Reserves storage for @p size elements
+  void Reserve(std::size_t size) {
+    values_.reserve(size);
+    valid_.reserve(WordCount(size));
+  }
+
+  /// Appends a success
+  void PushBack(const T& success) { EmplaceValue(success); }
+  void PushBack(T&& success) { EmplaceValue(std::move(success)); }
+
+  /// Appends a failure
+  void PushBack(const E& failure) { EmplaceError(failure); }
+  void PushBack(E&& failure) { EmplaceError(std::move(failure)); }
+
+  /// Appends a single ErrorOrTemplate, copying its value or error
+  void PushBack(const ErrorOrTemplate<T, E>& element) {
+    if (element.HasValue()) {
+      EmplaceValue(element.ValueOrDie());
+    } else {
+      EmplaceError(element.ErrorOrDie());
+    }
+  }
+
+  /// Appends a single ErrorOrTemplate, moving its value or error
+  void PushBack(ErrorOrTemplate<T, E>&& element) {
+    if (element.HasValue()) {
+      EmplaceValue(element.MoveValueOrDie());
+    } else {
+      EmplaceError(element.MoveErrorOrDie());
+    }
+  }
+
+  void Clear() {
+    values_.clear();
+    valid_.clear();
+    errors_.clear();
+  }
+
+  std::size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+
+  /// @return  number of failures in the batch, O(1)
+  std::size_t ErrorCount() const { return errors_.size(); }
+
+  /// @return  number of successes in the batch, O(1)
+  std::size_t ValueCount() const { return values_.size() - errors_.size(); }
+
+  bool HasValue(std::size_t index) const {
+    return index < values_.size() &&
+           (valid_[index / kWordBits] >> (index % kWordBits)) & 1u;
+  }
+
+  bool HasError(std::size_t index) const {
+    return index < values_.size() && !HasValue(index);
+  }
+
+  const T& ValueOrDie(std::size_t index) const {
+    if (!HasValue(index)) {
+      std::exit(EXIT_FAILURE);
+    }
+    return values_[index];
+  }
+
+  const E& ErrorOrDie(std::size_t index) const {
+    if (!HasError(index)) {
+      std::exit(EXIT_FAILURE);
+    }
+    return FindError(index)->second;
+  }
+
+  /// @return  a copy of the element at @p index as a single ErrorOrTemplate
+  ErrorOrTemplate<T, E> At(std::size_t index) const {
+    if (HasValue(index)) {
+      return ErrorOrTemplate<T, E>(values_[index]);
+    }
+    return ErrorOrTemplate<T, E>(ErrorOrDie(index));
+  }
+
+  /// Dense value array of size() elements. Positions for which HasValue() is
+  /// false hold a value initialized T.
+  const T* values() const { return values_.data(); }
+
+  /// Validity bitmask, bit (i % 64) of word (i / 64) is set when element i
+  /// holds a value. Bits past size() are always zero.
+  const std::uint64_t* validity() const { return valid_.data(); }
+  std::size_t validity_words() const { return valid_.size(); }
+
+  /// Failures as (index, error) pairs sorted by index
+  const std::vector<std::pair<std::size_t, E>>& errors() const {
+    return errors_;
+  }
+
+  /// Calls @p fn(index, value) for every success in index order. Fully valid
+  /// words are visited with a straight loop over the dense array, other words
+  /// are walked one set bit at a time.
+  template <typename Fn>
+  void ForEachValue(Fn&& fn) const {
+    const std::size_t words = valid_.size();
+    for (std::size_t word = 0; word < words; ++word) {
+      std::uint64_t bits = valid_[word];
+      const std::size_t base = word * kWordBits;
+      if (bits == ~std::uint64_t{0}) {
+        for (std::size_t i = base; i < base + kWordBits; ++i) {
+          fn(i, values_[i]);
+        }
+        continue;
+      }
+      while (bits != 0u) {
+        const std::size_t i = base + __builtin_ctzll(bits);
+        fn(i, values_[i]);
+        bits &= bits - 1u;
+      }
+    }
+  }
+
+  /// Calls @p fn(index, error) for every failure in index order
+  template <typename Fn>
+  void ForEachError(Fn&& fn) const {
+    for (const auto& entry : errors_) {
+      fn(entry.first, entry.second);
+    }
+  }
+
+ private:
+  constexpr static std::size_t kWordBits = 64u;
+
+  static std::size_t WordCount(std::size_t size) {
+    return (size + kWordBits - 1u) / kWordBits;
+  }
+
+  void GrowMask() {
+    if (values_.size() % kWordBits == 0u) {
+      valid_.push_back(0u);
+    }
+  }
+
+  template <typename U>
+  void EmplaceValue(U&& success) {
+    GrowMask();
+    const std::size_t index = values_.size();
+    values_.emplace_back(std::forward<U>(success));
+    valid_[index / kWordBits] |= std::uint64_t{1} << (index % kWordBits);
+  }
+
+  template <typename U>
+  void EmplaceError(U&& failure) {
+    GrowMask();
+    errors_.emplace_back(values_.size(), std::forward<U>(failure));
+    values_.emplace_back();
+  }
+
+  typename std::vector<std::pair<std::size_t, E>>::const_iterator FindError(
+      std::size_t index) const {
+    return std::lower_bound(
+        errors_.begin(), errors_.end(), index,
+        [](const std::pair<std::size_t, E>& entry, std::size_t key) {
+          return entry.first < key;
+        });
+  }
+
+  std::vector<T> values_;
+  std::vector<std::uint64_t> valid_;
+  std::vector<std::pair<std::size_t, E>> errors_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_ERROR_OR_BATCH_H_
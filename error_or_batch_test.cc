@@ -0,0 +1,98 @@
+#include "common/error_or_batch.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+
+TEST(ErrorOrBatchTest, PushBackTest) {
+  ErrorOrBatch<int, Error> batch;
+  EXPECT_TRUE(batch.empty());
+  batch.PushBack(10);
+  batch.PushBack(Error::kNotFound);
+  batch.PushBack(30);
+
+  EXPECT_EQ(batch.size(), 3u);
+  EXPECT_EQ(batch.ValueCount(), 2u);
+  EXPECT_EQ(batch.ErrorCount(), 1u);
+  EXPECT_TRUE(batch.HasValue(0));
+  EXPECT_TRUE(batch.HasError(1));
+  EXPECT_TRUE(batch.HasValue(2));
+  EXPECT_FALSE(batch.HasValue(3));
+  EXPECT_FALSE(batch.HasError(3));
+  EXPECT_EQ(batch.ValueOrDie(0), 10);
+  EXPECT_EQ(batch.ErrorOrDie(1), Error::kNotFound);
+  EXPECT_EQ(batch.ValueOrDie(2), 30);
+  EXPECT_EXIT(batch.ValueOrDie(1), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "");
+  EXPECT_EXIT(batch.ErrorOrDie(0), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "");
+}
+
+TEST(ErrorOrBatchTest, ErrorOrConversionTest) {
+  ErrorOrBatch<int, Error> batch;
+  batch.PushBack(ErrorOr<int>(5));
+  batch.PushBack(ErrorOr<int>(Error::kOutOfRange));
+
+  ErrorOr<int> first = batch.At(0);
+  EXPECT_TRUE(first.HasValue());
+  EXPECT_EQ(first.ValueOrDie(), 5);
+
+  ErrorOr<int> second = batch.At(1);
+  EXPECT_TRUE(second.HasError());
+  EXPECT_EQ(second.ErrorOrDie(), Error::kOutOfRange);
+}
+
+TEST(ErrorOrBatchTest, ForEachTest) {
+  ErrorOrBatch<std::int64_t, Error> batch;
+  std::int64_t expected_sum = 0;
+  std::size_t expected_errors = 0;
+  for (std::int64_t i = 0; i < 300; ++i) {
+    if (i % 7 == 3 || (i >= 128 && i < 192 && i % 2 == 0)) {
+      batch.PushBack(Error::kInvalidArgument);
+      ++expected_errors;
+    } else {
+      batch.PushBack(i);
+      expected_sum += i;
+    }
+  }
+  EXPECT_EQ(batch.ErrorCount(), expected_errors);
+  EXPECT_EQ(batch.validity_words(), 5u);
+
+  std::int64_t sum = 0;
+  std::vector<std::size_t> indices;
+  batch.ForEachValue([&](std::size_t index, std::int64_t value) {
+    EXPECT_EQ(static_cast<std::int64_t>(index), value);
+    indices.push_back(index);
+    sum += value;
+  });
+  EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+  EXPECT_EQ(indices.size(), batch.ValueCount());
+  EXPECT_EQ(sum, expected_sum);
+
+  std::size_t errors = 0;
+  batch.ForEachError([&](std::size_t index, Error error) {
+    EXPECT_TRUE(batch.HasError(index));
+    EXPECT_EQ(error, Error::kInvalidArgument);
+    ++errors;
+  });
+  EXPECT_EQ(errors, expected_errors);
+}
+
+TEST(ErrorOrBatchTest, ExplainedErrorTest) {
+  ErrorOrBatch<std::vector<int>, ErrorWithExplanation> batch;
+  batch.PushBack(std::vector<int>{1, 2, 3});
+  batch.PushBack(ErrorWithExplanation(Error::kInternal, "bad record"));
+  EXPECT_EQ(batch.ValueOrDie(0).size(), 3u);
+  EXPECT_EQ(batch.ErrorOrDie(1).Explain(), "Internal: bad record");
+  EXPECT_TRUE(batch.values()[1].empty());
+
+  batch.Clear();
+  EXPECT_TRUE(batch.empty());
+  EXPECT_EQ(batch.ErrorCount(), 0u);
+}
+
+}  // namespace common
@@ -0,0 +1,56 @@
+#include <array>
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "common/error_or.h"
+
+namespace common {
+namespace {
+
+// Large enough that a move is a 4 KiB copy
+struct Heavy {
+  explicit Heavy(std::uint64_t seed) { words.fill(seed); }
+
+  std::array<std::uint64_t, 512> words;
+};
+
+void BM_ConstructFromTemporary(benchmark::State& state) {
+  std::uint64_t seed = 0u;
+  for (auto _ : state) {
+    ErrorOr<Heavy> result(Heavy(++seed));
+    benchmark::DoNotOptimize(result.ValueOrDie().words.data());
+  }
+}
+BENCHMARK(BM_ConstructFromTemporary);
+
+void BM_ConstructInPlace(benchmark::State& state) {
+  std::uint64_t seed = 0u;
+  for (auto _ : state) {
+    ErrorOr<Heavy> result(InPlaceValue(), ++seed);
+    benchmark::DoNotOptimize(result.ValueOrDie().words.data());
+  }
+}
+BENCHMARK(BM_ConstructInPlace);
+
+void BM_AssignTemporary(benchmark::State& state) {
+  ErrorOr<Heavy> result(Error::kNotFound);
+  std::uint64_t seed = 0u;
+  for (auto _ : state) {
+    result = ErrorOr<Heavy>(Heavy(++seed));
+    benchmark::DoNotOptimize(result.ValueOrDie().words.data());
+  }
+}
+BENCHMARK(BM_AssignTemporary);
+
+void BM_Emplace(benchmark::State& state) {
+  ErrorOr<Heavy> result(Error::kNotFound);
+  std::uint64_t seed = 0u;
+  for (auto _ : state) {
+    result.Emplace(InPlaceValue(), ++seed);
+    benchmark::DoNotOptimize(result.ValueOrDie().words.data());
+  }
+}
+BENCHMARK(BM_Emplace);
+
+}  // namespace
+}  // namespace common
@@ -1,6 +1,8 @@
 #include "common/error_or.h"
 
 #include <memory>
+#include <stdexcept>
+#include <string>
 
 #include "gtest/gtest.h"
 
@@ -20,6 +22,51 @@ struct NonCopyableStruct {
   int a = 2;
 };
 
+// Neither copyable nor movable, so only in-place construction compiles
+struct PinnedStruct {
+  PinnedStruct(int value, std::string name)
+      : value(value), name(std::move(name)) {}
+  PinnedStruct(const PinnedStruct&) = delete;
+  PinnedStruct& operator=(const PinnedStruct&) = delete;
+  int value;
+  std::string name;
+};
+
+struct PinnedError : PinnedStruct {
+  using PinnedStruct::PinnedStruct;
+};
+
+struct CountingStruct {
+  static int copies;
+  static int moves;
+
+  explicit CountingStruct(int value) : value(value) {}
+  CountingStruct(const CountingStruct& other) : value(other.value) {
+    ++copies;
+  }
+  CountingStruct(CountingStruct&& other) : value(other.value) { ++moves; }
+  int value;
+};
+
+int CountingStruct::copies = 0;
+int CountingStruct::moves = 0;
+
+// Movable, its constructor throws when asked to
+struct ThrowingStruct {
+  explicit ThrowingStruct(bool fail) {
+    if (fail) {
+      throw std::runtime_error("construction failed");
+    }
+  }
+  int value = 5;
+};
+
+struct PinnedThrowingStruct : ThrowingStruct {
+  using ThrowingStruct::ThrowingStruct;
+  PinnedThrowingStruct(const PinnedThrowingStruct&) = delete;
+  PinnedThrowingStruct& operator=(const PinnedThrowingStruct&) = delete;
+};
+
 }  // namespace
 
 TEST(ErrorOrTest, ConstructDestructTest) {
@@ -94,4 +141,70 @@ TEST(ErrorOrTest, MoveAssignmentTest) {
   EXPECT_EQ(value->a, 111);
 }
 
+TEST(ErrorOrTest, InPlaceTest) {
+  ErrorOrTemplate<PinnedStruct, PinnedError> value(InPlaceValue(), 7,
+                                                     "seven");
+  EXPECT_TRUE(value.HasValue());
+  EXPECT_EQ(value.ValueOrDie().value, 7);
+  EXPECT_EQ(value.ValueOrDie().name, "seven");
+
+  ErrorOrTemplate<PinnedStruct, PinnedError> error(InPlaceError(), 8,
+                                                     "eight");
+  EXPECT_TRUE(error.HasError());
+  EXPECT_EQ(error.ErrorOrDie().name, "eight");
+
+  // arguments are forwarded, not copied
+  CountingStruct::copies = 0;
+  CountingStruct::moves = 0;
+  ErrorOr<CountingStruct> counted(InPlaceValue(), 3);
+  EXPECT_EQ(counted.ValueOrDie().value, 3);
+  ErrorOr<std::unique_ptr<int>> pointer(InPlaceValue(),
+                                        std::make_unique<int>(4));
+  EXPECT_EQ(*pointer.ValueOrDie(), 4);
+  EXPECT_EQ(CountingStruct::copies, 0);
+  EXPECT_EQ(CountingStruct::moves, 0);
+}
+
+TEST(ErrorOrTest, EmplaceTest) {
+  ErrorOrTemplate<PinnedStruct, PinnedError> result(InPlaceError(), 1,
+                                                      "error");
+  PinnedStruct& value = result.Emplace(InPlaceValue(), 2, "value");
+  EXPECT_TRUE(result.HasValue());
+  EXPECT_EQ(&value, &result.ValueOrDie());
+  EXPECT_EQ(value.name, "value");
+
+  result.Emplace(InPlaceValue(), 3, "another value");
+  EXPECT_EQ(result.ValueOrDie().value, 3);
+
+  PinnedError& error = result.Emplace(InPlaceError(), 4, "error again");
+  EXPECT_TRUE(result.HasError());
+  EXPECT_EQ(error.value, 4);
+  EXPECT_EXIT(result.ValueOrDie(), ::testing::ExitedWithCode(EXIT_FAILURE),
+              "");
+
+  ErrorOr<std::string> text(Error::kNotFound);
+  text.Emplace(InPlaceValue(), 3u, 'x');
+  EXPECT_EQ(text.ValueOrDie(), "xxx");
+  EXPECT_EQ(text.Emplace(InPlaceError(), Error::kUnavailable),
+            Error::kUnavailable);
+}
+
+TEST(ErrorOrTest, EmplaceThrowTest) {
+  ErrorOrTemplate<ThrowingStruct, std::string> result(InPlaceError(), "kept");
+  EXPECT_THROW(result.Emplace(InPlaceValue(), true), std::runtime_error);
+  EXPECT_TRUE(result.HasError());
+  EXPECT_EQ(result.ErrorOrDie(), "kept");
+
+  EXPECT_EQ(result.Emplace(InPlaceValue(), false).value, 5);
+  EXPECT_THROW(result.Emplace(InPlaceValue(), true), std::runtime_error);
+  EXPECT_TRUE(result.HasValue());
+  EXPECT_EQ(result.ValueOrDie().value, 5);
+
+  // nothing to fall back on when the type cannot be moved
+  ErrorOrTemplate<PinnedThrowingStruct, std::string> pinned(InPlaceError(),
+                                                            "kept");
+  EXPECT_DEATH(pinned.Emplace(InPlaceValue(), true), "");
+  EXPECT_EQ(pinned.ErrorOrDie(), "kept");
+}
+
 }  // namespace common
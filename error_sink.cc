@@ -0,0 +1,264 @@
+#include "common/error_sink.h"
+
+#include <cstdio>
+#include <utility>
+
+#include "common/buffer_writer.h"
+#include "common/memory/placement_new.h"
+
+namespace common {
+
+namespace {
+
+std::atomic<std::uint64_t> g_next_sink_id{1u};
+std::atomic<ErrorSink*> g_installed_sink{nullptr};
+
+std::size_t RoundUpToPowerOfTwo(std::size_t value) {
+  std::size_t result = 2u;
+  while (result < value) {
+    result <<= 1u;
+  }
+  return result;
+}
+
+// Single writer counters, avoids a locked read-modify-write
+void Bump(std::atomic<std::uint64_t>& counter) {
+  counter.store(counter.load(std::memory_order_relaxed) + 1u,
+                std::memory_order_relaxed);
+}
+
+void WriteToStderr(std::string_view line) {
+  std::fwrite(line.data(), 1u, line.size(), stderr);
+  std::fputc('\n', stderr);
+}
+
+void ForwardToInstalledSink(const ErrorWithExplanation& error) {
+  ErrorSink* sink = g_installed_sink.load(std::memory_order_acquire);
+  if (sink != nullptr) {
+    sink->Record(error);
+  }
+}
+
+}  // namespace
+
+struct ErrorSink::Ring {
+  struct Slot {
+    std::int64_t timestamp_us;
+    // the explanation was cut to kInlineCapacity chars
+    bool truncated;
+    alignas(ErrorWithExplanation) unsigned char error[sizeof(
+        ErrorWithExplanation)];
+
+    ErrorWithExplanation* get() {
+      return reinterpret_cast<ErrorWithExplanation*>(error);
+    }
+  };
+
+  explicit Ring(std::size_t capacity)
+      : mask(capacity - 1u), slots(new Slot[capacity]) {}
+
+  ~Ring() {
+    for (std::uint64_t index = tail.load(std::memory_order_relaxed);
+         index != head.load(std::memory_order_relaxed); ++index) {
+      slots[index & mask].get()->~ErrorWithExplanation();
+    }
+  }
+
+  const std::size_t mask;
+  const std::unique_ptr<Slot[]> slots;
+
+  // producer side
+  alignas(64) std::atomic<std::uint64_t> head{0u};
+  std::uint64_t sample_count = 0u;
+  std::int64_t window_second = 0;
+  std::uint32_t window_count = 0u;
+  std::atomic<std::uint64_t> recorded{0u};
+  std::atomic<std::uint64_t> sampled_out{0u};
+  std::atomic<std::uint64_t> rate_limited{0u};
+  std::atomic<std::uint64_t> ring_full{0u};
+  // set when the producing thread exits
+  std::atomic<bool> abandoned{false};
+
+  // consumer side
+  alignas(64) std::atomic<std::uint64_t> tail{0u};
+};
+
+// Rings of the calling thread, one per sink it has recorded to
+struct ErrorSink::ThreadRings {
+  struct Entry {
+    std::uint64_t sink_id;
+    std::shared_ptr<Ring> ring;
+  };
+
+  ~ThreadRings() {
+    for (Entry& entry : entries) {
+      entry.ring->abandoned.store(true, std::memory_order_release);
+    }
+  }
+
+  std::vector<Entry> entries;
+};
+
+thread_local ErrorSink::ThreadRings ErrorSink::thread_rings_;
+
+ErrorSink::ErrorSink(Options options, Writer writer)
+    : options_(std::move(options)),
+      writer_(writer != nullptr ? std::move(writer) : Writer(WriteToStderr)),
+      id_(g_next_sink_id.fetch_add(1u, std::memory_order_relaxed)),
+      thread_(&ErrorSink::Run, this) {}
+
+ErrorSink::~ErrorSink() {
+  ErrorSink* self = this;
+  if (g_installed_sink.compare_exchange_strong(self, nullptr)) {
+    internal::SetErrorSinkHook(nullptr);
+  }
+  {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+  Flush();
+}
+
+bool ErrorSink::Record(const ErrorWithExplanation& error) {
+  Ring* ring = ThreadRing();
+  if (ring == nullptr) {
+    return false;
+  }
+  if (options_.sample_every > 1u &&
+      ring->sample_count++ % options_.sample_every != 0u) {
+    Bump(ring->sampled_out);
+    return false;
+  }
+  const std::int64_t now_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  if (options_.max_per_second != 0u) {
+    const std::int64_t second = now_us / 1000000;
+    if (second != ring->window_second) {
+      ring->window_second = second;
+      ring->window_count = 0u;
+    }
+    if (ring->window_count >= options_.max_per_second) {
+      Bump(ring->rate_limited);
+      return false;
+    }
+    ++ring->window_count;
+  }
+  const std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+  if (head - ring->tail.load(std::memory_order_acquire) > ring->mask) {
+    Bump(ring->ring_full);
+    return false;
+  }
+  Ring::Slot& slot = ring->slots[head & ring->mask];
+  slot.timestamp_us = now_us;
+  Construct<ErrorWithExplanation>(slot.error,
+                                  error.InlineCopy(&slot.truncated));
+  ring->head.store(head + 1u, std::memory_order_release);
+  Bump(ring->recorded);
+  return true;
+}
+
+void ErrorSink::Flush() {
+  std::lock_guard<std::mutex> lock(drain_mutex_);
+  DrainLocked();
+}
+
+ErrorSink::Stats ErrorSink::GetStats() const {
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  Stats stats = retired_;
+  for (const std::shared_ptr<Ring>& ring : rings_) {
+    stats.recorded += ring->recorded.load(std::memory_order_relaxed);
+    stats.sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+    stats.rate_limited += ring->rate_limited.load(std::memory_order_relaxed);
+    stats.ring_full += ring->ring_full.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void ErrorSink::Install(ErrorSink* sink) {
+  g_installed_sink.store(sink, std::memory_order_release);
+  internal::SetErrorSinkHook(sink != nullptr ? ForwardToInstalledSink
+                                             : nullptr);
+}
+
+ErrorSink::Ring* ErrorSink::ThreadRing() {
+  for (const ThreadRings::Entry& entry : thread_rings_.entries) {
+    if (entry.sink_id == id_) {
+      return entry.ring.get();
+    }
+  }
+  if (std::this_thread::get_id() == thread_.get_id()) {
+    // errors raised by the writer itself are not logged
+    return nullptr;
+  }
+  std::shared_ptr<Ring> ring = std::make_shared<Ring>(
+      RoundUpToPowerOfTwo(options_.ring_capacity));
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.push_back(ring);
+  }
+  thread_rings_.entries.push_back(ThreadRings::Entry{id_, ring});
+  return ring.get();
+}
+
+void ErrorSink::DrainLocked() {
+  std::vector<std::shared_ptr<Ring>> rings;
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings = rings_;
+  }
+  char line[kMaxLineSize];
+  for (const std::shared_ptr<Ring>& ring : rings) {
+    const bool abandoned = ring->abandoned.load(std::memory_order_acquire);
+    const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+    for (std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+         tail != head; ++tail) {
+      Ring::Slot& slot = ring->slots[tail & ring->mask];
+      internal::BufferWriter writer(line, sizeof(line));
+      writer.AppendNumber(slot.timestamp_us);
+      writer.Append(" ", 1u);
+      const std::size_t prefix = writer.Finish();
+      std::size_t explanation =
+          slot.get()->Explain(line + prefix, sizeof(line) - prefix);
+      if (slot.truncated && prefix + explanation < sizeof(line)) {
+        internal::BufferWriter marker(line + prefix + explanation,
+                                      sizeof(line) - prefix - explanation);
+        marker.Append(kTruncatedMarker);
+        explanation += marker.Finish();
+      }
+      const std::size_t size = prefix + explanation < sizeof(line)
+                                   ? prefix + explanation
+                                   : sizeof(line) - 1u;
+      writer_(std::string_view(line, size));
+      slot.get()->~ErrorWithExplanation();
+      ring->tail.store(tail + 1u, std::memory_order_release);
+    }
+    if (abandoned) {
+      std::lock_guard<std::mutex> lock(rings_mutex_);
+      retired_.recorded += ring->recorded.load(std::memory_order_relaxed);
+      retired_.sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+      retired_.rate_limited +=
+          ring->rate_limited.load(std::memory_order_relaxed);
+      retired_.ring_full += ring->ring_full.load(std::memory_order_relaxed);
+      for (auto it = rings_.begin(); it != rings_.end(); ++it) {
+        if (*it == ring) {
+          rings_.erase(it);
+          break;
+        }
+      }
+    }
+  }
+}
+
+void ErrorSink::Run() {
+  std::unique_lock<std::mutex> lock(drain_mutex_);
+  while (!stop_) {
+    wake_.wait_for(lock, options_.flush_interval, [this] { return stop_; });
+    DrainLocked();
+  }
+}
+
+}  // namespace common
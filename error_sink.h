@@ -0,0 +1,122 @@
+#ifndef COMMON_ERROR_SINK_H_
+#define COMMON_ERROR_SINK_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "common/error.h"
+
+namespace common {
+
+/// @class ErrorSink
+/// Asynchronous error log. Record() copies the error code and the raw,
+/// unformatted explanation into a single producer / single consumer ring
+/// buffer owned by the calling thread and returns; a background thread
+/// formats the records with Explain() and hands them to the writer.
+///
+/// Records are copied with ErrorWithExplanation::InlineCopy() so that
+/// Record() never allocates: runtime explanations longer than
+/// ErrorWithExplanation::kInlineCapacity chars are cut to that length and
+/// their line ends with kTruncatedMarker.
+///
+/// Record() is lock-free once the calling thread has registered its ring,
+/// which happens on its first call and takes a lock. Records are dropped,
+/// never waited for, when the ring is full, when they are sampled out or
+/// when the per-thread rate limit is hit.
+///
+/// With COMMON_ERROR_SINK defined (bazel build --define error_sink=true)
+/// every ErrorWithExplanation that is constructed is offered to the sink
+/// passed to Install(). Without it the hook is not compiled at all.
+class ErrorSink {
+ public:
+  struct Options {
+    // records per thread ring, rounded up to a power of two
+    std::size_t ring_capacity = 1024u;
+    // keep one in sample_every errors, 1 keeps all of them
+    std::uint32_t sample_every = 1u;
+    // per thread and second, 0 disables rate limiting
+    std::uint32_t max_per_second = 0u;
+    std::chrono::milliseconds flush_interval{100};
+  };
+
+  struct Stats {
+    std::uint64_t recorded;
+    std::uint64_t sampled_out;
+    std::uint64_t rate_limited;
+    std::uint64_t ring_full;
+  };
+
+  /// Receives one formatted line, without a trailing newline, from the
+  /// background thread
+  using Writer = std::function<void(std::string_view line)>;
+
+  /// Maximum length of a formatted line, longer ones are truncated
+  constexpr static std::size_t kMaxLineSize = 512u;
+
+  /// Appended to explanations cut by Record()
+  constexpr static const char* kTruncatedMarker = " [truncated]";
+
+  /// Starts the background thread. The default writer prints to stderr.
+  explicit ErrorSink(Options options, Writer writer = nullptr);
+
+  /// Flushes outstanding records and stops the background thread. The sink
+  /// must be uninstalled and no longer recorded to.
+  ~ErrorSink();
+
+  ErrorSink(const ErrorSink&) = delete;
+  ErrorSink& operator=(const ErrorSink&) = delete;
+
+  /// Queues @p error for asynchronous logging
+  /// @return  false if the error was dropped
+  bool Record(const ErrorWithExplanation& error);
+
+  /// Synchronously formats and writes everything queued so far
+  void Flush();
+
+  /// @return  counters summed over all threads
+  Stats GetStats() const;
+
+  /// Makes @p sink receive every ErrorWithExplanation when built with
+  /// COMMON_ERROR_SINK. nullptr uninstalls.
+  static void Install(ErrorSink* sink);
+
+ private:
+  struct Ring;
+  struct ThreadRings;
+
+  // nullptr when the calling thread may not record
+  Ring* ThreadRing();
+  void DrainLocked();
+  void Run();
+
+  const Options options_;
+  const Writer writer_;
+  // distinguishes sinks in thread-local ring caches, addresses get reused
+  const std::uint64_t id_;
+
+  static thread_local ThreadRings thread_rings_;
+
+  // guards rings_ and retired_, never held while calling the writer
+  mutable std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<Ring>> rings_;
+  // counters of rings whose thread has exited
+  Stats retired_ = {0u, 0u, 0u, 0u};
+
+  // serializes draining, guards stop_
+  std::mutex drain_mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_ERROR_SINK_H_
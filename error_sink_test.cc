@@ -0,0 +1,156 @@
+#include "common/error_sink.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+
+namespace {
+
+class CollectingWriter {
+ public:
+  ErrorSink::Writer writer() {
+    return [this](std::string_view line) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lines_.emplace_back(line);
+    };
+  }
+
+  std::vector<std::string> lines() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lines_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::string> lines_;
+};
+
+ErrorSink::Options SlowFlushOptions() {
+  ErrorSink::Options options;
+  options.flush_interval = std::chrono::hours(1);
+  return options;
+}
+
+bool EndsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+}  // namespace
+
+TEST(ErrorSinkTest, RecordFlushTest) {
+  CollectingWriter collector;
+  ErrorSink sink(SlowFlushOptions(), collector.writer());
+  EXPECT_TRUE(sink.Record(ErrorWithExplanation(Error::kUnavailable, "down")));
+  EXPECT_TRUE(sink.Record(
+      ErrorWithExplanation::Format(Error::kOutOfRange, "row {}", 7)));
+  EXPECT_TRUE(sink.Record(
+      ErrorWithExplanation(Error::kInternal, std::string(100, 'x'))));
+  const std::string fits(ErrorWithExplanation::kInlineCapacity, 'y');
+  EXPECT_TRUE(sink.Record(ErrorWithExplanation(Error::kInternal, fits)));
+  EXPECT_TRUE(collector.lines().empty());
+
+  sink.Flush();
+  const std::vector<std::string> lines = collector.lines();
+  ASSERT_EQ(lines.size(), 4u);
+  EXPECT_TRUE(EndsWith(lines[0], " Unavailable: down"));
+  EXPECT_TRUE(EndsWith(lines[1], " Out of range: row 7"));
+  EXPECT_TRUE(EndsWith(
+      lines[2],
+      " Internal: " +
+          std::string(ErrorWithExplanation::kInlineCapacity, 'x') +
+          ErrorSink::kTruncatedMarker));
+  EXPECT_TRUE(EndsWith(lines[3], " Internal: " + fits));
+  EXPECT_EQ(sink.GetStats().recorded, 4u);
+}
+
+TEST(ErrorSinkTest, SamplingTest) {
+  CollectingWriter collector;
+  ErrorSink::Options options = SlowFlushOptions();
+  options.sample_every = 4u;
+  ErrorSink sink(options, collector.writer());
+  for (int i = 0; i < 100; ++i) {
+    sink.Record(ErrorWithExplanation(Error::kNotFound, "missing"));
+  }
+  sink.Flush();
+  EXPECT_EQ(collector.lines().size(), 25u);
+  EXPECT_EQ(sink.GetStats().sampled_out, 75u);
+}
+
+TEST(ErrorSinkTest, RateLimitAndRingFullTest) {
+  CollectingWriter collector;
+  ErrorSink::Options options = SlowFlushOptions();
+  options.ring_capacity = 8u;
+  ErrorSink sink(options, collector.writer());
+  for (int i = 0; i < 20; ++i) {
+    sink.Record(ErrorWithExplanation(Error::kNotFound, "missing"));
+  }
+  ErrorSink::Stats stats = sink.GetStats();
+  EXPECT_EQ(stats.recorded, 8u);
+  EXPECT_EQ(stats.ring_full, 12u);
+  sink.Flush();
+  EXPECT_EQ(collector.lines().size(), 8u);
+
+  ErrorSink::Options limited = SlowFlushOptions();
+  limited.max_per_second = 5u;
+  ErrorSink limited_sink(limited, collector.writer());
+  std::size_t accepted = 0u;
+  for (int i = 0; i < 10; ++i) {
+    accepted +=
+        limited_sink.Record(ErrorWithExplanation(Error::kNotFound, "x"));
+  }
+  // the window may roll over once while looping
+  EXPECT_GE(accepted, 5u);
+  EXPECT_LE(accepted, 10u);
+  EXPECT_EQ(limited_sink.GetStats().rate_limited, 10u - accepted);
+}
+
+TEST(ErrorSinkTest, BackgroundThreadTest) {
+  CollectingWriter collector;
+  ErrorSink::Options options;
+  options.flush_interval = std::chrono::milliseconds(1);
+  {
+    ErrorSink sink(options, collector.writer());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&sink] {
+        for (int j = 0; j < 500; ++j) {
+          while (!sink.Record(
+              ErrorWithExplanation::Format(Error::kUnavailable, "{}", j))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(sink.GetStats().recorded, 2000u);
+  }
+  EXPECT_EQ(collector.lines().size(), 2000u);
+}
+
+#ifdef COMMON_ERROR_SINK
+TEST(ErrorSinkTest, InstallTest) {
+  CollectingWriter collector;
+  ErrorSink sink(SlowFlushOptions(), collector.writer());
+  ErrorWithExplanation before(Error::kInternal, "before");
+  ErrorSink::Install(&sink);
+  ErrorWithExplanation during(Error::kInternal, "during");
+  ErrorSink::Install(nullptr);
+  ErrorWithExplanation after(Error::kInternal, "after");
+  sink.Flush();
+  const std::vector<std::string> lines = collector.lines();
+  ASSERT_EQ(lines.size(), 1u);
+  EXPECT_TRUE(EndsWith(lines[0], " Internal: during"));
+}
+#endif
+
+}  // namespace common
@@ -0,0 +1,29 @@
+#ifndef COMMON_ERROR_SITE_H_
+#define COMMON_ERROR_SITE_H_
+
+#include <cstdint>
+
+namespace common {
+
+/// Source location at which an error was created. Used as a defaulted last
+/// parameter, Current() captures the location of the caller.
+struct ErrorSite {
+  static constexpr ErrorSite Current(const char* file = __builtin_FILE(),
+                                     int line = __builtin_LINE()) {
+    return ErrorSite{file, line};
+  }
+
+  const char* file;
+  int line;
+};
+
+/// What kind of object reported an error
+enum class ErrorEvent : std::uint8_t {
+  kError,
+  kErrorWithExplanation,
+  kErrorOrFailure,
+};
+
+}  // namespace common
+
+#endif  // COMMON_ERROR_SITE_H_
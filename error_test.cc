@@ -1,13 +1,163 @@
 #include "common/error.h"
 
+#include <cstdio>
+#include <string>
+#include <utility>
+
 #include "gtest/gtest.h"
 
 namespace common {
 
+TEST(ErrorTest, ErrorStringTest) {
+  static_assert(ErrorString(Error::kNotFound)[0] == 'N',
+                "ErrorString must be usable at compile time");
+  EXPECT_STREQ(ErrorString(Error::kNotFound), "Not found");
+  EXPECT_STREQ(ErrorString(Error::kInternal), "Internal");
+  EXPECT_STREQ(ErrorString(static_cast<Error>(100)), "Unknown");
+}
+
+TEST(ErrorTest, EnumTraitTest) {
+  static_assert(EnumTrait<Error>::num_values() == 5u, "");
+  constexpr auto values = EnumListTrait<Error>::values();
+  static_assert(values[2] == Error::kOutOfRange, "");
+  EXPECT_EQ(EnumTrait<Error>::default_value(), Error::kInternal);
+  for (Error error : values) {
+    EXPECT_STREQ(EnumTrait<Error>::to_string(error), ErrorString(error));
+  }
+}
+
+TEST(ErrorTest, ParseErrorStringTest) {
+  for (Error error : EnumListTrait<Error>::values()) {
+    Error parsed = Error::kInternal;
+    EXPECT_TRUE(ParseErrorString(ErrorString(error), &parsed));
+    EXPECT_EQ(parsed, error);
+  }
+  Error parsed = Error::kInternal;
+  EXPECT_FALSE(ParseErrorString("Not foun", &parsed));
+  EXPECT_FALSE(ParseErrorString("Not found!", &parsed));
+  EXPECT_FALSE(ParseErrorString("", &parsed));
+  EXPECT_EQ(parsed, Error::kInternal);
+}
+
 TEST(ErrorWithExplanationTest, ConstructDestructTest) {
-  ErrorWithExplanation error{.error_code = Error::kUnavailable,
-                             .explanation = "Something was not available"};
+  ErrorWithExplanation error(Error::kUnavailable,
+                             "Something was not available");
+  EXPECT_EQ(error.error_code(), Error::kUnavailable);
   EXPECT_EQ(error.Explain(), "Unavailable: Something was not available");
 }
 
+TEST(ErrorWithExplanationTest, RuntimeStringTest) {
+  std::string short_explanation = "short";
+  std::string long_explanation(100, 'x');
+  ErrorWithExplanation short_error(Error::kNotFound, short_explanation);
+  ErrorWithExplanation long_error(Error::kNotFound, long_explanation);
+  short_explanation.clear();
+  EXPECT_EQ(short_error.Explain(), "Not found: short");
+  EXPECT_EQ(long_error.Explain(), "Not found: " + long_explanation);
+
+  char buffer[16] = "mutable";
+  ErrorWithExplanation buffer_error(Error::kInternal, buffer);
+  buffer[0] = 'M';
+  EXPECT_EQ(buffer_error.Explain(), "Internal: mutable");
+}
+
+TEST(ErrorWithExplanationTest, ArrayTest) {
+  static const char kPadded[32] = "short";
+  ErrorWithExplanation padded(Error::kInternal, kPadded);
+  EXPECT_EQ(padded.Explain(), "Internal: short");
+  EXPECT_EQ(padded.Explain().size(), 15u);
+
+  const char unterminated[4] = {'a', 'b', 'c', 'd'};
+  EXPECT_EQ(ErrorWithExplanation(Error::kInternal, unterminated).Explain(),
+            "Internal: abcd");
+}
+
+namespace {
+
+ErrorWithExplanation LocalArrayError() {
+  const char local[] = "explanation held in a function local array";
+  return ErrorWithExplanation(Error::kNotFound, local);
+}
+
+}  // namespace
+
+TEST(ErrorWithExplanationTest, LocalArrayTest) {
+  EXPECT_EQ(LocalArrayError().Explain(),
+            "Not found: explanation held in a function local array");
+}
+
+TEST(ErrorWithExplanationTest, StaticTest) {
+  static const std::string kExplanation(100, 's');
+  ErrorWithExplanation error(Error::kUnavailable, ErrorWithExplanation::kStatic,
+                             kExplanation);
+  EXPECT_EQ(error.Explain(), "Unavailable: " + kExplanation);
+  ErrorWithExplanation literal(Error::kNotFound, ErrorWithExplanation::kStatic,
+                               "literal");
+  ErrorWithExplanation copy(literal);
+  EXPECT_EQ(copy.Explain(), "Not found: literal");
+}
+
+TEST(ErrorWithExplanationTest, FormatTest) {
+  ErrorWithExplanation error = ErrorWithExplanation::Format(
+      Error::kOutOfRange, "index {} of {} in '{}' ({})", -3, 10u, "table",
+      true);
+  EXPECT_EQ(error.Explain(), "Out of range: index -3 of 10 in 'table' (true)");
+
+  ErrorWithExplanation fewer_args = ErrorWithExplanation::Format(
+      Error::kInvalidArgument, "{} and {}", 'c');
+  EXPECT_EQ(fewer_args.Explain(), "Invalid Argument: c and {}");
+
+  ErrorWithExplanation floating = ErrorWithExplanation::Format(
+      Error::kInvalidArgument, "value {} is negative", -1.5);
+  EXPECT_EQ(floating.Explain(), "Invalid Argument: value -1.5 is negative");
+}
+
+namespace {
+
+ErrorWithExplanation FormatFromBuffer(const char* key) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%s", key);
+  return ErrorWithExplanation::Format(Error::kNotFound, "missing {}", buffer);
+}
+
+}  // namespace
+
+TEST(ErrorWithExplanationTest, FormatBufferTest) {
+  EXPECT_EQ(FormatFromBuffer("key").Explain(), "Not found: missing key");
+  const std::string long_key(31, 'k');
+  ErrorWithExplanation long_error = FormatFromBuffer(long_key.c_str());
+  ErrorWithExplanation copy(long_error);
+  EXPECT_EQ(copy.Explain(), "Not found: missing " + long_key);
+}
+
+TEST(ErrorWithExplanationTest, BufferExplainTest) {
+  ErrorWithExplanation error =
+      ErrorWithExplanation::Format(Error::kInternal, "code {}", 42);
+  char buffer[64];
+  EXPECT_EQ(error.Explain(buffer, sizeof(buffer)), 17u);
+  EXPECT_STREQ(buffer, "Internal: code 42");
+
+  char small_buffer[9];
+  EXPECT_EQ(error.Explain(small_buffer, sizeof(small_buffer)), 17u);
+  EXPECT_STREQ(small_buffer, "Internal");
+
+  EXPECT_EQ(error.Explain(nullptr, 0u), 17u);
+}
+
+TEST(ErrorWithExplanationTest, CopyMoveTest) {
+  std::string long_explanation(64, 'y');
+  ErrorWithExplanation original(Error::kUnavailable, long_explanation);
+  ErrorWithExplanation copy(original);
+  EXPECT_EQ(copy.Explain(), original.Explain());
+
+  ErrorWithExplanation moved(std::move(copy));
+  EXPECT_EQ(moved.Explain(), original.Explain());
+
+  ErrorWithExplanation assigned(Error::kNotFound, "literal");
+  assigned = original;
+  EXPECT_EQ(assigned.Explain(), original.Explain());
+  assigned = ErrorWithExplanation(Error::kInternal, "other");
+  EXPECT_EQ(assigned.Explain(), "Internal: other");
+}
+
 }  // namespace common
@@ -0,0 +1,145 @@
+#ifndef COMMON_INLINE_FUNCTION_H_
+#define COMMON_INLINE_FUNCTION_H_
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "common/memory/placement_new.h"
+
+namespace common {
+
+template <typename Signature, std::size_t Size = 4u * sizeof(void*)>
+class InlineFunction;
+
+/// @class InlineFunction
+/// Move-only replacement for std::function, e.g. for completion handlers
+/// receiving an ErrorOr. The callable is built with Construct() in an inline
+/// buffer of @p Size bytes and never allocates; a callable that does not fit
+/// is a compile error. Move-only callables, such as lambdas capturing a
+/// std::unique_ptr, are supported.
+///
+/// The only per-object overhead is one pointer to a static table of
+/// functions for the callable type, so a call costs the same as a virtual
+/// call. Callables that are trivially copyable are moved with a memcpy.
+/// Calling an empty InlineFunction is undefined.
+template <typename R, typename... Args, std::size_t Size>
+class InlineFunction<R(Args...), Size> {
+ public:
+  /// Whether a callable of type F can be stored
+  template <typename F>
+  static constexpr bool kFits =
+      sizeof(F) <= Size && alignof(F) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible<F>::value;
+
+  InlineFunction() : vtable_(nullptr) {}
+  InlineFunction(std::nullptr_t) : vtable_(nullptr) {}
+
+  template <typename F,
+            typename Callable = typename std::decay<F>::type,
+            typename = typename std::enable_if<
+                !std::is_same<Callable, InlineFunction>::value &&
+                std::is_invocable_r<R, Callable&, Args...>::value>::type>
+  InlineFunction(F&& callable) : vtable_(&kVTable<Callable>) {
+    static_assert(sizeof(Callable) <= Size,
+                  "callable does not fit, increase the Size of the "
+                  "InlineFunction or capture less");
+    static_assert(alignof(Callable) <= alignof(std::max_align_t),
+                  "over-aligned callables are not supported");
+    static_assert(std::is_nothrow_move_constructible<Callable>::value,
+                  "callables must be nothrow move constructible");
+    Construct<Callable>(storage_, std::forward<F>(callable));
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept : vtable_(other.vtable_) {
+    MoveFrom(&other);
+  }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (this != &other) {
+      Destroy();
+      vtable_ = other.vtable_;
+      MoveFrom(&other);
+    }
+    return *this;
+  }
+
+  InlineFunction& operator=(std::nullptr_t) {
+    Destroy();
+    vtable_ = nullptr;
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  ~InlineFunction() { Destroy(); }
+
+  explicit operator bool() const { return vtable_ != nullptr; }
+
+  R operator()(Args... args) const {
+    return vtable_->invoke(storage_, std::forward<Args>(args)...);
+  }
+
+ private:
+  struct VTable {
+    R (*invoke)(void* callable, Args&&... args);
+    // nullptr for trivially copyable callables, moved with a memcpy
+    void (*relocate)(void* from, void* to) noexcept;
+    // nullptr for trivially destructible callables
+    void (*destroy)(void* callable) noexcept;
+  };
+
+  template <typename F>
+  static R Invoke(void* callable, Args&&... args) {
+    return std::invoke(*static_cast<F*>(callable),
+                       std::forward<Args>(args)...);
+  }
+
+  template <typename F>
+  static void Relocate(void* from, void* to) noexcept {
+    F* source = static_cast<F*>(from);
+    Construct<F>(to, std::move(*source));
+    source->~F();
+  }
+
+  template <typename F>
+  static void DestroyCallable(void* callable) noexcept {
+    static_cast<F*>(callable)->~F();
+  }
+
+  template <typename F>
+  static constexpr VTable kVTable = {
+      &Invoke<F>,
+      std::is_trivially_copyable<F>::value ? nullptr : &Relocate<F>,
+      std::is_trivially_destructible<F>::value ? nullptr
+                                               : &DestroyCallable<F>,
+  };
+
+  // Takes the callable of @p other, whose vtable_ was copied already
+  void MoveFrom(InlineFunction* other) {
+    if (vtable_ != nullptr) {
+      if (vtable_->relocate == nullptr) {
+        std::memcpy(storage_, other->storage_, Size);
+      } else {
+        vtable_->relocate(other->storage_, storage_);
+      }
+      other->vtable_ = nullptr;
+    }
+  }
+
+  void Destroy() {
+    if (vtable_ != nullptr && vtable_->destroy != nullptr) {
+      vtable_->destroy(storage_);
+    }
+  }
+
+  const VTable* vtable_;
+  alignas(std::max_align_t) mutable unsigned char storage_[Size];
+};
+
+}  // namespace common
+
+#endif  // COMMON_INLINE_FUNCTION_H_
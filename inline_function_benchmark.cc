@@ -0,0 +1,100 @@
+#include <array>
+#include <functional>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "common/inline_function.h"
+
+namespace common {
+namespace {
+
+class Handler {
+ public:
+  virtual ~Handler() = default;
+  virtual int Call(int value) = 0;
+};
+
+class AddHandler : public Handler {
+ public:
+  explicit AddHandler(int offset) : offset_(offset) {}
+  int Call(int value) override { return value + offset_; }
+
+ private:
+  int offset_;
+};
+
+class SubtractHandler : public Handler {
+ public:
+  int Call(int value) override { return value - 1; }
+};
+
+void BM_CallVirtual(benchmark::State& state) {
+  // chosen at run time, so that the call is not devirtualized
+  bool add = true;
+  benchmark::DoNotOptimize(add);
+  std::unique_ptr<Handler> handler;
+  if (add) {
+    handler = std::make_unique<AddHandler>(1);
+  } else {
+    handler = std::make_unique<SubtractHandler>();
+  }
+  int value = 0;
+  for (auto _ : state) {
+    value = handler->Call(value);
+    benchmark::DoNotOptimize(value);
+  }
+}
+BENCHMARK(BM_CallVirtual);
+
+void BM_CallStdFunction(benchmark::State& state) {
+  int offset = 1;
+  std::function<int(int)> function([offset](int value) {
+    return value + offset;
+  });
+  benchmark::DoNotOptimize(function);
+  int value = 0;
+  for (auto _ : state) {
+    value = function(value);
+    benchmark::DoNotOptimize(value);
+  }
+}
+BENCHMARK(BM_CallStdFunction);
+
+void BM_CallInlineFunction(benchmark::State& state) {
+  int offset = 1;
+  InlineFunction<int(int)> function([offset](int value) {
+    return value + offset;
+  });
+  benchmark::DoNotOptimize(function);
+  int value = 0;
+  for (auto _ : state) {
+    value = function(value);
+    benchmark::DoNotOptimize(value);
+  }
+}
+BENCHMARK(BM_CallInlineFunction);
+
+// A completion handler capturing 32 bytes, more than std::function keeps
+// inline
+using Capture = std::array<long, 4>;
+
+void BM_CreateStdFunction(benchmark::State& state) {
+  Capture capture = {1, 2, 3, 4};
+  for (auto _ : state) {
+    std::function<long()> function([capture] { return capture[3]; });
+    benchmark::DoNotOptimize(function);
+  }
+}
+BENCHMARK(BM_CreateStdFunction);
+
+void BM_CreateInlineFunction(benchmark::State& state) {
+  Capture capture = {1, 2, 3, 4};
+  for (auto _ : state) {
+    InlineFunction<long()> function([capture] { return capture[3]; });
+    benchmark::DoNotOptimize(function);
+  }
+}
+BENCHMARK(BM_CreateInlineFunction);
+
+}  // namespace
+}  // namespace common
@@ -0,0 +1,134 @@
+#include "common/inline_function.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "common/error_or.h"
+
+namespace common {
+namespace {
+
+// Counts live copies of a callable
+struct Counted {
+  static int live;
+
+  Counted() { ++live; }
+  Counted(const Counted&) { ++live; }
+  Counted(Counted&&) noexcept { ++live; }
+  ~Counted() { --live; }
+
+  int operator()(int value) const { return value + 1; }
+};
+
+int Counted::live = 0;
+
+int Twice(int value) { return 2 * value; }
+
+}  // namespace
+
+TEST(InlineFunctionTest, CallTest) {
+  InlineFunction<int(int)> empty;
+  EXPECT_FALSE(empty);
+
+  InlineFunction<int(int)> twice(Twice);
+  EXPECT_TRUE(twice);
+  EXPECT_EQ(twice(21), 42);
+
+  int calls = 0;
+  InlineFunction<void()> count([&calls] { ++calls; });
+  count();
+  count();
+  EXPECT_EQ(calls, 2);
+
+  // mutable callables keep their state between calls
+  InlineFunction<int()> counter([next = 0]() mutable { return next++; });
+  counter();
+  EXPECT_EQ(counter(), 1);
+
+  std::string text = "text";
+  InlineFunction<std::string&()> reference([&text]() -> std::string& {
+    return text;
+  });
+  EXPECT_EQ(&reference(), &text);
+}
+
+TEST(InlineFunctionTest, InlineStorageTest) {
+  // the buffer and one vtable pointer, padded to the buffer alignment
+  static_assert(sizeof(InlineFunction<void(), 64>) ==
+                    64u + alignof(std::max_align_t),
+                "");
+  const std::array<long, 3> captured = {1, 2, 3};
+  InlineFunction<long(long)> sum([captured](long value) {
+    return value + captured[0] + captured[1] + captured[2];
+  });
+  InlineFunction<long(long)> moved(std::move(sum));
+  EXPECT_FALSE(sum);
+  EXPECT_EQ(moved(4), 10);
+  sum = std::move(moved);
+  EXPECT_EQ(sum(0), 6);
+  EXPECT_FALSE(moved);
+}
+
+TEST(InlineFunctionTest, MoveOnlyTest) {
+  auto value = std::make_unique<int>(7);
+  InlineFunction<int()> owner(
+      [value = std::move(value)] { return *value; });
+  EXPECT_EQ(owner(), 7);
+  InlineFunction<int()> moved(std::move(owner));
+  EXPECT_EQ(moved(), 7);
+
+  // arguments may be move-only too
+  InlineFunction<int(std::unique_ptr<int>)> take(
+      [](std::unique_ptr<int> pointer) { return *pointer; });
+  EXPECT_EQ(take(std::make_unique<int>(3)), 3);
+}
+
+TEST(InlineFunctionTest, LifetimeTest) {
+  {
+    InlineFunction<int(int)> first{Counted()};
+    EXPECT_EQ(Counted::live, 1);
+    InlineFunction<int(int)> second(std::move(first));
+    EXPECT_EQ(Counted::live, 1);
+    EXPECT_EQ(second(1), 2);
+    first = Counted();
+    EXPECT_EQ(Counted::live, 2);
+    first = std::move(second);
+    EXPECT_EQ(Counted::live, 1);
+    first = nullptr;
+    EXPECT_EQ(Counted::live, 0);
+    EXPECT_FALSE(first);
+  }
+  EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(InlineFunctionTest, ErrorOrHandlerTest) {
+  std::string received;
+  InlineFunction<void(ErrorOr<std::string>)> done(
+      [&received](ErrorOr<std::string> result) {
+        received = result.HasValue()
+                       ? result.MoveValueOrDie()
+                       : std::string(ErrorString(result.ErrorOrDie()));
+      });
+  done(ErrorOr<std::string>(std::string("value")));
+  EXPECT_EQ(received, "value");
+  done(ErrorOr<std::string>(Error::kNotFound));
+  EXPECT_EQ(received, "Not found");
+}
+
+TEST(InlineFunctionTest, FitsTest) {
+  struct Large {
+    std::array<char, 64> bytes;
+    void operator()() const {}
+  };
+  static_assert(!InlineFunction<void()>::kFits<Large>, "");
+  static_assert(InlineFunction<void(), 64>::kFits<Large>, "");
+  static_assert(InlineFunction<void()>::kFits<int (*)(int)>, "");
+  InlineFunction<void(), 64> large{Large()};
+  large();
+}
+
+}  // namespace common
@@ -0,0 +1,92 @@
+#include "common/memory/arena.h"
+
+#include <algorithm>
+
+namespace common {
+
+namespace {
+
+constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+}  // namespace
+
+Arena::Arena(std::size_t block_size, std::pmr::memory_resource* upstream)
+    : Arena(nullptr, 0u, block_size, upstream) {}
+
+Arena::Arena(void* initial_buffer, std::size_t size, std::size_t block_size,
+             std::pmr::memory_resource* upstream)
+    : current_(static_cast<char*>(initial_buffer)),
+      end_(static_cast<char*>(initial_buffer) + size),
+      blocks_(nullptr),
+      destructors_(nullptr),
+      initial_buffer_(static_cast<char*>(initial_buffer)),
+      initial_size_(size),
+      block_size_(std::max(block_size, 2u * sizeof(Block))),
+      next_block_size_(block_size_),
+      allocated_(0u),
+      reserved_(0u),
+      upstream_(upstream),
+      resource_(this) {}
+
+Arena::~Arena() {
+  RunDestructors();
+  ReleaseBlocks();
+}
+
+void Arena::Reset() {
+  RunDestructors();
+  ReleaseBlocks();
+  current_ = initial_buffer_;
+  end_ = initial_buffer_ + initial_size_;
+  next_block_size_ = block_size_;
+  allocated_ = 0u;
+}
+
+void* Arena::AllocateSlow(std::size_t size, std::size_t alignment) {
+  // the header is followed by the allocation, aligned within the block
+  const std::size_t block_alignment =
+      std::max(alignment, alignof(std::max_align_t));
+  const std::size_t needed = AlignUp(sizeof(Block), alignment) + size;
+  const std::size_t block_size = std::max(next_block_size_, needed);
+  Block* block = static_cast<Block*>(
+      upstream_->allocate(block_size, block_alignment));
+  block->next = blocks_;
+  block->size = block_size;
+  block->alignment = block_alignment;
+  blocks_ = block;
+  reserved_ += block_size;
+  // a block size above kMaxBlockSize is kept rather than shrunk
+  next_block_size_ =
+      std::min(next_block_size_ * 2u, std::max(block_size_, kMaxBlockSize));
+
+  char* const begin = reinterpret_cast<char*>(block);
+  char* const result = begin + AlignUp(sizeof(Block), alignment);
+  // keep bumping from whichever block has more room left
+  if (begin + block_size - (result + size) >= end_ - current_) {
+    current_ = result + size;
+    end_ = begin + block_size;
+  }
+  allocated_ += size;
+  return result;
+}
+
+void Arena::RunDestructors() {
+  while (destructors_ != nullptr) {
+    Destructor* destructor = destructors_;
+    destructors_ = destructor->next;
+    destructor->destroy(destructor->object);
+  }
+}
+
+void Arena::ReleaseBlocks() {
+  while (blocks_ != nullptr) {
+    Block* block = blocks_;
+    blocks_ = block->next;
+    upstream_->deallocate(block, block->size, block->alignment);
+  }
+  reserved_ = 0u;
+}
+
+}  // namespace common
@@ -0,0 +1,158 @@
+#ifndef COMMON_ARENA_H_
+#define COMMON_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include "common/memory/placement_new.h"
+
+namespace common {
+
+/// @class Arena
+/// Monotonic bump allocator for objects that die together, e.g. everything
+/// built while serving one request. Allocation bumps a pointer through
+/// blocks obtained from an upstream std::pmr::memory_resource, the backend;
+/// nothing is freed until Reset() or destruction, which run the destructors
+/// registered by Create() in reverse order and return every block at once.
+///
+/// An optional caller owned initial buffer, e.g. on the stack, is used
+/// before any block is requested, so that small workloads never reach the
+/// upstream resource. Blocks double in size from @p block_size, up to
+/// kMaxBlockSize, or stay at @p block_size if it is larger, unless a request
+/// needs more. resource() adapts the arena to std::pmr containers. Not
+/// thread-safe.
+class Arena {
+ public:
+  static constexpr std::size_t kDefaultBlockSize = 4096u;
+  static constexpr std::size_t kMaxBlockSize = std::size_t{1} << 20;
+
+  explicit Arena(
+      std::size_t block_size = kDefaultBlockSize,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  /// Allocates from the @p size bytes at @p initial_buffer first, which must
+  /// outlive the arena
+  Arena(void* initial_buffer, std::size_t size,
+        std::size_t block_size = kDefaultBlockSize,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// @return  @p size bytes aligned to @p alignment, a power of two. Throws
+  ///          what the upstream resource throws, std::bad_alloc by default.
+  void* Allocate(std::size_t size,
+                 std::size_t alignment = alignof(std::max_align_t)) {
+    const std::uintptr_t aligned =
+        (reinterpret_cast<std::uintptr_t>(current_) + alignment - 1u) &
+        ~(std::uintptr_t{alignment} - 1u);
+    const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(end_);
+    if (aligned <= end && size <= end - aligned) {
+      current_ = reinterpret_cast<char*>(aligned + size);
+      allocated_ += size;
+      return reinterpret_cast<void*>(aligned);
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  /// @return  uninitialized storage for @p count objects of type T
+  template <typename T>
+  T* AllocateArray(std::size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /// Constructs a T in the arena with Construct(). Unless T is trivially
+  /// destructible, its destructor is registered to run on Reset().
+  template <typename T, typename... Args>
+  T* Create(Args&&... args) {
+    if constexpr (std::is_trivially_destructible<T>::value) {
+      return Construct<T>(Allocate(sizeof(T), alignof(T)),
+                          std::forward<Args>(args)...);
+    } else {
+      // allocated first, so that a throwing constructor registers nothing
+      Destructor* destructor = static_cast<Destructor*>(
+          Allocate(sizeof(Destructor), alignof(Destructor)));
+      T* object = Construct<T>(Allocate(sizeof(T), alignof(T)),
+                               std::forward<Args>(args)...);
+      destructor->destroy = [](void* object) {
+        static_cast<T*>(object)->~T();
+      };
+      destructor->object = object;
+      destructor->next = destructors_;
+      destructors_ = destructor;
+      return object;
+    }
+  }
+
+  /// Runs the registered destructors, newest first, and returns every block
+  /// to the upstream resource. The initial buffer is kept for reuse.
+  void Reset();
+
+  /// @return  the bytes handed out since the last Reset()
+  std::size_t bytes_allocated() const { return allocated_; }
+
+  /// @return  the bytes held from the upstream resource
+  std::size_t bytes_reserved() const { return reserved_; }
+
+  /// @return  the arena as a memory resource for std::pmr containers, whose
+  ///          deallocations are no-ops. Valid as long as the arena.
+  std::pmr::memory_resource* resource() { return &resource_; }
+
+ private:
+  // Header at the start of each upstream block
+  struct Block {
+    Block* next;
+    std::size_t size;
+    std::size_t alignment;
+  };
+
+  struct Destructor {
+    void (*destroy)(void*);
+    void* object;
+    Destructor* next;
+  };
+
+  class Resource : public std::pmr::memory_resource {
+   public:
+    explicit Resource(Arena* arena) : arena_(arena) {}
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+      // a fresh arena would return its null bump pointer for 0 bytes
+      return arena_->Allocate(bytes != 0u ? bytes : 1u, alignment);
+    }
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    Arena* arena_;
+  };
+
+  void* AllocateSlow(std::size_t size, std::size_t alignment);
+  void RunDestructors();
+  void ReleaseBlocks();
+
+  char* current_;
+  char* end_;
+  Block* blocks_;
+  Destructor* destructors_;
+  char* initial_buffer_;
+  std::size_t initial_size_;
+  std::size_t block_size_;
+  std::size_t next_block_size_;
+  std::size_t allocated_;
+  std::size_t reserved_;
+  std::pmr::memory_resource* upstream_;
+  Resource resource_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_ARENA_H_
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+
+#include "benchmark/benchmark.h"
+#include "common/memory/arena.h"
+
+namespace common {
+namespace {
+
+// One request allocates kObjects objects of 16 to 256 bytes, writes their
+// first 16 bytes and frees them all at its end
+constexpr int kObjects = 64;
+
+std::size_t ObjectSize(int i) { return 16u + (i * 37u) % 241u; }
+
+void BM_RequestMalloc(benchmark::State& state) {
+  void* objects[kObjects];
+  for (auto _ : state) {
+    for (int i = 0; i < kObjects; ++i) {
+      objects[i] = std::malloc(ObjectSize(i));
+      std::memset(objects[i], i, 16u);
+    }
+    benchmark::ClobberMemory();
+    for (int i = 0; i < kObjects; ++i) {
+      std::free(objects[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kObjects);
+}
+BENCHMARK(BM_RequestMalloc);
+
+void BM_RequestArena(benchmark::State& state) {
+  for (auto _ : state) {
+    Arena arena;
+    for (int i = 0; i < kObjects; ++i) {
+      void* object = arena.Allocate(ObjectSize(i), 8u);
+      std::memset(object, i, 16u);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kObjects);
+}
+BENCHMARK(BM_RequestArena);
+
+void BM_RequestArenaInitialBuffer(benchmark::State& state) {
+  alignas(std::max_align_t) char buffer[16384];
+  Arena arena(buffer, sizeof(buffer));
+  for (auto _ : state) {
+    for (int i = 0; i < kObjects; ++i) {
+      void* object = arena.Allocate(ObjectSize(i), 8u);
+      std::memset(object, i, 16u);
+    }
+    benchmark::ClobberMemory();
+    arena.Reset();
+  }
+  state.SetItemsProcessed(state.iterations() * kObjects);
+}
+BENCHMARK(BM_RequestArenaInitialBuffer);
+
+void BM_RequestMonotonicBufferResource(benchmark::State& state) {
+  for (auto _ : state) {
+    std::pmr::monotonic_buffer_resource resource;
+    for (int i = 0; i < kObjects; ++i) {
+      void* object = resource.allocate(ObjectSize(i), 8u);
+      std::memset(object, i, 16u);
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kObjects);
+}
+BENCHMARK(BM_RequestMonotonicBufferResource);
+
+}  // namespace
+}  // namespace common
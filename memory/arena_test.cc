@@ -0,0 +1,174 @@
+#include "common/memory/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+namespace {
+
+// Counts what the arena takes from upstream
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  int allocations = 0;
+  int live = 0;
+  std::size_t bytes = 0u;
+  std::vector<std::size_t> sizes;
+
+ private:
+  void* do_allocate(std::size_t size, std::size_t alignment) override {
+    ++allocations;
+    sizes.push_back(size);
+    ++live;
+    bytes += size;
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+  }
+  void do_deallocate(void* pointer, std::size_t size,
+                     std::size_t alignment) override {
+    --live;
+    bytes -= size;
+    std::pmr::new_delete_resource()->deallocate(pointer, size, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+class Recorder {
+ public:
+  Recorder(std::vector<int>* destroyed, int id)
+      : destroyed_(destroyed), id_(id) {}
+  ~Recorder() { destroyed_->push_back(id_); }
+
+  int id() const { return id_; }
+
+ private:
+  std::vector<int>* destroyed_;
+  int id_;
+};
+
+bool IsAligned(const void* pointer, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0u;
+}
+
+}  // namespace
+
+TEST(ArenaTest, AllocateTest) {
+  CountingResource upstream;
+  Arena arena(1024u, &upstream);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+  char* first = static_cast<char*>(arena.Allocate(10u, 1u));
+  char* second = static_cast<char*>(arena.Allocate(10u, 1u));
+  EXPECT_EQ(second, first + 10);
+  EXPECT_TRUE(IsAligned(arena.Allocate(8u, 64u), 64u));
+  EXPECT_TRUE(IsAligned(arena.Allocate(1u), alignof(std::max_align_t)));
+  EXPECT_EQ(upstream.allocations, 1);
+  EXPECT_EQ(arena.bytes_allocated(), 10u + 10u + 8u + 1u);
+
+  // blocks double until a request needs more
+  for (int i = 0; i < 100; ++i) {
+    arena.Allocate(100u, 8u);
+  }
+  EXPECT_GT(upstream.allocations, 1);
+  EXPECT_LT(upstream.allocations, 6);
+  EXPECT_EQ(arena.bytes_reserved(), upstream.bytes);
+
+  // a large request gets a block of its own
+  EXPECT_TRUE(IsAligned(arena.Allocate(1u << 21, 4096u), 4096u));
+  EXPECT_GE(arena.bytes_reserved(), std::size_t{1} << 21);
+
+  arena.Reset();
+  EXPECT_EQ(upstream.live, 0);
+  EXPECT_EQ(arena.bytes_allocated(), 0u);
+  EXPECT_EQ(arena.bytes_reserved(), 0u);
+}
+
+TEST(ArenaTest, BlockSizeTest) {
+  CountingResource upstream;
+  Arena arena(1024u, &upstream);
+  while (upstream.allocations < 20) {
+    arena.Allocate(512u, 8u);
+  }
+  ASSERT_EQ(upstream.sizes.size(), 20u);
+  EXPECT_EQ(upstream.sizes[0], 1024u);
+  for (std::size_t i = 1; i < upstream.sizes.size(); ++i) {
+    EXPECT_EQ(upstream.sizes[i],
+              std::min(upstream.sizes[i - 1] * 2u, Arena::kMaxBlockSize));
+  }
+
+  // a block size above kMaxBlockSize does not shrink
+  constexpr std::size_t kLargeBlockSize = std::size_t{8} << 20;
+  CountingResource large_upstream;
+  Arena large(kLargeBlockSize, &large_upstream);
+  while (large_upstream.allocations < 3) {
+    large.Allocate(std::size_t{1} << 20, 8u);
+  }
+  for (std::size_t size : large_upstream.sizes) {
+    EXPECT_EQ(size, kLargeBlockSize);
+  }
+}
+
+TEST(ArenaTest, InitialBufferTest) {
+  CountingResource upstream;
+  alignas(std::max_align_t) char buffer[256];
+  Arena arena(buffer, sizeof(buffer), 1024u, &upstream);
+  void* inline_allocation = arena.Allocate(200u, 8u);
+  EXPECT_GE(static_cast<char*>(inline_allocation), buffer);
+  EXPECT_LT(static_cast<char*>(inline_allocation), buffer + sizeof(buffer));
+  EXPECT_EQ(upstream.allocations, 0);
+  arena.Allocate(100u, 8u);
+  EXPECT_EQ(upstream.allocations, 1);
+
+  // Reset() goes back to the buffer
+  arena.Reset();
+  EXPECT_EQ(upstream.live, 0);
+  EXPECT_EQ(arena.Allocate(200u, 8u), inline_allocation);
+  EXPECT_EQ(upstream.allocations, 1);
+}
+
+TEST(ArenaTest, CreateTest) {
+  std::vector<int> destroyed;
+  {
+    Arena arena;
+    Recorder* first = arena.Create<Recorder>(&destroyed, 1);
+    arena.Create<Recorder>(&destroyed, 2);
+    int* number = arena.Create<int>(42);
+    EXPECT_EQ(first->id(), 1);
+    EXPECT_EQ(*number, 42);
+    arena.Reset();
+    EXPECT_EQ(destroyed, (std::vector<int>{2, 1}));
+
+    arena.Create<Recorder>(&destroyed, 3);
+    std::string* text =
+        arena.Create<std::string>("a string long enough to allocate itself");
+    EXPECT_EQ(text->size(), 39u);
+  }
+  // the destructor runs what is left
+  EXPECT_EQ(destroyed, (std::vector<int>{2, 1, 3}));
+}
+
+TEST(ArenaTest, ResourceTest) {
+  CountingResource upstream;
+  Arena arena(4096u, &upstream);
+  {
+    std::pmr::vector<int> numbers(arena.resource());
+    for (int i = 0; i < 1000; ++i) {
+      numbers.push_back(i);
+    }
+    EXPECT_EQ(numbers[999], 999);
+    std::pmr::string text("pmr strings use the arena too", arena.resource());
+    EXPECT_EQ(text.get_allocator().resource(), arena.resource());
+  }
+  EXPECT_GT(arena.bytes_allocated(), 1000u * sizeof(int));
+  EXPECT_TRUE(arena.resource()->is_equal(*arena.resource()));
+  EXPECT_NE(arena.resource()->allocate(0u), nullptr);
+  arena.Reset();
+  EXPECT_EQ(upstream.live, 0);
+}
+
+}  // namespace common
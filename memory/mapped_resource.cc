@@ -0,0 +1,174 @@
+#include "common/memory/mapped_resource.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace common {
+
+namespace {
+
+constexpr std::size_t kPageSize = 4096u;
+// Node masks handed to mbind cover nodes [0, kMaxNumaNodes)
+constexpr int kMaxNumaNodes = 1024;
+
+constexpr std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1u) & ~(alignment - 1u);
+}
+
+// @return  @p size bytes of inaccessible address space aligned to the huge
+//          page size, or nullptr
+char* Reserve(std::size_t size, bool explicit_huge_pages) {
+  if (explicit_huge_pages) {
+    // without MAP_NORESERVE the hugetlb pool must hold enough pages now,
+    // rather than failing with SIGBUS on a later first touch
+    void* base = mmap(nullptr, size, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return base != MAP_FAILED ? static_cast<char*>(base) : nullptr;
+  }
+  const std::size_t padded = size + MappedResource::kHugePageSize;
+  void* mapped = mmap(nullptr, padded, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  // trim the padding around the aligned part
+  char* const begin = static_cast<char*>(mapped);
+  char* const base = reinterpret_cast<char*>(
+      AlignUp(reinterpret_cast<std::uintptr_t>(begin),
+              MappedResource::kHugePageSize));
+  if (base != begin) {
+    munmap(begin, base - begin);
+  }
+  if (begin + padded != base + size) {
+    munmap(base + size, begin + padded - (base + size));
+  }
+  return base;
+}
+
+bool PreferNode(char* base, std::size_t size, int node) {
+  if (node < 0 || node >= kMaxNumaNodes) {
+    return false;
+  }
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);
+  unsigned long mask[kMaxNumaNodes / kBitsPerWord] = {};
+  mask[node / kBitsPerWord] = 1ul << (node % kBitsPerWord);
+  // the kernel reads maxnode - 1 bits
+  return syscall(SYS_mbind, base, size, MPOL_PREFERRED, mask,
+                 kMaxNumaNodes + 1ul, 0u) == 0;
+}
+
+void Prefault(char* begin, std::size_t size) {
+  if (madvise(begin, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+  // kernels before 5.14 do not know MADV_POPULATE_WRITE
+  for (std::size_t offset = 0u; offset < size; offset += kPageSize) {
+    static_cast<volatile char*>(begin)[offset] = 0;
+  }
+}
+
+}  // namespace
+
+MappedResource::MappedResource(const MappedResourceOptions& options)
+    : options_(options),
+      huge_pages_(options.huge_pages),
+      numa_placed_(false),
+      base_(nullptr),
+      reserved_(AlignUp(std::max<std::size_t>(options.reserve_size, 1u),
+                        kHugePageSize)),
+      committed_(0u),
+      current_(0u),
+      paddings_begin_(0u),
+      paddings_end_(0u) {
+  options_.commit_size =
+      AlignUp(std::max<std::size_t>(options.commit_size, 1u), kHugePageSize);
+  if (huge_pages_ == HugePages::kExplicit) {
+    base_ = Reserve(reserved_, true);
+    if (base_ == nullptr) {
+      huge_pages_ = HugePages::kTransparent;
+    }
+  }
+  if (base_ == nullptr) {
+    base_ = Reserve(reserved_, false);
+    if (base_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+  if (huge_pages_ == HugePages::kTransparent &&
+      madvise(base_, reserved_, MADV_HUGEPAGE) != 0) {
+    huge_pages_ = HugePages::kNone;
+  }
+  if (options_.numa_node != MappedResourceOptions::kAnyNode) {
+    numa_placed_ = PreferNode(base_, reserved_, options_.numa_node);
+  }
+}
+
+MappedResource::~MappedResource() { munmap(base_, reserved_); }
+
+int MappedResource::CurrentNumaNode() {
+  unsigned cpu = 0u;
+  unsigned node = 0u;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+    return MappedResourceOptions::kAnyNode;
+  }
+  return static_cast<int>(node);
+}
+
+void* MappedResource::do_allocate(std::size_t bytes, std::size_t alignment) {
+  const std::size_t aligned = AlignUp(current_, alignment);
+  if (aligned > reserved_ || bytes > reserved_ - aligned) {
+    throw std::bad_alloc();
+  }
+  if (aligned + bytes > committed_) {
+    Commit(aligned + bytes);
+  }
+  if (aligned != current_) {
+    if (paddings_end_ - paddings_begin_ == kMaxPaddings) {
+      ++paddings_begin_;
+    }
+    padding(paddings_end_++) = Padding{aligned, current_};
+  }
+  current_ = aligned + bytes;
+  return base_ + aligned;
+}
+
+void MappedResource::do_deallocate(void* pointer, std::size_t bytes,
+                                   std::size_t) {
+  // only the newest allocation can be given back
+  const std::size_t offset = static_cast<std::size_t>(
+      static_cast<char*>(pointer) - base_);
+  if (offset + bytes != current_) {
+    return;
+  }
+  current_ = offset;
+  // every older allocation starts below this one, so a padding recorded at
+  // this offset is the padding of this allocation
+  if (paddings_end_ != paddings_begin_ &&
+      padding(paddings_end_ - 1u).aligned == offset) {
+    current_ = padding(--paddings_end_).previous;
+  }
+}
+
+void MappedResource::Commit(std::size_t end) {
+  const std::size_t committed = std::min(
+      AlignUp(std::max(end, committed_ + options_.commit_size),
+              options_.commit_size),
+      reserved_);
+  char* const begin = base_ + committed_;
+  const std::size_t size = committed - committed_;
+  if (mprotect(begin, size, PROT_READ | PROT_WRITE) != 0) {
+    throw std::bad_alloc();
+  }
+  if (options_.prefault) {
+    Prefault(begin, size);
+  }
+  committed_ = committed;
+}
+
+}  // namespace common
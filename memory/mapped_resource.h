@@ -0,0 +1,123 @@
+#ifndef COMMON_MAPPED_RESOURCE_H_
+#define COMMON_MAPPED_RESOURCE_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace common {
+
+enum class HugePages {
+  kNone,         // base pages only
+  kTransparent,  // madvise(MADV_HUGEPAGE), used if THP is enabled
+  kExplicit,     // MAP_HUGETLB from the preallocated pool
+};
+
+struct MappedResourceOptions {
+  static constexpr int kAnyNode = -1;
+
+  /// Address space reserved up front; allocations beyond it fail
+  std::size_t reserve_size = std::size_t{1} << 30;
+  /// Reserved memory is committed in steps of at least this many bytes,
+  /// rounded up to the huge page size
+  std::size_t commit_size = std::size_t{2} << 20;
+  /// Explicit huge pages fall back to transparent ones when the hugetlb pool
+  /// cannot back the whole reservation, which it must at construction
+  HugePages huge_pages = HugePages::kTransparent;
+  /// Preferred NUMA node of committed memory, e.g. CurrentNumaNode()
+  int numa_node = kAnyNode;
+  /// Fault committed memory in right away, so that first touches do not
+  /// take page faults
+  bool prefault = false;
+};
+
+/// @class MappedResource
+/// Memory resource for large, long-lived arenas, e.g. lookup tables of many
+/// GB, where TLB misses matter. It reserves address space with mmap, aligned
+/// to the huge page size, and commits it lazily as allocations bump through
+/// it, asking for huge pages, NUMA placement and pre-faulting as configured.
+/// Features the system does not offer are skipped; the accessors report what
+/// is in effect.
+///
+/// Deallocation in reverse order of allocation, as done by Arena::Reset(),
+/// makes the memory available again, alignment padding included; other
+/// deallocations only take effect on Release(). Committed memory stays
+/// committed until destruction. Use as the upstream of an Arena, with a
+/// block size of a few huge pages. Not thread-safe.
+class MappedResource : public std::pmr::memory_resource {
+ public:
+  static constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+
+  /// Throws std::bad_alloc if the address space cannot be reserved
+  explicit MappedResource(
+      const MappedResourceOptions& options = MappedResourceOptions());
+  ~MappedResource() override;
+
+  MappedResource(const MappedResource&) = delete;
+  MappedResource& operator=(const MappedResource&) = delete;
+
+  /// Makes all reserved memory available again, invalidating every
+  /// allocation
+  void Release() {
+    current_ = 0u;
+    paddings_begin_ = 0u;
+    paddings_end_ = 0u;
+  }
+
+  /// @return  the huge pages in effect
+  HugePages huge_pages() const { return huge_pages_; }
+
+  /// @return  whether committed memory is placed on options.numa_node
+  bool numa_placed() const { return numa_placed_; }
+
+  std::size_t bytes_reserved() const { return reserved_; }
+  std::size_t bytes_committed() const { return committed_; }
+  std::size_t bytes_allocated() const { return current_; }
+
+  /// @return  the NUMA node of the CPU the calling thread runs on, or
+  ///          MappedResourceOptions::kAnyNode if unknown
+  static int CurrentNumaNode();
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* pointer, std::size_t bytes,
+                     std::size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  // Allocation preceded by alignment padding
+  struct Padding {
+    // offset of the allocation
+    std::size_t aligned;
+    // offset before the padding, where deallocating it rewinds to
+    std::size_t previous;
+  };
+
+  // The paddings of the newest kMaxPaddings padded allocations are kept;
+  // deallocating an older padded one only rewinds to its start
+  static constexpr std::size_t kMaxPaddings = 32u;
+
+  // Commits the reserved memory up to at least @p end bytes
+  void Commit(std::size_t end);
+
+  Padding& padding(std::size_t index) {
+    return paddings_[index % kMaxPaddings];
+  }
+
+  MappedResourceOptions options_;
+  HugePages huge_pages_;
+  bool numa_placed_;
+  char* base_;
+  std::size_t reserved_;
+  std::size_t committed_;
+  std::size_t current_;
+  // ring of the paddings below current_, newest at paddings_end_ - 1
+  Padding paddings_[kMaxPaddings];
+  std::size_t paddings_begin_;
+  std::size_t paddings_end_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_MAPPED_RESOURCE_H_
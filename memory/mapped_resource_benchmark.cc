@@ -0,0 +1,40 @@
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "common/memory/arena.h"
+#include "common/memory/mapped_resource.h"
+
+namespace common {
+namespace {
+
+// Random lookups in a table far larger than the TLB reach of base pages
+constexpr std::size_t kTableSize = std::size_t{512} << 20;
+constexpr std::size_t kEntries = kTableSize / sizeof(std::uint64_t);
+
+void BM_RandomLookups(benchmark::State& state) {
+  MappedResourceOptions options;
+  options.reserve_size = kTableSize + (std::size_t{8} << 20);
+  options.huge_pages = static_cast<HugePages>(state.range(0));
+  options.prefault = true;
+  MappedResource resource(options);
+  Arena arena(kTableSize, &resource);
+  std::uint64_t* table = arena.AllocateArray<std::uint64_t>(kEntries);
+  // a full period linear congruential walk over the table, in which each
+  // lookup depends on the previous one
+  for (std::size_t i = 0u; i < kEntries; ++i) {
+    table[i] = (i * 6364136223846793005u + 1442695040888963407u) % kEntries;
+  }
+  std::uint64_t index = 0u;
+  for (auto _ : state) {
+    index = table[index];
+    benchmark::DoNotOptimize(index);
+  }
+  state.SetLabel(resource.huge_pages() == HugePages::kNone ? "base pages"
+                                                           : "huge pages");
+}
+BENCHMARK(BM_RandomLookups)
+    ->Arg(static_cast<int>(HugePages::kNone))
+    ->Arg(static_cast<int>(HugePages::kTransparent));
+
+}  // namespace
+}  // namespace common
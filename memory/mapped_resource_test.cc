@@ -0,0 +1,129 @@
+#include "common/memory/mapped_resource.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "common/memory/arena.h"
+#include "gtest/gtest.h"
+
+namespace common {
+namespace {
+
+constexpr std::size_t kMiB = std::size_t{1} << 20;
+
+bool IsAligned(const void* pointer, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0u;
+}
+
+MappedResourceOptions SmallOptions(HugePages huge_pages) {
+  MappedResourceOptions options;
+  options.reserve_size = 16u * kMiB;
+  options.huge_pages = huge_pages;
+  return options;
+}
+
+}  // namespace
+
+TEST(MappedResourceTest, AllocateTest) {
+  MappedResource resource(SmallOptions(HugePages::kNone));
+  EXPECT_EQ(resource.huge_pages(), HugePages::kNone);
+  EXPECT_EQ(resource.bytes_reserved(), 16u * kMiB);
+  EXPECT_EQ(resource.bytes_committed(), 0u);
+
+  char* first = static_cast<char*>(resource.allocate(100u, 8u));
+  EXPECT_TRUE(IsAligned(first, MappedResource::kHugePageSize));
+  std::memset(first, 1, 100u);
+  EXPECT_EQ(resource.bytes_committed(), MappedResource::kHugePageSize);
+
+  // memory is committed as the allocations reach it
+  char* second = static_cast<char*>(resource.allocate(3u * kMiB, 4096u));
+  EXPECT_TRUE(IsAligned(second, 4096u));
+  second[3u * kMiB - 1u] = 2;
+  EXPECT_EQ(resource.bytes_committed(), 4u * kMiB);
+
+  // the newest allocation can be given back
+  resource.deallocate(second, 3u * kMiB, 4096u);
+  EXPECT_EQ(resource.allocate(3u * kMiB, 4096u), second);
+  resource.deallocate(first, 100u, 8u);
+  EXPECT_EQ(resource.bytes_allocated(), 4096u + 3u * kMiB);
+
+  EXPECT_THROW(static_cast<void>(resource.allocate(16u * kMiB, 8u)),
+               std::bad_alloc);
+  resource.Release();
+  EXPECT_EQ(resource.allocate(16u * kMiB, 8u), first);
+  first[16u * kMiB - 1u] = 3;
+  EXPECT_EQ(resource.bytes_committed(), 16u * kMiB);
+}
+
+TEST(MappedResourceTest, ArenaTest) {
+  MappedResource resource(SmallOptions(HugePages::kTransparent));
+  Arena arena(MappedResource::kHugePageSize, &resource);
+  std::string* text =
+      arena.Create<std::string>("a string long enough to allocate itself");
+  std::uint64_t* table = arena.AllocateArray<std::uint64_t>(100000u);
+  for (std::uint64_t i = 0u; i < 100000u; ++i) {
+    table[i] = i * i;
+  }
+  EXPECT_EQ(table[99999], std::uint64_t{99999} * 99999u);
+  EXPECT_EQ(text->size(), 39u);
+  EXPECT_GT(resource.bytes_allocated(), 0u);
+
+  // the arena returns its blocks newest first, so they are reused
+  arena.Reset();
+  EXPECT_EQ(resource.bytes_allocated(), 0u);
+}
+
+TEST(MappedResourceTest, PaddingTest) {
+  MappedResource resource(SmallOptions(HugePages::kNone));
+  void* first = resource.allocate(100u, 8u);
+  void* second = resource.allocate(10u, 4096u);
+  void* third = resource.allocate(1u, 64u);
+  resource.deallocate(third, 1u, 64u);
+  resource.deallocate(second, 10u, 4096u);
+  EXPECT_EQ(resource.bytes_allocated(), 100u);
+  resource.deallocate(first, 100u, 8u);
+  EXPECT_EQ(resource.bytes_allocated(), 0u);
+}
+
+TEST(MappedResourceTest, ArenaResetTest) {
+  MappedResource resource(SmallOptions(HugePages::kNone));
+  Arena arena(Arena::kDefaultBlockSize, &resource);
+  // the 70000 byte request gets a block of its own, whose size is not a
+  // multiple of the alignment of the next block
+  for (int cycle = 0; cycle < 1000; ++cycle) {
+    arena.Allocate(5000u, 8u);
+    arena.Allocate(70000u, 64u);
+    arena.Allocate(100u, 8u);
+    EXPECT_GT(resource.bytes_allocated(), 75000u);
+    arena.Reset();
+    ASSERT_EQ(resource.bytes_allocated(), 0u);
+  }
+}
+
+TEST(MappedResourceTest, FallbackTest) {
+  // the hugetlb pool is usually empty, which must not be an error
+  MappedResource resource(SmallOptions(HugePages::kExplicit));
+  char* memory = static_cast<char*>(resource.allocate(5u * kMiB, 64u));
+  memory[0] = 1;
+  memory[5u * kMiB - 1u] = 1;
+  EXPECT_EQ(resource.bytes_committed(), 6u * kMiB);
+}
+
+TEST(MappedResourceTest, NumaPrefaultTest) {
+  MappedResourceOptions options = SmallOptions(HugePages::kTransparent);
+  options.numa_node = MappedResource::CurrentNumaNode();
+  options.prefault = true;
+  options.commit_size = 4u * kMiB;
+  MappedResource resource(options);
+  EXPECT_GE(options.numa_node, MappedResourceOptions::kAnyNode);
+  if (options.numa_node == MappedResourceOptions::kAnyNode) {
+    EXPECT_FALSE(resource.numa_placed());
+  }
+  char* memory = static_cast<char*>(resource.allocate(kMiB, 8u));
+  EXPECT_EQ(resource.bytes_committed(), 4u * kMiB);
+  memory[kMiB - 1u] = 1;
+}
+
+}  // namespace common
@@ -0,0 +1,198 @@
+#include "common/memory/memory_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+namespace common {
+
+namespace {
+
+using Counter = std::atomic<std::uint64_t>;
+
+struct TagCounters {
+  Counter allocated_bytes;
+  Counter freed_bytes;
+  Counter allocations;
+  Counter deallocations;
+  // change to the live bytes not yet added to g_published, owner only
+  std::int64_t unpublished;
+};
+
+// Counters of one thread. Only the owning thread writes, so increments are a
+// relaxed load and store rather than a locked read-modify-write.
+struct alignas(64) CounterBlock {
+  TagCounters tags[MemoryMetrics::kMaxTags];
+  std::atomic<bool> in_use;
+  CounterBlock* next;
+};
+
+// blocks are never freed, a block released by an exiting thread is reused
+std::atomic<CounterBlock*> g_blocks{nullptr};
+
+// Live bytes per tag as published by the threads, and their maximum
+std::atomic<std::int64_t> g_published[MemoryMetrics::kMaxTags];
+std::atomic<std::int64_t> g_peak[MemoryMetrics::kMaxTags];
+
+std::mutex g_tags_mutex;
+// indexed by the tags built into MemoryMetrics, keep in the same order
+std::string g_tag_names[MemoryMetrics::kMaxTags] = {"other", "ref_counted",
+                                                    "error"};
+std::size_t g_num_tags = 3u;
+
+CounterBlock* AcquireBlock() {
+  for (CounterBlock* block = g_blocks.load(std::memory_order_acquire);
+       block != nullptr; block = block->next) {
+    bool expected = false;
+    if (block->in_use.compare_exchange_strong(expected, true,
+                                              std::memory_order_acquire)) {
+      return block;
+    }
+  }
+  CounterBlock* block = new CounterBlock();
+  block->in_use.store(true, std::memory_order_relaxed);
+  block->next = g_blocks.load(std::memory_order_relaxed);
+  while (!g_blocks.compare_exchange_weak(block->next, block,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+  return block;
+}
+
+void Publish(MemoryTag tag, TagCounters* counters) {
+  const std::int64_t live =
+      g_published[tag].fetch_add(counters->unpublished,
+                                 std::memory_order_relaxed) +
+      counters->unpublished;
+  counters->unpublished = 0;
+  std::int64_t peak = g_peak[tag].load(std::memory_order_relaxed);
+  while (live > peak && !g_peak[tag].compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+class ThreadCounters {
+ public:
+  ~ThreadCounters() {
+    if (block_ != nullptr) {
+      for (MemoryTag tag = 0u; tag < MemoryMetrics::kMaxTags; ++tag) {
+        if (block_->tags[tag].unpublished != 0) {
+          Publish(tag, &block_->tags[tag]);
+        }
+      }
+      block_->in_use.store(false, std::memory_order_release);
+    }
+  }
+
+  TagCounters* tag(MemoryTag tag) {
+    if (block_ == nullptr) {
+      block_ = AcquireBlock();
+    }
+    return &block_->tags[tag < MemoryMetrics::kMaxTags
+                             ? tag
+                             : MemoryMetrics::kOtherTag];
+  }
+
+ private:
+  CounterBlock* block_ = nullptr;
+};
+
+thread_local ThreadCounters t_counters;
+
+void Bump(Counter* counter, std::uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+void AppendLine(const char* metric, const std::string& tag,
+                const std::string& value, std::string* text) {
+  *text += metric;
+  *text += "{tag=\"";
+  *text += tag;
+  *text += "\"} ";
+  *text += value;
+  *text += '\n';
+}
+
+}  // namespace
+
+MemoryTag MemoryMetrics::RegisterTag(std::string_view name) {
+  std::lock_guard<std::mutex> lock(g_tags_mutex);
+  for (MemoryTag tag = 0u; tag < g_num_tags; ++tag) {
+    if (g_tag_names[tag] == name) {
+      return tag;
+    }
+  }
+  if (g_num_tags == kMaxTags) {
+    return kOtherTag;
+  }
+  g_tag_names[g_num_tags] = std::string(name);
+  return g_num_tags++;
+}
+
+void MemoryMetrics::RecordAllocation(MemoryTag tag, std::size_t bytes) {
+  TagCounters* counters = t_counters.tag(tag);
+  Bump(&counters->allocated_bytes, bytes);
+  Bump(&counters->allocations, 1u);
+  counters->unpublished += static_cast<std::int64_t>(bytes);
+  if (counters->unpublished > kPublishBytes) {
+    Publish(tag < kMaxTags ? tag : kOtherTag, counters);
+  }
+}
+
+void MemoryMetrics::RecordDeallocation(MemoryTag tag, std::size_t bytes) {
+  TagCounters* counters = t_counters.tag(tag);
+  Bump(&counters->freed_bytes, bytes);
+  Bump(&counters->deallocations, 1u);
+  counters->unpublished -= static_cast<std::int64_t>(bytes);
+  if (counters->unpublished < -kPublishBytes) {
+    Publish(tag < kMaxTags ? tag : kOtherTag, counters);
+  }
+}
+
+std::vector<MemoryMetrics::Entry> MemoryMetrics::Snapshot() {
+  std::vector<Entry> entries;
+  std::lock_guard<std::mutex> lock(g_tags_mutex);
+  for (MemoryTag tag = 0u; tag < g_num_tags; ++tag) {
+    std::uint64_t allocated_bytes = 0u;
+    std::uint64_t freed_bytes = 0u;
+    Entry entry{g_tag_names[tag], 0, 0, 0u, 0u};
+    for (CounterBlock* block = g_blocks.load(std::memory_order_acquire);
+         block != nullptr; block = block->next) {
+      const TagCounters& counters = block->tags[tag];
+      allocated_bytes +=
+          counters.allocated_bytes.load(std::memory_order_relaxed);
+      freed_bytes += counters.freed_bytes.load(std::memory_order_relaxed);
+      entry.allocations +=
+          counters.allocations.load(std::memory_order_relaxed);
+      entry.deallocations +=
+          counters.deallocations.load(std::memory_order_relaxed);
+    }
+    if (entry.allocations == 0u && entry.deallocations == 0u) {
+      continue;
+    }
+    entry.bytes = static_cast<std::int64_t>(allocated_bytes - freed_bytes);
+    entry.peak_bytes =
+        std::max(entry.bytes, g_peak[tag].load(std::memory_order_relaxed));
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+std::string MemoryMetrics::ExportText() {
+  std::string text;
+  for (const Entry& entry : Snapshot()) {
+    AppendLine("memory_bytes", entry.name, std::to_string(entry.bytes),
+               &text);
+    AppendLine("memory_peak_bytes", entry.name,
+               std::to_string(entry.peak_bytes), &text);
+    AppendLine("memory_allocations_total", entry.name,
+               std::to_string(entry.allocations), &text);
+    AppendLine("memory_deallocations_total", entry.name,
+               std::to_string(entry.deallocations), &text);
+  }
+  return text;
+}
+
+}  // namespace common
@@ -0,0 +1,90 @@
+#ifndef COMMON_MEMORY_METRICS_H_
+#define COMMON_MEMORY_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace common {
+
+/// Index of a tag registered with MemoryMetrics::RegisterTag()
+using MemoryTag = std::size_t;
+
+/// @class MemoryMetrics
+/// Memory accounting per user-defined tag, e.g. one tag per subsystem.
+/// Counts live bytes, a high-water mark and the number of allocations and
+/// deallocations. Recording is lock-free: each thread bumps its own
+/// cache-line aligned counter block and Snapshot() sums the blocks.
+///
+/// Allocations are recorded by TrackingResource, which plugs in wherever a
+/// std::pmr::memory_resource is taken, e.g. as the upstream of an Arena or
+/// ObjectPool, and by the memory utilities that allocate on their own
+/// through TrackAllocation(). When built without COMMON_MEMORY_TRACKING
+/// (bazel build --define memory_tracking=true) TrackingResource hands out
+/// its upstream instead and TrackAllocation() does nothing, so that only
+/// explicit Record calls are counted.
+class MemoryMetrics {
+ public:
+  /// Tags beyond this many are counted under kOtherTag
+  constexpr static std::size_t kMaxTags = 64u;
+  /// Allocations of unknown origin and registrations beyond kMaxTags
+  constexpr static MemoryTag kOtherTag = 0u;
+  /// Control blocks of RefCounted and WeakRefCounted, "ref_counted"
+  constexpr static MemoryTag kRefCountedTag = 1u;
+  /// ErrorWithExplanation explanations copied to the heap, "error"
+  constexpr static MemoryTag kErrorTag = 2u;
+  /// Each thread publishes its changes to the live bytes for the high-water
+  /// mark once they add up to this many bytes, so the mark can miss a peak
+  /// by up to this much per thread
+  constexpr static std::int64_t kPublishBytes = 64 * 1024;
+
+  struct Entry {
+    std::string name;
+    // may be negative for a tag whose memory is freed under another tag
+    std::int64_t bytes;
+    std::int64_t peak_bytes;
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+  };
+
+  /// @return  the tag named @p name, registered on first use, or kOtherTag
+  ///          once kMaxTags tags are registered
+  static MemoryTag RegisterTag(std::string_view name);
+
+  static void RecordAllocation(MemoryTag tag, std::size_t bytes);
+  static void RecordDeallocation(MemoryTag tag, std::size_t bytes);
+
+  /// @return  the counters of every tag with recorded allocations, summed
+  ///          over threads, in the order the tags were registered
+  static std::vector<Entry> Snapshot();
+
+  /// @return  four lines per Snapshot() entry in the form
+  /// memory_bytes{tag="..."} bytes
+  /// memory_peak_bytes{tag="..."} peak_bytes
+  /// memory_allocations_total{tag="..."} allocations
+  /// memory_deallocations_total{tag="..."} deallocations
+  static std::string ExportText();
+};
+
+/// Records an allocation made outside of a TrackingResource, only when
+/// built with COMMON_MEMORY_TRACKING
+inline void TrackAllocation([[maybe_unused]] MemoryTag tag,
+                            [[maybe_unused]] std::size_t bytes) {
+#ifdef COMMON_MEMORY_TRACKING
+  MemoryMetrics::RecordAllocation(tag, bytes);
+#endif
+}
+
+/// Records the release of an allocation recorded by TrackAllocation()
+inline void TrackDeallocation([[maybe_unused]] MemoryTag tag,
+                              [[maybe_unused]] std::size_t bytes) {
+#ifdef COMMON_MEMORY_TRACKING
+  MemoryMetrics::RecordDeallocation(tag, bytes);
+#endif
+}
+
+}  // namespace common
+
+#endif  // COMMON_MEMORY_METRICS_H_
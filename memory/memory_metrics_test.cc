@@ -0,0 +1,100 @@
+#include "common/memory/memory_metrics.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+
+namespace {
+
+MemoryMetrics::Entry EntryFor(const std::string& name) {
+  for (const MemoryMetrics::Entry& entry : MemoryMetrics::Snapshot()) {
+    if (entry.name == name) {
+      return entry;
+    }
+  }
+  return MemoryMetrics::Entry{name, 0, 0, 0u, 0u};
+}
+
+}  // namespace
+
+TEST(MemoryMetricsTest, RegisterTagTest) {
+  const MemoryTag tag = MemoryMetrics::RegisterTag("register_tag_test");
+  EXPECT_NE(tag, MemoryMetrics::kOtherTag);
+  EXPECT_EQ(MemoryMetrics::RegisterTag("register_tag_test"), tag);
+  EXPECT_NE(MemoryMetrics::RegisterTag("register_tag_test_2"), tag);
+  EXPECT_EQ(MemoryMetrics::RegisterTag("other"), MemoryMetrics::kOtherTag);
+}
+
+TEST(MemoryMetricsTest, RecordSnapshotTest) {
+  const MemoryTag tag = MemoryMetrics::RegisterTag("record_snapshot_test");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([tag] {
+      for (int j = 0; j < 1000; ++j) {
+        MemoryMetrics::RecordAllocation(tag, 100u);
+      }
+      for (int j = 0; j < 500; ++j) {
+        MemoryMetrics::RecordDeallocation(tag, 100u);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  const MemoryMetrics::Entry entry = EntryFor("record_snapshot_test");
+  EXPECT_EQ(entry.bytes, 4 * 500 * 100);
+  EXPECT_EQ(entry.allocations, 4000u);
+  EXPECT_EQ(entry.deallocations, 2000u);
+  // each thread held 100000 bytes at most, published in steps of at most
+  // kPublishBytes
+  EXPECT_GE(entry.peak_bytes, 100000 - MemoryMetrics::kPublishBytes);
+  EXPECT_LE(entry.peak_bytes, 4 * 100000);
+
+  // unused tags are left out
+  MemoryMetrics::RegisterTag("unused_tag");
+  EXPECT_EQ(EntryFor("unused_tag").allocations, 0u);
+}
+
+TEST(MemoryMetricsTest, PeakTest) {
+  const MemoryTag tag = MemoryMetrics::RegisterTag("peak_test");
+  MemoryMetrics::RecordAllocation(tag, 1u << 20);
+  MemoryMetrics::RecordDeallocation(tag, 1u << 20);
+  MemoryMetrics::RecordAllocation(tag, 10u);
+  const MemoryMetrics::Entry entry = EntryFor("peak_test");
+  EXPECT_EQ(entry.bytes, 10);
+  EXPECT_EQ(entry.peak_bytes, 1 << 20);
+}
+
+TEST(MemoryMetricsTest, ExportTextTest) {
+  const MemoryTag tag = MemoryMetrics::RegisterTag("export_text_test");
+  MemoryMetrics::RecordAllocation(tag, 64u);
+  const std::string text = MemoryMetrics::ExportText();
+  EXPECT_NE(text.find("memory_bytes{tag=\"export_text_test\"} 64\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("memory_peak_bytes{tag=\"export_text_test\"} 64\n"),
+            std::string::npos);
+  EXPECT_NE(
+      text.find("memory_allocations_total{tag=\"export_text_test\"} 1\n"),
+      std::string::npos);
+  EXPECT_NE(
+      text.find("memory_deallocations_total{tag=\"export_text_test\"} 0\n"),
+      std::string::npos);
+}
+
+// Runs last, it fills the tag table
+TEST(MemoryMetricsTest, TagOverflowTest) {
+  for (std::size_t i = 0u; i < MemoryMetrics::kMaxTags; ++i) {
+    MemoryMetrics::RegisterTag("overflow_" + std::to_string(i));
+  }
+  const MemoryTag overflow = MemoryMetrics::RegisterTag("one_too_many");
+  EXPECT_EQ(overflow, MemoryMetrics::kOtherTag);
+  MemoryMetrics::RecordAllocation(overflow, 8u);
+  MemoryMetrics::RecordAllocation(MemoryMetrics::kMaxTags + 5u, 8u);
+  EXPECT_GE(EntryFor("other").allocations, 2u);
+}
+
+}  // namespace common
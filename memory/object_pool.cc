@@ -0,0 +1,192 @@
+#include "common/memory/object_pool.h"
+
+#include <atomic>
+#include <unordered_map>
+
+namespace common {
+namespace internal {
+
+namespace {
+
+std::atomic<std::uint64_t> next_pool_id{1u};
+
+// Live pools by id, for threads returning their caches on exit. Only
+// touched when a thread first uses a pool, on thread exit and when a pool
+// is destroyed.
+std::mutex& LivePoolsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::uint64_t, FixedSizePool*>& LivePools() {
+  static std::unordered_map<std::uint64_t, FixedSizePool*> pools;
+  return pools;
+}
+
+}  // namespace
+
+// Caches of every pool the thread has used
+struct ThreadCaches {
+  struct Entry {
+    std::uint64_t pool_id;
+    PoolThreadCache* cache;
+  };
+
+  ~ThreadCaches() {
+    last_pool_id = 0u;
+    last_pool_cache = nullptr;
+    std::lock_guard<std::mutex> lock(LivePoolsMutex());
+    for (const Entry& entry : entries) {
+      const auto pool = LivePools().find(entry.pool_id);
+      if (pool != LivePools().end()) {
+        pool->second->ReleaseCache(entry.cache);
+      }
+    }
+  }
+
+  // Drops the entries of destroyed pools
+  void Prune() {
+    std::lock_guard<std::mutex> lock(LivePoolsMutex());
+    std::size_t kept = 0u;
+    for (const Entry& entry : entries) {
+      if (LivePools().count(entry.pool_id) != 0u) {
+        entries[kept++] = entry;
+      }
+    }
+    entries.resize(kept);
+  }
+
+  std::vector<Entry> entries;
+};
+
+namespace {
+
+thread_local ThreadCaches thread_caches;
+
+}  // namespace
+
+FixedSizePool::FixedSizePool(std::size_t slot_size, std::size_t alignment,
+                             std::size_t slab_size, std::size_t batch_size,
+                             std::pmr::memory_resource* upstream)
+    : id_(next_pool_id.fetch_add(1u, std::memory_order_relaxed)),
+      slot_size_(slot_size),
+      alignment_(alignment),
+      slab_size_(slab_size),
+      batch_size_(batch_size),
+      upstream_(upstream),
+      depot_(nullptr),
+      slabs_(nullptr),
+      slab_count_(0u),
+      carve_current_(nullptr),
+      carve_end_(nullptr) {
+  std::lock_guard<std::mutex> lock(LivePoolsMutex());
+  LivePools().emplace(id_, this);
+}
+
+FixedSizePool::~FixedSizePool() {
+  {
+    std::lock_guard<std::mutex> lock(LivePoolsMutex());
+    LivePools().erase(id_);
+  }
+  while (slabs_ != nullptr) {
+    Slab* slab = slabs_;
+    slabs_ = slab->next;
+    upstream_->deallocate(slab, slab_size_, slab_size_);
+  }
+}
+
+std::size_t FixedSizePool::slab_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slab_count_;
+}
+
+PoolThreadCache* FixedSizePool::LocalCacheSlow() {
+  PoolThreadCache* cache = nullptr;
+  for (const ThreadCaches::Entry& entry : thread_caches.entries) {
+    if (entry.pool_id == id_) {
+      cache = entry.cache;
+      break;
+    }
+  }
+  if (cache == nullptr) {
+    thread_caches.Prune();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_caches_.empty()) {
+        cache = free_caches_.back();
+        free_caches_.pop_back();
+      } else {
+        caches_.push_back(std::make_unique<PoolThreadCache>());
+        cache = caches_.back().get();
+      }
+    }
+    thread_caches.entries.push_back({id_, cache});
+  }
+  last_pool_id = id_;
+  last_pool_cache = cache;
+  return cache;
+}
+
+void* FixedSizePool::AllocateSlow(PoolThreadCache* cache) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (depot_ != nullptr) {
+      cache->head = depot_;
+      depot_ = depot_->next_batch;
+      cache->count = batch_size_;
+    } else {
+      // carve a batch, the only place that allocates memory
+      FreeObject* head = nullptr;
+      for (std::size_t i = 0u; i < batch_size_; ++i) {
+        if (carve_current_ == carve_end_) {
+          Slab* slab =
+              static_cast<Slab*>(upstream_->allocate(slab_size_, slab_size_));
+          slab->pool = this;
+          slab->next = slabs_;
+          slabs_ = slab;
+          ++slab_count_;
+          char* const begin = reinterpret_cast<char*>(slab);
+          carve_current_ =
+              begin + ((sizeof(Slab) + alignment_ - 1u) & ~(alignment_ - 1u));
+          carve_end_ = carve_current_ +
+                       (begin + slab_size_ - carve_current_) / slot_size_ *
+                           slot_size_;
+        }
+        FreeObject* object = reinterpret_cast<FreeObject*>(carve_current_);
+        carve_current_ += slot_size_;
+        object->next = head;
+        head = object;
+      }
+      cache->head = head;
+      cache->count = batch_size_;
+    }
+  }
+  FreeObject* object = cache->head;
+  cache->head = object->next;
+  --cache->count;
+  return object;
+}
+
+void FixedSizePool::Flush(PoolThreadCache* cache) {
+  // detach the newest batch_size_ objects outside of the lock
+  FreeObject* batch = cache->head;
+  FreeObject* last = batch;
+  for (std::size_t i = 1u; i < batch_size_; ++i) {
+    last = last->next;
+  }
+  cache->head = last->next;
+  cache->count -= batch_size_;
+  last->next = nullptr;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  batch->next_batch = depot_;
+  depot_ = batch;
+}
+
+void FixedSizePool::ReleaseCache(PoolThreadCache* cache) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  free_caches_.push_back(cache);
+}
+
+}  // namespace internal
+}  // namespace common
@@ -0,0 +1,221 @@
+#ifndef COMMON_OBJECT_POOL_H_
+#define COMMON_OBJECT_POOL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/memory/placement_new.h"
+#include "common/memory/ref_counted.h"
+
+namespace common {
+
+namespace internal {
+
+// Link fields written over a free object. Batches in the depot are chained
+// through the first object of each batch.
+struct FreeObject {
+  FreeObject* next;
+  FreeObject* next_batch;
+};
+
+// Free list of one thread for one pool, only touched by that thread
+struct alignas(64) PoolThreadCache {
+  FreeObject* head = nullptr;
+  std::size_t count = 0u;
+};
+
+// The cache used last by this thread, to skip the lookup in the common case
+// of one pool being used many times in a row. Pool ids are never reused.
+inline thread_local std::uint64_t last_pool_id = 0u;
+inline thread_local PoolThreadCache* last_pool_cache = nullptr;
+
+constexpr std::size_t kPoolPageSize = 4096u;
+
+// Smallest power of two, at least a page, holding the slab header and
+// eight slots of @p slot_size bytes aligned to @p alignment
+constexpr std::size_t PoolSlabSize(std::size_t slot_size,
+                                   std::size_t alignment) {
+  const std::size_t header = (2u * sizeof(void*) + alignment - 1u) &
+                             ~(alignment - 1u);
+  std::size_t size = kPoolPageSize;
+  while (size < header + 8u * slot_size) {
+    size *= 2u;
+  }
+  return size;
+}
+
+// Untyped part of ObjectPool. Objects are carved from slabs aligned to their
+// own size, whose header points back to the pool, so that a pointer to an
+// object is enough to find its pool. Allocation pops from the free list of
+// the calling thread; a thread whose list is empty takes a batch from the
+// depot under the mutex, or carves one from a slab, and a thread whose list
+// holds two batches moves one to the depot.
+class FixedSizePool {
+ public:
+  FixedSizePool(std::size_t slot_size, std::size_t alignment,
+                std::size_t slab_size, std::size_t batch_size,
+                std::pmr::memory_resource* upstream);
+  ~FixedSizePool();
+
+  FixedSizePool(const FixedSizePool&) = delete;
+  FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+  void* Allocate() {
+    PoolThreadCache* cache = LocalCache();
+    FreeObject* object = cache->head;
+    if (object == nullptr) {
+      return AllocateSlow(cache);
+    }
+    cache->head = object->next;
+    --cache->count;
+    return object;
+  }
+
+  void Deallocate(void* pointer) {
+    PoolThreadCache* cache = LocalCache();
+    FreeObject* object = static_cast<FreeObject*>(pointer);
+    object->next = cache->head;
+    cache->head = object;
+    if (++cache->count >= 2u * batch_size_) {
+      Flush(cache);
+    }
+  }
+
+  /// @return  the pool owning @p object, allocated from slabs of
+  ///          @p slab_size bytes
+  static FixedSizePool* Owner(const void* object, std::size_t slab_size) {
+    const std::uintptr_t slab =
+        reinterpret_cast<std::uintptr_t>(object) & ~(slab_size - 1u);
+    return reinterpret_cast<const Slab*>(slab)->pool;
+  }
+
+  std::size_t slab_count() const;
+
+ private:
+  friend struct ThreadCaches;
+
+  struct Slab {
+    FixedSizePool* pool;
+    Slab* next;
+  };
+
+  PoolThreadCache* LocalCache() {
+    if (last_pool_id == id_) {
+      return last_pool_cache;
+    }
+    return LocalCacheSlow();
+  }
+
+  PoolThreadCache* LocalCacheSlow();
+  void* AllocateSlow(PoolThreadCache* cache);
+  void Flush(PoolThreadCache* cache);
+  // Called on thread exit, hands @p cache with its objects to the next
+  // thread using the pool
+  void ReleaseCache(PoolThreadCache* cache);
+
+  const std::uint64_t id_;
+  const std::size_t slot_size_;
+  const std::size_t alignment_;
+  const std::size_t slab_size_;
+  const std::size_t batch_size_;
+  std::pmr::memory_resource* const upstream_;
+
+  mutable std::mutex mutex_;
+  FreeObject* depot_;
+  Slab* slabs_;
+  std::size_t slab_count_;
+  char* carve_current_;
+  char* carve_end_;
+  std::vector<std::unique_ptr<PoolThreadCache>> caches_;
+  std::vector<PoolThreadCache*> free_caches_;
+};
+
+}  // namespace internal
+
+/// @class ObjectPool
+/// Pool of objects of type T for types created and destroyed at high rates,
+/// e.g. messages or tree nodes. Objects are carved from page-sized slabs and
+/// recycled through intrusive free lists: every thread has its own list per
+/// pool, so that steady state Create() and Destroy() take no lock and make
+/// no system call, and moves objects to and from a shared depot in batches
+/// of @p batch_size. Slabs come from the @p upstream resource, aligned to
+/// their size, and are only returned when the pool is destroyed.
+///
+/// Objects may be destroyed on any thread, and must all be destroyed before
+/// the pool. Deleter lets RefCounted own pooled objects.
+template <typename T>
+class ObjectPool {
+ public:
+  static constexpr std::size_t kDefaultBatchSize = 32u;
+
+  /// Releases an object to the pool it was created by
+  struct Deleter {
+    void operator()(T* object) const { ObjectPool::Destroy(object); }
+  };
+
+  template <typename Counter = ThreadUnsafeRefControl>
+  using Ref = RefCounted<T, Counter, Deleter>;
+
+  explicit ObjectPool(
+      std::size_t batch_size = kDefaultBatchSize,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : pool_(kSlotSize, kAlignment, kSlabSize,
+              std::max<std::size_t>(batch_size, 1u), upstream) {}
+
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  /// Constructs a T from @p args with Construct(). If the constructor
+  /// throws, the memory goes back to the pool.
+  template <typename... Args>
+  T* Create(Args&&... args) {
+    void* memory = pool_.Allocate();
+    try {
+      return Construct<T>(memory, std::forward<Args>(args)...);
+    } catch (...) {
+      pool_.Deallocate(memory);
+      throw;
+    }
+  }
+
+  /// Creates a T owned by a RefCounted, which returns it to the pool
+  template <typename Counter = ThreadUnsafeRefControl, typename... Args>
+  Ref<Counter> CreateRef(Args&&... args) {
+    return Ref<Counter>(Create(std::forward<Args>(args)...));
+  }
+
+  /// Destroys @p object, created by any ObjectPool<T>, and returns its
+  /// memory to that pool. Accepts nullptr.
+  static void Destroy(T* object) {
+    if (object != nullptr) {
+      object->~T();
+      internal::FixedSizePool::Owner(object, kSlabSize)->Deallocate(object);
+    }
+  }
+
+  /// @return  the slabs allocated so far, each of slab_size() bytes
+  std::size_t slab_count() const { return pool_.slab_count(); }
+
+  static constexpr std::size_t slab_size() { return kSlabSize; }
+
+ private:
+  static constexpr std::size_t kAlignment =
+      std::max(alignof(T), alignof(internal::FreeObject));
+  static constexpr std::size_t kSlotSize =
+      (std::max(sizeof(T), sizeof(internal::FreeObject)) + kAlignment - 1u) &
+      ~(kAlignment - 1u);
+  static constexpr std::size_t kSlabSize =
+      internal::PoolSlabSize(kSlotSize, kAlignment);
+
+  internal::FixedSizePool pool_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_OBJECT_POOL_H_
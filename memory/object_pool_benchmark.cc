@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/memory/object_pool.h"
+
+namespace common {
+namespace {
+
+// A message sized object, created and destroyed in bursts of kBurst
+struct Node {
+  explicit Node(std::uint64_t key) : key(key), left(nullptr), right(nullptr) {}
+
+  std::uint64_t key;
+  Node* left;
+  Node* right;
+  std::uint64_t payload[5];
+};
+
+constexpr int kBurst = 256;
+
+void BM_NewDelete(benchmark::State& state) {
+  std::vector<Node*> nodes(kBurst);
+  for (auto _ : state) {
+    for (int i = 0; i < kBurst; ++i) {
+      nodes[i] = new Node(i);
+    }
+    benchmark::ClobberMemory();
+    for (int i = 0; i < kBurst; ++i) {
+      delete nodes[i];
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kBurst);
+}
+BENCHMARK(BM_NewDelete)->ThreadRange(1, 4);
+
+void BM_ObjectPool(benchmark::State& state) {
+  static ObjectPool<Node> pool;
+  std::vector<Node*> nodes(kBurst);
+  for (auto _ : state) {
+    for (int i = 0; i < kBurst; ++i) {
+      nodes[i] = pool.Create(i);
+    }
+    benchmark::ClobberMemory();
+    for (int i = 0; i < kBurst; ++i) {
+      ObjectPool<Node>::Destroy(nodes[i]);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kBurst);
+}
+BENCHMARK(BM_ObjectPool)->ThreadRange(1, 4);
+
+}  // namespace
+}  // namespace common
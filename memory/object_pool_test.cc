@@ -0,0 +1,189 @@
+#include "common/memory/object_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+namespace {
+
+// Counts live objects and throws when constructed from a negative value
+class Message {
+ public:
+  static std::atomic<int> live;
+
+  explicit Message(int id) : id_(id), text_(std::to_string(id)) {
+    if (id < 0) {
+      throw std::invalid_argument("negative id");
+    }
+    ++live;
+  }
+  ~Message() { --live; }
+
+  int id() const { return id_; }
+  const std::string& text() const { return text_; }
+
+ private:
+  int id_;
+  std::string text_;
+};
+
+std::atomic<int> Message::live{0};
+
+struct alignas(128) OverAligned {
+  char bytes[3];
+};
+
+bool IsAligned(const void* pointer, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0u;
+}
+
+}  // namespace
+
+TEST(ObjectPoolTest, CreateDestroyTest) {
+  ObjectPool<Message> pool(4u);
+  EXPECT_EQ(pool.slab_count(), 0u);
+  std::vector<Message*> messages;
+  for (int i = 0; i < 100; ++i) {
+    messages.push_back(pool.Create(i));
+  }
+  EXPECT_EQ(Message::live, 100);
+  EXPECT_EQ(std::set<Message*>(messages.begin(), messages.end()).size(),
+            100u);
+  EXPECT_EQ(messages[99]->text(), "99");
+  const std::size_t slabs = pool.slab_count();
+  EXPECT_GE(slabs * ObjectPool<Message>::slab_size(),
+            100u * sizeof(Message));
+
+  // the memory of the last object destroyed is reused first
+  Message* last = messages.back();
+  ObjectPool<Message>::Destroy(last);
+  messages.back() = pool.Create(7);
+  EXPECT_EQ(messages.back(), last);
+
+  for (Message* message : messages) {
+    ObjectPool<Message>::Destroy(message);
+  }
+  EXPECT_EQ(Message::live, 0);
+  for (int i = 0; i < 100; ++i) {
+    messages[i] = pool.Create(i);
+  }
+  EXPECT_EQ(pool.slab_count(), slabs);
+  for (Message* message : messages) {
+    ObjectPool<Message>::Destroy(message);
+  }
+  ObjectPool<Message>::Destroy(nullptr);
+}
+
+TEST(ObjectPoolTest, ThrowingConstructorTest) {
+  ObjectPool<Message> pool;
+  Message* first = pool.Create(1);
+  ObjectPool<Message>::Destroy(first);
+  EXPECT_THROW(pool.Create(-1), std::invalid_argument);
+  EXPECT_EQ(Message::live, 0);
+  // the memory went back to the pool
+  Message* second = pool.Create(2);
+  EXPECT_EQ(second, first);
+  ObjectPool<Message>::Destroy(second);
+}
+
+TEST(ObjectPoolTest, AlignmentTest) {
+  ObjectPool<OverAligned> pool;
+  std::vector<OverAligned*> objects;
+  for (int i = 0; i < 200; ++i) {
+    objects.push_back(pool.Create());
+    EXPECT_TRUE(IsAligned(objects.back(), 128u));
+  }
+  for (OverAligned* object : objects) {
+    ObjectPool<OverAligned>::Destroy(object);
+  }
+
+  ObjectPool<char> chars;
+  char* letter = chars.Create('a');
+  EXPECT_EQ(*letter, 'a');
+  ObjectPool<char>::Destroy(letter);
+}
+
+TEST(ObjectPoolTest, RefCountedTest) {
+  ObjectPool<Message> pool;
+  {
+    ObjectPool<Message>::Ref<> first = pool.CreateRef(1);
+    EXPECT_EQ(first->id(), 1);
+    ObjectPool<Message>::Ref<> copy(first);
+    EXPECT_EQ(copy.UseCount(), 2u);
+    ObjectPool<Message>::Ref<> other = pool.CreateRef(2);
+    other = std::move(copy);
+    EXPECT_EQ(Message::live, 1);
+    auto weak = first.GetWeakRef();
+    EXPECT_TRUE(weak.HasWeakRef());
+  }
+  EXPECT_EQ(Message::live, 0);
+}
+
+TEST(ObjectPoolTest, ThreadsTest) {
+  constexpr int kThreads = 4;
+  constexpr int kObjects = 2000;
+  ObjectPool<Message> pool(8u);
+  // each thread destroys the objects created by the previous one
+  std::vector<std::vector<Message*>> created(kThreads);
+  for (int thread = 0; thread < kThreads; ++thread) {
+    for (int i = 0; i < kObjects; ++i) {
+      created[thread].push_back(pool.Create(i));
+    }
+  }
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&pool, &created, thread] {
+      for (Message* message : created[(thread + 1) % kThreads]) {
+        ObjectPool<Message>::Destroy(message);
+      }
+      for (int round = 0; round < 10; ++round) {
+        std::vector<Message*> messages;
+        for (int i = 0; i < kObjects; ++i) {
+          messages.push_back(pool.Create(i));
+        }
+        for (Message* message : messages) {
+          EXPECT_EQ(message->id(), std::stoi(message->text()));
+          ObjectPool<Message>::Destroy(message);
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(Message::live, 0);
+}
+
+TEST(ObjectPoolTest, ThreadExitTest) {
+  auto pool = std::make_unique<ObjectPool<Message>>(4u);
+  // the objects cached by an exited thread are used by the next one
+  std::thread([&pool] { ObjectPool<Message>::Destroy(pool->Create(1)); })
+      .join();
+  const std::size_t slabs = pool->slab_count();
+  std::thread([&pool] {
+    for (int i = 0; i < 3; ++i) {
+      ObjectPool<Message>::Destroy(pool->Create(i));
+    }
+  }).join();
+  EXPECT_EQ(pool->slab_count(), slabs);
+
+  // a thread that outlives a pool it used exits cleanly
+  std::thread worker([&pool] {
+    ObjectPool<Message>::Destroy(pool->Create(2));
+    pool.reset();
+    ObjectPool<Message> next;
+    ObjectPool<Message>::Destroy(next.Create(3));
+  });
+  worker.join();
+  EXPECT_EQ(Message::live, 0);
+}
+
+}  // namespace common
@@ -5,9 +5,10 @@
 
 namespace common {
 
-/// Wrapper around placement new
+/// Wrapper around placement new, forwards @p args to the constructor of T
+/// without copying them
 template <typename T, typename... Args>
-T* Construct(void* memory_location, Args... args) {
+T* Construct(void* memory_location, Args&&... args) {
   return new (memory_location) T(std::forward<Args>(args)...);
 }
 
@@ -1,5 +1,9 @@
 #include "common/memory/placement_new.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "gtest/gtest.h"
 
 namespace common {
@@ -24,6 +28,25 @@ class TestClass {
   bool* destructor_;
 };
 
+struct CopyCounter {
+  CopyCounter() = default;
+  CopyCounter(const CopyCounter& other) : copies(other.copies + 1) {}
+  int copies = 0;
+};
+
+class Holder {
+ public:
+  Holder(const CopyCounter& counter, std::unique_ptr<int> pointer)
+      : copies_(counter.copies), pointer_(std::move(pointer)) {}
+
+  int copies() const { return copies_; }
+  int value() const { return *pointer_; }
+
+ private:
+  int copies_;
+  std::unique_ptr<int> pointer_;
+};
+
 }  // namespace
 
 TEST(PlacementNewTest, ConstructionTest) {
@@ -38,4 +61,19 @@ TEST(PlacementNewTest, ConstructionTest) {
   EXPECT_TRUE(destructor_called);
 }
 
+TEST(PlacementNewTest, ForwardingTest) {
+  // lvalues arrive as references and move-only arguments are moved
+  alignas(Holder) char memory[sizeof(Holder)];
+  CopyCounter counter;
+  Holder* holder = Construct<Holder>(memory, counter, std::make_unique<int>(5));
+  EXPECT_EQ(holder->copies(), 0);
+  EXPECT_EQ(holder->value(), 5);
+  holder->~Holder();
+
+  alignas(std::string) char text_memory[sizeof(std::string)];
+  std::string* text = Construct<std::string>(text_memory, 3u, 'y');
+  EXPECT_EQ(*text, "yyy");
+  text->~basic_string();
+}
+
 }  // namespace common
@@ -1,6 +1,7 @@
 #ifndef COMMON_MEMORY_REF_COUNTED_H_
 #define COMMON_MEMORY_REF_COUNTED_H_
 
+#include <memory>
 #include <type_traits>
 
 #include "common/memory/thread_unsafe_ref_control.h"
@@ -12,10 +13,16 @@ namespace common {
 /// RefCounted is reference counting based smart pointer class. Unlike
 /// std::shared_ptr the control block is a template argument and can be changed
 /// in order to get different characteristics like thread safety, counter
-/// overflow / underflow handling and debug diagnostics
+/// overflow / underflow handling and debug diagnostics. Control blocks are
+/// recorded in MemoryMetrics under kRefCountedTag when built with
+/// COMMON_MEMORY_TRACKING; managed objects are recorded when they come from
+/// a TrackingResource, e.g. as the upstream of an ObjectPool.
 /// @tparam T  object type to be managed
 /// @tparam Counter  reference counter object, default is a simple counter
-template <typename T, typename Counter = ThreadUnsafeRefControl>
+/// @tparam Deleter  stateless function object releasing the managed object,
+///                  e.g. to return it to a pool, default is delete
+template <typename T, typename Counter = ThreadUnsafeRefControl,
+          typename Deleter = std::default_delete<T>>
 class RefCounted {
  public:
   RefCounted() : RefCounted(nullptr, nullptr) {}
@@ -24,22 +31,27 @@ class RefCounted {
                             std::is_convertible<U*, T*>::value>::type>
   RefCounted(U* raw_ptr) : RefCounted(nullptr, raw_ptr) {}
 
-  template <typename U, typename = typename std::enable_if<
-                            std::is_convertible<U*, T*>::value>::type>
-  RefCounted(RefCounted<U, Counter>& other)
+  template <typename U, typename UDeleter,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value &&
+                std::is_convertible<UDeleter, Deleter>::value>::type>
+  RefCounted(RefCounted<U, Counter, UDeleter>& other)
       : RefCounted(other.control_ptr_, other.managed_) {
     if (this->managed_ != nullptr) {
       if (this->control_ptr_ != nullptr) {
         this->control_ptr_->IncrementUseCount();
       } else {
-        this->control_ptr_ = other.control_ptr_ = new Counter(2u);
+        this->control_ptr_ = other.control_ptr_ =
+            internal::NewControl<Counter>(2u);
       }
     }
   }
 
-  template <typename U, typename = typename std::enable_if<
-                            std::is_convertible<U*, T*>::value>::type>
-  RefCounted(RefCounted<U, Counter>&& other)
+  template <typename U, typename UDeleter,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value &&
+                std::is_convertible<UDeleter, Deleter>::value>::type>
+  RefCounted(RefCounted<U, Counter, UDeleter>&& other)
       : RefCounted(other.control_ptr_, other.managed_) {
     other.control_ptr_ = nullptr;
     other.managed_ = nullptr;
@@ -65,16 +77,18 @@ class RefCounted {
     DestroyManaged();
     if (control_ptr_ != nullptr) {
       if (control_ptr_->UseCount() < 2u && control_ptr_->WeakCount() < 1u) {
-        delete control_ptr_;
+        internal::DeleteControl(control_ptr_);
       } else {
         control_ptr_->DecrementUseCount();
       }
     }
   }
 
-  template <typename U, typename = typename std::enable_if<
-                            std::is_convertible<U*, T*>::value>::type>
-  RefCounted& operator=(RefCounted<U, Counter>& other) {
+  template <typename U, typename UDeleter,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value &&
+                std::is_convertible<UDeleter, Deleter>::value>::type>
+  RefCounted& operator=(RefCounted<U, Counter, UDeleter>& other) {
     DestroyManaged();
     if (other.control_ptr_ != nullptr) {
       DestroyControl();
@@ -88,9 +102,11 @@ class RefCounted {
     return *this;
   }
 
-  template <typename U, typename = typename std::enable_if<
-                            std::is_convertible<U*, T*>::value>::type>
-  RefCounted& operator=(RefCounted<U, Counter>&& other) {
+  template <typename U, typename UDeleter,
+            typename = typename std::enable_if<
+                std::is_convertible<U*, T*>::value &&
+                std::is_convertible<UDeleter, Deleter>::value>::type>
+  RefCounted& operator=(RefCounted<U, Counter, UDeleter>&& other) {
     DestroyManaged();
     if (other.control_ptr_ != nullptr) {
       DestroyControl();
@@ -119,14 +135,14 @@ class RefCounted {
 
   WeakRefCounted<T, Counter> GetWeakRef() {
     if (this->control_ptr_ == nullptr) {
-      this->control_ptr_ = new Counter(1u);
+      this->control_ptr_ = internal::NewControl<Counter>(1u);
     }
     this->control_ptr_->IncrementWeakCount();
     return WeakRefCounted(this->control_ptr_, this->managed_);
   }
 
  private:
-  template <typename U, typename UCounter>
+  template <typename U, typename UCounter, typename UDeleter>
   friend class RefCounted;
 
   RefCounted(Counter* control_ptr, T* to_manage)
@@ -135,7 +151,7 @@ class RefCounted {
   void DestroyManaged() {
     if (managed_ != nullptr &&
         (control_ptr_ == nullptr || control_ptr_->UseCount() < 2u)) {
-      delete managed_;
+      Deleter()(managed_);
       managed_ = nullptr;
     }
   }
@@ -143,7 +159,7 @@ class RefCounted {
   void DestroyControl() {
     if (control_ptr_ != nullptr && control_ptr_->WeakCount() < 1u &&
         control_ptr_->UseCount() < 2u) {
-      delete control_ptr_;
+      internal::DeleteControl(control_ptr_);
       control_ptr_ = nullptr;
     }
   }
@@ -18,6 +18,20 @@ using test_structures::CopyMovable;
 template <typename T>
 struct RefCountedTest : public testing::Test {};
 
+// Counts the objects it deletes
+template <typename T>
+struct CountingDeleter {
+  static std::size_t deleted;
+
+  void operator()(T* object) const {
+    ++deleted;
+    delete object;
+  }
+};
+
+template <typename T>
+std::size_t CountingDeleter<T>::deleted = 0u;
+
 using TestTypes =
     testing::Types<NonCopyMovable, Movable, Copyable, CopyMovable>;
 
@@ -173,4 +187,21 @@ TYPED_TEST(RefCountedTest, EndToEndTest) {
   EXPECT_EQ(weak_ref.WeakCount(), 1u);
 }
 
+TYPED_TEST(RefCountedTest, DeleterTest) {
+  using Ref = RefCounted<TypeParam, ThreadUnsafeRefControl,
+                         CountingDeleter<TypeParam>>;
+  std::size_t destructor_count = 0u;
+  CountingDeleter<TypeParam>::deleted = 0u;
+  {
+    Ref obj(new TypeParam(1, &destructor_count));
+    Ref obj_copy(obj);
+    Ref other(new TypeParam(2));
+    other = obj_copy;
+    EXPECT_EQ(CountingDeleter<TypeParam>::deleted, 1u);
+    EXPECT_EQ(obj.UseCount(), 3u);
+  }
+  EXPECT_EQ(CountingDeleter<TypeParam>::deleted, 2u);
+  EXPECT_EQ(destructor_count, 1u);
+}
+
 }  // namespace common
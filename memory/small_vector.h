@@ -0,0 +1,309 @@
+#ifndef COMMON_SMALL_VECTOR_H_
+#define COMMON_SMALL_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "common/memory/placement_new.h"
+#include "common/memory/uninitialized.h"
+
+namespace common {
+
+/// @class SmallVector
+/// Vector keeping up to N elements inline, for short lists that would
+/// otherwise make std::vector allocate, e.g. error contexts or child handles.
+/// Elements are built with Construct() in the inline buffer, and only spill
+/// to memory from the Allocator when more than N are held. Growth relocates
+/// with RelocateN(), a memcpy for IsTriviallyRelocatable types.
+///
+/// Unlike std::vector, moving a SmallVector moves inline elements one by one
+/// and invalidates iterators into them.
+/// @tparam T  element type
+/// @tparam N  number of elements kept inline, at least 1
+/// @tparam Allocator  allocator policy for spilled elements, e.g.
+///                    std::pmr::polymorphic_allocator<T>
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+class SmallVector : private Allocator {
+ public:
+  static_assert(N > 0u, "SmallVector needs room for one inline element");
+
+  using value_type = T;
+  using size_type = std::size_t;
+  using iterator = T*;
+  using const_iterator = const T*;
+  using allocator_type = Allocator;
+
+  SmallVector() noexcept(noexcept(Allocator())) : SmallVector(Allocator()) {}
+
+  explicit SmallVector(const Allocator& allocator) noexcept
+      : Allocator(allocator), data_(Inline()), size_(0u), capacity_(N) {}
+
+  explicit SmallVector(size_type count,
+                       const Allocator& allocator = Allocator())
+      : SmallVector(allocator) {
+    resize(count);
+  }
+
+  SmallVector(size_type count, const T& value,
+              const Allocator& allocator = Allocator())
+      : SmallVector(allocator) {
+    resize(count, value);
+  }
+
+  SmallVector(std::initializer_list<T> values,
+              const Allocator& allocator = Allocator())
+      : SmallVector(allocator) {
+    reserve(values.size());
+    CopyConstructN(values.begin(), values.size(), data_);
+    size_ = values.size();
+  }
+
+  SmallVector(const SmallVector& other)
+      : SmallVector(AllocTraits::select_on_container_copy_construction(
+            other.allocator())) {
+    reserve(other.size_);
+    CopyConstructN(other.data_, other.size_, data_);
+    size_ = other.size_;
+  }
+
+  SmallVector(SmallVector&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value)
+      : SmallVector(other.allocator()) {
+    TakeFrom(&other);
+  }
+
+  ~SmallVector() {
+    DestroyN(data_, size_);
+    FreeHeap();
+  }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      clear();
+      reserve(other.size_);
+      CopyConstructN(other.data_, other.size_, data_);
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept(
+      std::is_nothrow_move_constructible<T>::value) {
+    if (this != &other) {
+      clear();
+      if (allocator() == other.allocator()) {
+        FreeHeap();
+        data_ = Inline();
+        capacity_ = N;
+        TakeFrom(&other);
+      } else {
+        reserve(other.size_);
+        MoveConstructN(other.data_, other.size_, data_);
+        size_ = other.size_;
+        other.clear();
+      }
+    }
+    return *this;
+  }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  T& operator[](size_type index) { return data_[index]; }
+  const T& operator[](size_type index) const { return data_[index]; }
+
+  T& front() { return data_[0]; }
+  const T& front() const { return data_[0]; }
+  T& back() { return data_[size_ - 1u]; }
+  const T& back() const { return data_[size_ - 1u]; }
+
+  size_type size() const { return size_; }
+  size_type capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0u; }
+
+  /// @return  whether the elements are in the inline buffer
+  bool is_inline() const { return data_ == Inline(); }
+
+  allocator_type get_allocator() const { return allocator(); }
+
+  /// Constructs an element at the end from @p args, which may refer to an
+  /// element of this vector
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    if (size_ == capacity_) {
+      return GrowAndEmplaceBack(std::forward<Args>(args)...);
+    }
+    T* element = Construct<T>(data_ + size_, std::forward<Args>(args)...);
+    ++size_;
+    return *element;
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  void pop_back() { data_[--size_].~T(); }
+
+  /// Removes the elements in [@p first, @p last), moving the following ones
+  /// down
+  /// @return  iterator to the element following the last one removed
+  iterator erase(const_iterator first, const_iterator last) {
+    T* const begin = data_ + (first - data_);
+    if (first == last) {
+      // moving the following elements onto themselves may clear them
+      return begin;
+    }
+    T* const removed_end = data_ + (last - data_);
+    T* const new_end = std::move(removed_end, end(), begin);
+    DestroyN(new_end, end() - new_end);
+    size_ = new_end - data_;
+    return begin;
+  }
+
+  iterator erase(const_iterator position) {
+    return erase(position, position + 1);
+  }
+
+  void clear() {
+    DestroyN(data_, size_);
+    size_ = 0u;
+  }
+
+  void reserve(size_type capacity) {
+    if (capacity > capacity_) {
+      Reallocate(capacity);
+    }
+  }
+
+  /// Value-initializes new elements
+  void resize(size_type size) {
+    if (size > size_) {
+      reserve(size);
+      ValueConstructN<T>(data_ + size_, size - size_);
+    } else {
+      DestroyN(data_ + size, size_ - size);
+    }
+    size_ = size;
+  }
+
+  void resize(size_type size, const T& value) {
+    if (size > size_) {
+      if (size > capacity_) {
+        // value may be an element
+        SmallVector grown(allocator());
+        grown.Reallocate(size);
+        ConstructN<T>(grown.data_ + size_, size - size_, value);
+        try {
+          RelocateInto(&grown, size);
+        } catch (...) {
+          DestroyN(grown.data_ + size_, size - size_);
+          throw;
+        }
+        return;
+      }
+      ConstructN<T>(data_ + size_, size - size_, value);
+    } else {
+      DestroyN(data_ + size, size_ - size);
+    }
+    size_ = size;
+  }
+
+ private:
+  using AllocTraits = std::allocator_traits<Allocator>;
+
+  const Allocator& allocator() const { return *this; }
+  Allocator& allocator() { return *this; }
+
+  T* Inline() { return reinterpret_cast<T*>(inline_); }
+  const T* Inline() const { return reinterpret_cast<const T*>(inline_); }
+
+  void FreeHeap() {
+    if (!is_inline()) {
+      AllocTraits::deallocate(allocator(), data_, capacity_);
+    }
+  }
+
+  // Moves the elements of @p other, which allocates from an equal allocator,
+  // leaving it empty
+  void TakeFrom(SmallVector* other) {
+    if (other->is_inline()) {
+      RelocateN(other->data_, other->size_, data_);
+    } else {
+      data_ = other->data_;
+      capacity_ = other->capacity_;
+      other->data_ = other->Inline();
+      other->capacity_ = N;
+    }
+    size_ = other->size_;
+    other->size_ = 0u;
+  }
+
+  // Takes over the heap storage of @p grown after relocating the elements
+  // into it, and sets the size to @p size
+  void RelocateInto(SmallVector* grown, size_type size) {
+    RelocateN(data_, size_, grown->data_);
+    FreeHeap();
+    data_ = grown->data_;
+    capacity_ = grown->capacity_;
+    size_ = size;
+    grown->data_ = grown->Inline();
+    grown->capacity_ = N;
+  }
+
+  void Reallocate(size_type capacity) {
+    T* memory = AllocTraits::allocate(allocator(), capacity);
+    try {
+      RelocateN(data_, size_, memory);
+    } catch (...) {
+      AllocTraits::deallocate(allocator(), memory, capacity);
+      throw;
+    }
+    FreeHeap();
+    data_ = memory;
+    capacity_ = capacity;
+  }
+
+  template <typename... Args>
+  T& GrowAndEmplaceBack(Args&&... args) {
+    SmallVector grown(allocator());
+    grown.Reallocate(std::max<size_type>(2u * capacity_, size_ + 1u));
+    // built first, args may refer to an element about to be relocated
+    Construct<T>(grown.data_ + size_, std::forward<Args>(args)...);
+    try {
+      RelocateInto(&grown, size_ + 1u);
+    } catch (...) {
+      grown.data_[size_].~T();
+      throw;
+    }
+    return back();
+  }
+
+  T* data_;
+  size_type size_;
+  size_type capacity_;
+  alignas(T) unsigned char inline_[N * sizeof(T)];
+};
+
+template <typename T, std::size_t N, typename Allocator>
+bool operator==(const SmallVector<T, N, Allocator>& a,
+                const SmallVector<T, N, Allocator>& b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template <typename T, std::size_t N, typename Allocator>
+bool operator!=(const SmallVector<T, N, Allocator>& a,
+                const SmallVector<T, N, Allocator>& b) {
+  return !(a == b);
+}
+
+}  // namespace common
+
+#endif  // COMMON_SMALL_VECTOR_H_
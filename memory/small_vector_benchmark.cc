@@ -0,0 +1,61 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/memory/small_vector.h"
+
+namespace common {
+namespace {
+
+// Builds a short list of state.range(0) elements and reads it back, as done
+// for error contexts or child handles
+template <typename Vector>
+void BM_ShortInts(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    Vector numbers;
+    for (int i = 0; i < size; ++i) {
+      numbers.push_back(i);
+    }
+    int sum = 0;
+    for (int number : numbers) {
+      sum += number;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+}
+BENCHMARK_TEMPLATE(BM_ShortInts, std::vector<int>)->DenseRange(1, 8, 3);
+BENCHMARK_TEMPLATE(BM_ShortInts, SmallVector<int, 8>)->DenseRange(1, 8, 3);
+
+template <typename Vector>
+void BM_ShortStrings(benchmark::State& state) {
+  const int size = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    Vector texts;
+    for (int i = 0; i < size; ++i) {
+      texts.emplace_back("short");
+    }
+    benchmark::DoNotOptimize(texts.data());
+  }
+}
+BENCHMARK_TEMPLATE(BM_ShortStrings, std::vector<std::string>)
+    ->DenseRange(1, 8, 3);
+BENCHMARK_TEMPLATE(BM_ShortStrings, SmallVector<std::string, 8>)
+    ->DenseRange(1, 8, 3);
+
+// Growth well past the inline capacity
+template <typename Vector>
+void BM_Spill(benchmark::State& state) {
+  for (auto _ : state) {
+    Vector texts;
+    for (int i = 0; i < 64; ++i) {
+      texts.emplace_back("short");
+    }
+    benchmark::DoNotOptimize(texts.data());
+  }
+}
+BENCHMARK_TEMPLATE(BM_Spill, std::vector<std::string>);
+BENCHMARK_TEMPLATE(BM_Spill, SmallVector<std::string, 8>);
+
+}  // namespace
+}  // namespace common
@@ -0,0 +1,217 @@
+#include "common/memory/small_vector.h"
+
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace common {
+namespace {
+
+// Counts the allocations made through it
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  static int allocations;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>&) {}
+
+  T* allocate(std::size_t count) {
+    ++allocations;
+    return std::allocator<T>().allocate(count);
+  }
+  void deallocate(T* pointer, std::size_t count) {
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  bool operator==(const CountingAllocator&) const { return true; }
+  bool operator!=(const CountingAllocator&) const { return false; }
+};
+
+template <typename T>
+int CountingAllocator<T>::allocations = 0;
+
+// Counts live objects and can be told to throw from its n-th copy
+class Tracked {
+ public:
+  static int live;
+  static int copies_until_throw;
+
+  explicit Tracked(int value = 0) : value_(value) { ++live; }
+  Tracked(const Tracked& other) : value_(other.value_) {
+    if (copies_until_throw > 0 && --copies_until_throw == 0) {
+      throw std::runtime_error("copy failed");
+    }
+    ++live;
+  }
+  Tracked(Tracked&& other) noexcept : value_(other.value_) { ++live; }
+  Tracked& operator=(Tracked&& other) noexcept {
+    value_ = other.value_;
+    return *this;
+  }
+  ~Tracked() { --live; }
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+int Tracked::live = 0;
+int Tracked::copies_until_throw = 0;
+
+// Leaves the source of a move assignment empty, even when it is itself
+struct Movable {
+  explicit Movable(int v) : value(v) {}
+  Movable(const Movable&) = default;
+  Movable(Movable&&) = default;
+  Movable& operator=(Movable&& other) noexcept {
+    value = other.value;
+    other.value = 0;
+    return *this;
+  }
+
+  int value;
+};
+
+}  // namespace
+
+TEST(SmallVectorTest, InlineTest) {
+  using Vector = SmallVector<int, 4, CountingAllocator<int>>;
+  CountingAllocator<int>::allocations = 0;
+  Vector numbers;
+  EXPECT_TRUE(numbers.empty());
+  for (int i = 0; i < 4; ++i) {
+    numbers.push_back(i);
+  }
+  EXPECT_TRUE(numbers.is_inline());
+  EXPECT_EQ(CountingAllocator<int>::allocations, 0);
+  EXPECT_EQ(numbers.capacity(), 4u);
+
+  // spills on the fifth element
+  numbers.emplace_back(4);
+  EXPECT_FALSE(numbers.is_inline());
+  EXPECT_EQ(CountingAllocator<int>::allocations, 1);
+  EXPECT_EQ(numbers.capacity(), 8u);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(numbers[i], i);
+  }
+  numbers.pop_back();
+  EXPECT_EQ(numbers.back(), 3);
+  EXPECT_EQ(numbers.front(), 0);
+  EXPECT_EQ(numbers.size(), 4u);
+
+  // an element of the vector itself can be appended while growing
+  for (int i = 0; i < 5; ++i) {
+    numbers.push_back(numbers[0]);
+  }
+  EXPECT_EQ(numbers.size(), 9u);
+  EXPECT_EQ(numbers[8], 0);
+}
+
+TEST(SmallVectorTest, ElementsTest) {
+  {
+    SmallVector<Tracked, 2> objects;
+    for (int i = 0; i < 10; ++i) {
+      objects.emplace_back(i);
+    }
+    EXPECT_EQ(Tracked::live, 10);
+    objects.erase(objects.begin() + 2, objects.begin() + 5);
+    EXPECT_EQ(Tracked::live, 7);
+    EXPECT_EQ(objects[2].value(), 5);
+    objects.erase(objects.begin());
+    EXPECT_EQ(objects[0].value(), 1);
+    objects.resize(3);
+    EXPECT_EQ(Tracked::live, 3);
+    objects.resize(5, objects[0]);
+    EXPECT_EQ(objects[4].value(), 1);
+    objects.resize(20, objects[1]);
+    EXPECT_EQ(objects[19].value(), 5);
+    EXPECT_EQ(Tracked::live, 20);
+  }
+  EXPECT_EQ(Tracked::live, 0);
+
+  SmallVector<Movable, 2> movables;
+  for (int i = 1; i <= 3; ++i) {
+    movables.emplace_back(i);
+  }
+  EXPECT_EQ(movables.erase(movables.begin() + 1, movables.begin() + 1),
+            movables.begin() + 1);
+  EXPECT_EQ(movables.size(), 3u);
+  EXPECT_EQ(movables[1].value, 2);
+  EXPECT_EQ(movables[2].value, 3);
+
+  SmallVector<std::unique_ptr<int>, 2> pointers;
+  for (int i = 0; i < 5; ++i) {
+    pointers.push_back(std::make_unique<int>(i));
+  }
+  EXPECT_EQ(*pointers[4], 4);
+
+  SmallVector<std::string, 3> texts(4u, "a string long enough to allocate");
+  EXPECT_EQ(texts.size(), 4u);
+  EXPECT_EQ(texts[3], texts[0]);
+}
+
+TEST(SmallVectorTest, CopyMoveTest) {
+  for (std::size_t size : {2u, 6u}) {
+    SmallVector<std::string, 4> original;
+    for (std::size_t i = 0; i < size; ++i) {
+      original.push_back(std::to_string(i));
+    }
+    SmallVector<std::string, 4> copy(original);
+    EXPECT_EQ(copy, original);
+    SmallVector<std::string, 4> moved(std::move(copy));
+    EXPECT_EQ(moved, original);
+    EXPECT_TRUE(copy.empty());
+
+    SmallVector<std::string, 4> assigned{"x", "y", "z", "w", "v"};
+    EXPECT_NE(assigned, original);
+    assigned = original;
+    EXPECT_EQ(assigned, original);
+    SmallVector<std::string, 4> move_assigned{"x"};
+    move_assigned = std::move(moved);
+    EXPECT_EQ(move_assigned, original);
+    EXPECT_TRUE(moved.empty());
+    EXPECT_TRUE(moved.is_inline());
+    moved.push_back("reused");
+    EXPECT_EQ(moved[0], "reused");
+  }
+}
+
+TEST(SmallVectorTest, PmrAllocatorTest) {
+  std::pmr::monotonic_buffer_resource resource;
+  using Vector = SmallVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+  Vector numbers(&resource);
+  for (int i = 0; i < 100; ++i) {
+    numbers.push_back(i);
+  }
+  EXPECT_EQ(numbers.get_allocator().resource(), &resource);
+  EXPECT_EQ(numbers[99], 99);
+
+  // different resources move elements one by one
+  std::pmr::monotonic_buffer_resource other_resource;
+  Vector other(&other_resource);
+  other = std::move(numbers);
+  EXPECT_EQ(other.size(), 100u);
+  EXPECT_EQ(other.get_allocator().resource(), &other_resource);
+}
+
+TEST(SmallVectorTest, ThrowingCopyTest) {
+  using Objects = SmallVector<Tracked, 2>;
+  {
+    Objects objects(3u, Tracked(7));
+    Tracked::copies_until_throw = 2;
+    EXPECT_THROW(Objects copy(objects), std::runtime_error);
+    EXPECT_EQ(Tracked::live, 3);
+    Tracked::copies_until_throw = 0;
+  }
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+}  // namespace common
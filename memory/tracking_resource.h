@@ -0,0 +1,62 @@
+#ifndef COMMON_TRACKING_RESOURCE_H_
+#define COMMON_TRACKING_RESOURCE_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+#include "common/memory/memory_metrics.h"
+
+namespace common {
+
+/// @class TrackingResource
+/// Memory resource recording every allocation from its upstream resource
+/// under one MemoryMetrics tag, e.g.
+///   TrackingResource tracking("lookup_tables", &mapped_resource);
+///   Arena arena(MappedResource::kHugePageSize, tracking.resource());
+/// Without COMMON_MEMORY_TRACKING resource() returns the upstream resource
+/// itself, so that tracking costs nothing when compiled out.
+class TrackingResource : public std::pmr::memory_resource {
+ public:
+  explicit TrackingResource(
+      std::string_view tag,
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+      : TrackingResource(MemoryMetrics::RegisterTag(tag), upstream) {}
+
+  TrackingResource(MemoryTag tag, std::pmr::memory_resource* upstream)
+      : tag_(tag), upstream_(upstream) {}
+
+  /// @return  the resource to allocate from
+  std::pmr::memory_resource* resource() {
+#ifdef COMMON_MEMORY_TRACKING
+    return this;
+#else
+    return upstream_;
+#endif
+  }
+
+  MemoryTag tag() const { return tag_; }
+
+ private:
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void* memory = upstream_->allocate(bytes, alignment);
+    MemoryMetrics::RecordAllocation(tag_, bytes);
+    return memory;
+  }
+  void do_deallocate(void* pointer, std::size_t bytes,
+                     std::size_t alignment) override {
+    upstream_->deallocate(pointer, bytes, alignment);
+    MemoryMetrics::RecordDeallocation(tag_, bytes);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  MemoryTag tag_;
+  std::pmr::memory_resource* upstream_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_TRACKING_RESOURCE_H_
@@ -0,0 +1,91 @@
+#include "common/memory/tracking_resource.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "common/error.h"
+#include "common/memory/arena.h"
+#include "common/memory/object_pool.h"
+#include "gtest/gtest.h"
+
+namespace common {
+
+namespace {
+
+MemoryMetrics::Entry EntryFor(const std::string& name) {
+  for (const MemoryMetrics::Entry& entry : MemoryMetrics::Snapshot()) {
+    if (entry.name == name) {
+      return entry;
+    }
+  }
+  return MemoryMetrics::Entry{name, 0, 0, 0u, 0u};
+}
+
+}  // namespace
+
+TEST(TrackingResourceTest, AllocateTest) {
+  TrackingResource tracking("allocate_test");
+  EXPECT_EQ(tracking.tag(), MemoryMetrics::RegisterTag("allocate_test"));
+  // the resource itself always records
+  void* memory = tracking.allocate(1u << 20, 8u);
+  EXPECT_EQ(EntryFor("allocate_test").bytes, 1 << 20);
+  tracking.deallocate(memory, 1u << 20, 8u);
+  EXPECT_EQ(EntryFor("allocate_test").bytes, 0);
+  EXPECT_EQ(EntryFor("allocate_test").peak_bytes, 1 << 20);
+}
+
+#ifdef COMMON_MEMORY_TRACKING
+TEST(TrackingResourceTest, HooksTest) {
+  TrackingResource tracking("hooks_test");
+  EXPECT_EQ(tracking.resource(), &tracking);
+  {
+    Arena arena(4096u, tracking.resource());
+    arena.Allocate(100u);
+    std::pmr::vector<int> numbers(1000u, 7, tracking.resource());
+    ObjectPool<std::string> pool(32u, tracking.resource());
+    ObjectPool<std::string>::Destroy(pool.Create("pooled"));
+    const MemoryMetrics::Entry entry = EntryFor("hooks_test");
+    EXPECT_EQ(entry.allocations, 3u);
+    EXPECT_EQ(entry.bytes,
+              static_cast<std::int64_t>(4096u + 1000u * sizeof(int) +
+                                        ObjectPool<std::string>::slab_size()));
+  }
+  EXPECT_EQ(EntryFor("hooks_test").bytes, 0);
+  EXPECT_EQ(EntryFor("hooks_test").deallocations, 3u);
+}
+
+TEST(TrackingResourceTest, BuiltInTagsTest) {
+  const std::int64_t control_bytes = EntryFor("ref_counted").bytes;
+  const std::int64_t error_bytes = EntryFor("error").bytes;
+  TrackingResource tracking("built_in_tags_test");
+  {
+    ObjectPool<std::string> pool(32u, tracking.resource());
+    ObjectPool<std::string>::Ref<> text = pool.CreateRef("pooled");
+    ObjectPool<std::string>::Ref<> copy(text);
+    EXPECT_EQ(EntryFor("ref_counted").bytes,
+              control_bytes + static_cast<std::int64_t>(
+                                  sizeof(ThreadUnsafeRefControl)));
+    EXPECT_EQ(EntryFor("built_in_tags_test").bytes,
+              static_cast<std::int64_t>(ObjectPool<std::string>::slab_size()));
+
+    ErrorWithExplanation error(Error::kInternal, std::string(100u, 'x'));
+    ErrorWithExplanation error_copy(error);
+    EXPECT_EQ(EntryFor("error").bytes, error_bytes + 200);
+  }
+  EXPECT_EQ(EntryFor("ref_counted").bytes, control_bytes);
+  EXPECT_EQ(EntryFor("error").bytes, error_bytes);
+}
+#else
+TEST(TrackingResourceTest, PassThroughTest) {
+  std::pmr::monotonic_buffer_resource upstream;
+  TrackingResource tracking("pass_through_test", &upstream);
+  EXPECT_EQ(tracking.resource(), &upstream);
+  Arena arena(4096u, tracking.resource());
+  arena.Allocate(100u);
+  EXPECT_EQ(EntryFor("pass_through_test").allocations, 0u);
+}
+#endif
+
+}  // namespace common
@@ -0,0 +1,217 @@
+#ifndef COMMON_UNINITIALIZED_H_
+#define COMMON_UNINITIALIZED_H_
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "common/memory/placement_new.h"
+
+namespace common {
+
+/// Whether moving a T to new storage and destroying the original is the same
+/// as copying its bytes. True for trivially copyable types; specialize it for
+/// other types that hold no pointers into themselves, e.g. owning pointers.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename D>
+struct IsTriviallyRelocatable<std::unique_ptr<T, D>>
+    : IsTriviallyRelocatable<D> {};
+
+namespace internal {
+
+// Destroys the objects built so far unless committed, so that a constructor
+// throwing part way through a range leaves no objects behind
+template <typename T>
+class PartialRange {
+ public:
+  explicit PartialRange(T* begin) : begin_(begin), count_(0u) {}
+
+  PartialRange(const PartialRange&) = delete;
+  PartialRange& operator=(const PartialRange&) = delete;
+
+  ~PartialRange() {
+    while (count_ != 0u) {
+      begin_[--count_].~T();
+    }
+  }
+
+  void Built() { ++count_; }
+  void Commit() { count_ = 0u; }
+
+ private:
+  T* begin_;
+  std::size_t count_;
+};
+
+// Calls @p f(i) for i in [0, count) in order, four calls per iteration
+template <typename F>
+void ForEachIndex(std::size_t count, F&& f) {
+  std::size_t i = 0;
+  for (; i + 4u <= count; i += 4u) {
+    f(i);
+    f(i + 1u);
+    f(i + 2u);
+    f(i + 3u);
+  }
+  for (; i < count; ++i) {
+    f(i);
+  }
+}
+
+template <typename T>
+constexpr bool kZeroIsValueInitialized =
+    std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+    std::is_pointer<T>::value;
+
+}  // namespace internal
+
+/// Default-initializes @p count objects at @p memory: a no-op for trivially
+/// default constructible types, whose values are then indeterminate
+/// @return  the first object
+template <typename T>
+T* DefaultConstructN(void* memory, std::size_t count) {
+  T* objects = static_cast<T*>(memory);
+  if constexpr (!std::is_trivially_default_constructible<T>::value) {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, &built](std::size_t i) {
+      new (objects + i) T;
+      built.Built();
+    });
+    built.Commit();
+  }
+  return objects;
+}
+
+/// Value-initializes @p count objects at @p memory, with a memset for
+/// scalars
+/// @return  the first object
+template <typename T>
+T* ValueConstructN(void* memory, std::size_t count) {
+  T* objects = static_cast<T*>(memory);
+  if constexpr (internal::kZeroIsValueInitialized<T>) {
+    if (count != 0u) {
+      std::memset(memory, 0, count * sizeof(T));
+    }
+  } else {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, &built](std::size_t i) {
+      new (objects + i) T();
+      built.Built();
+    });
+    built.Commit();
+  }
+  return objects;
+}
+
+/// Constructs @p count objects at @p memory, each from @p args. Arguments
+/// are passed as lvalues, since every object uses them. If a constructor
+/// throws, the objects already built are destroyed.
+/// @return  the first object
+template <typename T, typename... Args>
+T* ConstructN(void* memory, std::size_t count, const Args&... args) {
+  T* objects = static_cast<T*>(memory);
+  if constexpr (sizeof...(Args) == 0u) {
+    return ValueConstructN<T>(memory, count);
+  } else if constexpr (sizeof(T) == 1u && sizeof...(Args) == 1u &&
+                       std::is_trivially_copyable<T>::value &&
+                       (std::is_same<T, Args>::value && ...)) {
+    if (count != 0u) {
+      std::memset(memory, static_cast<unsigned char>(args)..., count);
+    }
+  } else {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, &built, &args...](std::size_t i) {
+      Construct<T>(objects + i, args...);
+      built.Built();
+    });
+    built.Commit();
+  }
+  return objects;
+}
+
+/// Copy-constructs @p count objects at @p to from those at @p from, with a
+/// memcpy for trivially copyable types. The ranges must not overlap. If a
+/// constructor throws, the copies already built are destroyed.
+/// @return  the first copy
+template <typename T>
+T* CopyConstructN(const T* from, std::size_t count, void* to) {
+  T* objects = static_cast<T*>(to);
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (count != 0u) {
+      std::memcpy(to, from, count * sizeof(T));
+    }
+  } else {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, from, &built](std::size_t i) {
+      Construct<T>(objects + i, from[i]);
+      built.Built();
+    });
+    built.Commit();
+  }
+  return objects;
+}
+
+/// Move-constructs @p count objects at @p to from those at @p from, which
+/// are left moved from. Otherwise as CopyConstructN().
+/// @return  the first object built
+template <typename T>
+T* MoveConstructN(T* from, std::size_t count, void* to) {
+  T* objects = static_cast<T*>(to);
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (count != 0u) {
+      std::memcpy(to, from, count * sizeof(T));
+    }
+  } else {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, from, &built](std::size_t i) {
+      Construct<T>(objects + i, std::move(from[i]));
+      built.Built();
+    });
+    built.Commit();
+  }
+  return objects;
+}
+
+/// Destroys @p count objects at @p objects, last first; a no-op for
+/// trivially destructible types
+template <typename T>
+void DestroyN(T* objects, std::size_t count) {
+  if constexpr (!std::is_trivially_destructible<T>::value) {
+    while (count != 0u) {
+      objects[--count].~T();
+    }
+  }
+}
+
+/// Moves @p count objects from @p from to uninitialized storage at @p to
+/// and destroys the originals; a memcpy for IsTriviallyRelocatable types.
+/// The ranges must not overlap. Types whose move constructor may throw are
+/// copied instead, so that if a constructor throws the originals are intact
+/// and no object is left at @p to.
+/// @return  the first relocated object
+template <typename T>
+T* RelocateN(T* from, std::size_t count, void* to) {
+  T* objects = static_cast<T*>(to);
+  if constexpr (IsTriviallyRelocatable<T>::value) {
+    if (count != 0u) {
+      std::memcpy(to, static_cast<const void*>(from), count * sizeof(T));
+    }
+  } else {
+    internal::PartialRange<T> built(objects);
+    internal::ForEachIndex(count, [objects, from, &built](std::size_t i) {
+      Construct<T>(objects + i, std::move_if_noexcept(from[i]));
+      built.Built();
+    });
+    built.Commit();
+    DestroyN(from, count);
+  }
+  return objects;
+}
+
+}  // namespace common
+
+#endif  // COMMON_UNINITIALIZED_H_
@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/memory/placement_new.h"
+#include "common/memory/uninitialized.h"
+
+namespace common {
+namespace {
+
+struct Pod {
+  std::int64_t key;
+  double weight;
+  std::int32_t flags;
+};
+
+// Baselines build one object at a time with Construct()
+template <typename T>
+void BM_ValueConstructLoop(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  auto storage = std::make_unique<unsigned char[]>(count * sizeof(T));
+  for (auto _ : state) {
+    T* objects = reinterpret_cast<T*>(storage.get());
+    for (std::size_t i = 0; i < count; ++i) {
+      Construct<T>(objects + i);
+    }
+    benchmark::DoNotOptimize(objects);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_ValueConstructLoop, std::int64_t)->Range(64, 1 << 20);
+
+template <typename T>
+void BM_ValueConstructN(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  auto storage = std::make_unique<unsigned char[]>(count * sizeof(T));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ValueConstructN<T>(storage.get(), count));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_ValueConstructN, std::int64_t)->Range(64, 1 << 20);
+
+template <typename T>
+void BM_CopyConstructLoop(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  std::unique_ptr<T[]> from(new T[count]());
+  auto storage = std::make_unique<unsigned char[]>(count * sizeof(T));
+  for (auto _ : state) {
+    T* objects = reinterpret_cast<T*>(storage.get());
+    for (std::size_t i = 0; i < count; ++i) {
+      Construct<T>(objects + i, from[i]);
+    }
+    benchmark::DoNotOptimize(objects);
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_CopyConstructLoop, Pod)->Range(64, 1 << 20);
+
+template <typename T>
+void BM_CopyConstructN(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  std::unique_ptr<T[]> from(new T[count]());
+  auto storage = std::make_unique<unsigned char[]>(count * sizeof(T));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        CopyConstructN(from.get(), count, storage.get()));
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * count * sizeof(T));
+}
+BENCHMARK_TEMPLATE(BM_CopyConstructN, Pod)->Range(64, 1 << 20);
+
+// Not trivially copyable: both build each string, the bulk version unrolled
+void BM_StringCopyConstructN(benchmark::State& state) {
+  const std::size_t count = static_cast<std::size_t>(state.range(0));
+  std::unique_ptr<std::string[]> from(new std::string[count]);
+  auto storage = std::make_unique<unsigned char[]>(count * sizeof(std::string));
+  for (auto _ : state) {
+    std::string* copies = CopyConstructN(from.get(), count, storage.get());
+    DestroyN(copies, count);
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_StringCopyConstructN)->Range(64, 1 << 16);
+
+}  // namespace
+}  // namespace common
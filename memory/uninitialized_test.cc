@@ -0,0 +1,181 @@
+#include "common/memory/uninitialized.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace common {
+namespace {
+
+// Counts live objects and can be told to throw from its n-th construction
+class Tracked {
+ public:
+  static int live;
+  static int constructions_until_throw;
+
+  Tracked() : Tracked(0) {}
+  explicit Tracked(int value) : value_(value) { Count(); }
+  Tracked(const Tracked& other) : value_(other.value_) { Count(); }
+  Tracked(Tracked&& other) noexcept : value_(other.value_) {
+    other.value_ = -1;
+    ++live;
+  }
+  ~Tracked() { --live; }
+
+  int value() const { return value_; }
+
+ private:
+  void Count() {
+    if (constructions_until_throw > 0 && --constructions_until_throw == 0) {
+      throw std::runtime_error("construction failed");
+    }
+    ++live;
+  }
+
+  int value_;
+};
+
+int Tracked::live = 0;
+int Tracked::constructions_until_throw = 0;
+
+// May throw when moved, so relocation must copy it
+struct ThrowingMove {
+  explicit ThrowingMove(std::string text) : text(std::move(text)) {}
+  ThrowingMove(const ThrowingMove&) = default;
+  ThrowingMove(ThrowingMove&& other) : text(std::move(other.text)) {}
+  std::string text;
+};
+
+template <typename T, std::size_t N>
+struct Storage {
+  alignas(T) unsigned char bytes[N * sizeof(T)];
+};
+
+}  // namespace
+
+TEST(UninitializedTest, ConstructDestroyTest) {
+  Storage<Tracked, 9> storage;
+  Tracked* objects = ConstructN<Tracked>(storage.bytes, 9u, 7);
+  EXPECT_EQ(Tracked::live, 9);
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(objects[i].value(), 7);
+  }
+  DestroyN(objects, 9u);
+  EXPECT_EQ(Tracked::live, 0);
+
+  objects = ValueConstructN<Tracked>(storage.bytes, 5u);
+  EXPECT_EQ(Tracked::live, 5);
+  DestroyN(objects, 5u);
+  objects = DefaultConstructN<Tracked>(storage.bytes, 3u);
+  EXPECT_EQ(Tracked::live, 3);
+  DestroyN(objects, 3u);
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(UninitializedTest, TrivialTypesTest) {
+  Storage<int64_t, 13> numbers;
+  std::memset(numbers.bytes, 0xFF, sizeof(numbers.bytes));
+  const int64_t* zeros = ValueConstructN<int64_t>(numbers.bytes, 13u);
+  for (int i = 0; i < 13; ++i) {
+    EXPECT_EQ(zeros[i], 0);
+  }
+  const int64_t* fives = ConstructN<int64_t>(numbers.bytes, 13u, int64_t{5});
+  EXPECT_EQ(fives[12], 5);
+
+  Storage<char, 10> chars;
+  const char* letters = ConstructN<char>(chars.bytes, 10u, 'z');
+  EXPECT_EQ(std::string(letters, 10u), "zzzzzzzzzz");
+
+  Storage<int64_t, 13> copies;
+  const int64_t* copied = CopyConstructN(fives, 13u, copies.bytes);
+  EXPECT_EQ(copied[0], 5);
+  EXPECT_EQ(copied[12], 5);
+
+  Storage<int*, 4> pointers;
+  int* const* nulls = ValueConstructN<int*>(pointers.bytes, 4u);
+  EXPECT_EQ(nulls[3], nullptr);
+
+  // nothing is touched for empty ranges
+  EXPECT_EQ(CopyConstructN<int64_t>(nullptr, 0u, nullptr), nullptr);
+}
+
+TEST(UninitializedTest, CopyMoveTest) {
+  Storage<std::string, 6> from;
+  std::string* originals = ConstructN<std::string>(
+      from.bytes, 6u, "a string long enough to be on the heap");
+  Storage<std::string, 6> copies;
+  std::string* copied = CopyConstructN(originals, 6u, copies.bytes);
+  EXPECT_EQ(copied[5], originals[5]);
+  Storage<std::string, 6> moves;
+  std::string* moved = MoveConstructN(copied, 6u, moves.bytes);
+  EXPECT_EQ(moved[5], originals[5]);
+  EXPECT_TRUE(copied[5].empty());
+  DestroyN(originals, 6u);
+  DestroyN(copied, 6u);
+  DestroyN(moved, 6u);
+}
+
+TEST(UninitializedTest, RelocateTest) {
+  static_assert(IsTriviallyRelocatable<std::unique_ptr<int>>::value, "");
+  static_assert(!IsTriviallyRelocatable<Tracked>::value, "");
+
+  Storage<std::unique_ptr<int>, 5> pointers;
+  std::unique_ptr<int>* from =
+      ValueConstructN<std::unique_ptr<int>>(pointers.bytes, 5u);
+  for (int i = 0; i < 5; ++i) {
+    from[i] = std::make_unique<int>(i);
+  }
+  Storage<std::unique_ptr<int>, 5> relocated_storage;
+  std::unique_ptr<int>* relocated =
+      RelocateN(from, 5u, relocated_storage.bytes);
+  EXPECT_EQ(*relocated[4], 4);
+  DestroyN(relocated, 5u);
+
+  Storage<Tracked, 7> tracked;
+  Tracked* objects = ConstructN<Tracked>(tracked.bytes, 7u, 3);
+  Storage<Tracked, 7> tracked_to;
+  Tracked* moved = RelocateN(objects, 7u, tracked_to.bytes);
+  EXPECT_EQ(Tracked::live, 7);
+  EXPECT_EQ(moved[6].value(), 3);
+  DestroyN(moved, 7u);
+  EXPECT_EQ(Tracked::live, 0);
+}
+
+TEST(UninitializedTest, RollbackTest) {
+  Storage<Tracked, 10> storage;
+  Tracked::constructions_until_throw = 6;
+  EXPECT_THROW(ConstructN<Tracked>(storage.bytes, 10u, 1),
+               std::runtime_error);
+  EXPECT_EQ(Tracked::live, 0);
+
+  Tracked* objects = ConstructN<Tracked>(storage.bytes, 10u, 2);
+  Storage<Tracked, 10> copies;
+  Tracked::constructions_until_throw = 10;
+  EXPECT_THROW(CopyConstructN(objects, 10u, copies.bytes), std::runtime_error);
+  EXPECT_EQ(Tracked::live, 10);
+  DestroyN(objects, 10u);
+  EXPECT_EQ(Tracked::live, 0);
+  Tracked::constructions_until_throw = 0;
+}
+
+TEST(UninitializedTest, RelocateCopiesThrowingMovesTest) {
+  Storage<ThrowingMove, 3> from_storage;
+  ThrowingMove* from =
+      ConstructN<ThrowingMove>(from_storage.bytes, 3u,
+                               std::string("long enough to allocate, "
+                                           "so that a move would empty it"));
+  Storage<ThrowingMove, 3> copy_storage;
+  // keep a copy of the originals, RelocateN() destroys them
+  ThrowingMove* expected = CopyConstructN(from, 3u, copy_storage.bytes);
+  Storage<ThrowingMove, 3> to_storage;
+  ThrowingMove* to = RelocateN(from, 3u, to_storage.bytes);
+  EXPECT_EQ(to[2].text, expected[2].text);
+  DestroyN(to, 3u);
+  DestroyN(expected, 3u);
+}
+
+}  // namespace common
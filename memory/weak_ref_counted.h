@@ -1,11 +1,34 @@
 #ifndef COMMON_MEMORY_WEAK_REF_COUNTED_H_
 #define COMMON_MEMORY_WEAK_REF_COUNTED_H_
 
+#include <cstddef>
 #include <type_traits>
+
+#include "common/memory/memory_metrics.h"
 #include "common/memory/thread_unsafe_ref_control.h"
 
 namespace common {
 
+namespace internal {
+
+// Control blocks are recorded under MemoryMetrics::kRefCountedTag
+template <typename Control>
+Control* NewControl(std::size_t use_count) {
+  Control* control = new Control(use_count);
+  TrackAllocation(MemoryMetrics::kRefCountedTag, sizeof(Control));
+  return control;
+}
+
+template <typename Control>
+void DeleteControl(Control* control) {
+  if (control != nullptr) {
+    delete control;
+    TrackDeallocation(MemoryMetrics::kRefCountedTag, sizeof(Control));
+  }
+}
+
+}  // namespace internal
+
 template <typename T, typename Control = ThreadUnsafeRefControl>
 class WeakRefCounted {
  public:
@@ -84,14 +107,14 @@ class WeakRefCounted {
   template <typename U, typename UCounter>
   friend class WeakRefCounted;
 
-  template <typename U, typename UCounter>
+  template <typename U, typename UCounter, typename UDeleter>
   friend class RefCounted;
 
   WeakRefCounted(Control* control_ptr, T* to_manage)
       : control_ptr_(control_ptr), managed_(to_manage) {}
 
   void DestroyControl() {
-    delete control_ptr_;
+    internal::DeleteControl(control_ptr_);
     control_ptr_ = nullptr;
   }
 
@@ -0,0 +1,95 @@
+#include "common/rcu.h"
+
+namespace common {
+
+namespace {
+
+// epoch 0 marks a slot whose thread is not reading
+std::atomic<std::uint64_t> g_epoch{1u};
+
+struct alignas(64) ReaderSlot {
+  std::atomic<std::uint64_t> epoch;
+  std::atomic<bool> in_use;
+  ReaderSlot* next;
+};
+
+// slots are never freed, a slot released by an exiting thread is reused
+std::atomic<ReaderSlot*> g_slots{nullptr};
+
+ReaderSlot* AcquireSlot() {
+  for (ReaderSlot* slot = g_slots.load(std::memory_order_acquire);
+       slot != nullptr; slot = slot->next) {
+    bool expected = false;
+    if (slot->in_use.compare_exchange_strong(expected, true,
+                                             std::memory_order_acquire)) {
+      return slot;
+    }
+  }
+  ReaderSlot* slot = new ReaderSlot();
+  slot->in_use.store(true, std::memory_order_relaxed);
+  slot->next = g_slots.load(std::memory_order_relaxed);
+  while (!g_slots.compare_exchange_weak(slot->next, slot,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+  }
+  return slot;
+}
+
+class ThreadReader {
+ public:
+  ~ThreadReader() {
+    if (slot_ != nullptr) {
+      slot_->in_use.store(false, std::memory_order_release);
+    }
+  }
+
+  void Enter() {
+    if (depth_++ == 0u) {
+      if (slot_ == nullptr) {
+        slot_ = AcquireSlot();
+      }
+      // seq_cst orders the store before the caller's loads of RcuCells
+      slot_->epoch.store(g_epoch.load(std::memory_order_seq_cst),
+                         std::memory_order_seq_cst);
+    }
+  }
+
+  void Exit() {
+    if (--depth_ == 0u) {
+      slot_->epoch.store(0u, std::memory_order_release);
+    }
+  }
+
+ private:
+  ReaderSlot* slot_ = nullptr;
+  std::uint32_t depth_ = 0u;
+};
+
+thread_local ThreadReader t_reader;
+
+}  // namespace
+
+RcuReadLock::RcuReadLock() { t_reader.Enter(); }
+
+RcuReadLock::~RcuReadLock() { t_reader.Exit(); }
+
+namespace internal {
+
+std::uint64_t RcuAdvanceEpoch() {
+  return g_epoch.fetch_add(1u, std::memory_order_seq_cst);
+}
+
+bool RcuQuiescent(std::uint64_t epoch) {
+  for (ReaderSlot* slot = g_slots.load(std::memory_order_acquire);
+       slot != nullptr; slot = slot->next) {
+    const std::uint64_t reader = slot->epoch.load(std::memory_order_seq_cst);
+    if (reader != 0u && reader <= epoch) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+
+}  // namespace common
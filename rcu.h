@@ -0,0 +1,95 @@
+#ifndef COMMON_RCU_H_
+#define COMMON_RCU_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace common {
+
+/// @class RcuReadLock
+/// Read-side critical section of the process wide epoch based RCU domain.
+/// Pointers loaded from an RcuCell stay valid until the lock is destroyed.
+/// Taking the lock is two atomic stores into a slot owned by the calling
+/// thread; no mutex is taken. The first lock on a thread claims its slot,
+/// which may allocate once. Locks nest.
+class RcuReadLock {
+ public:
+  RcuReadLock();
+  ~RcuReadLock();
+
+  RcuReadLock(const RcuReadLock&) = delete;
+  RcuReadLock& operator=(const RcuReadLock&) = delete;
+};
+
+namespace internal {
+
+/// Starts a new epoch
+/// @return  the epoch that was current, readers that entered during it or
+///          before may still see pointers retired now
+std::uint64_t RcuAdvanceEpoch();
+
+/// @return  true if no reader is inside a critical section that started in
+///          @p epoch or earlier
+bool RcuQuiescent(std::uint64_t epoch);
+
+}  // namespace internal
+
+/// @class RcuCell
+/// Pointer to an immutable T that readers load inside an RcuReadLock while a
+/// writer replaces it. Replaced objects are deleted once every reader that
+/// could have loaded them has left its critical section; writers never wait
+/// for readers, they retry reclamation on their next Publish() instead.
+/// Publish() must be serialized by the caller.
+template <typename T>
+class RcuCell {
+ public:
+  explicit RcuCell(std::unique_ptr<const T> initial)
+      : current_(initial.release()) {}
+
+  /// No reader may be inside a critical section using the cell
+  ~RcuCell() { delete current_.load(std::memory_order_relaxed); }
+
+  RcuCell(const RcuCell&) = delete;
+  RcuCell& operator=(const RcuCell&) = delete;
+
+  /// The caller must hold an RcuReadLock while using the pointer
+  const T* Load() const { return current_.load(std::memory_order_seq_cst); }
+
+  /// Replaces the current object, which is retired rather than deleted
+  void Publish(std::unique_ptr<const T> next) {
+    const T* previous = current_.exchange(next.release());
+    retired_.push_back(Retired{internal::RcuAdvanceEpoch(),
+                               std::unique_ptr<const T>(previous)});
+    Reclaim();
+  }
+
+  /// Deletes retired objects that no reader can still see
+  void Reclaim() {
+    std::size_t kept = 0u;
+    for (Retired& retired : retired_) {
+      if (!internal::RcuQuiescent(retired.epoch)) {
+        retired_[kept++] = std::move(retired);
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  /// @return  the number of retired objects not deleted yet
+  std::size_t RetiredCount() const { return retired_.size(); }
+
+ private:
+  struct Retired {
+    std::uint64_t epoch;
+    std::unique_ptr<const T> object;
+  };
+
+  std::atomic<const T*> current_;
+  std::vector<Retired> retired_;
+};
+
+}  // namespace common
+
+#endif  // COMMON_RCU_H_
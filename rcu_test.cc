@@ -0,0 +1,100 @@
+#include "common/rcu.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace common {
+
+namespace {
+
+struct Counted {
+  explicit Counted(int value, std::atomic<int>* live)
+      : value(value), live(live) {
+    live->fetch_add(1);
+  }
+  ~Counted() { live->fetch_sub(1); }
+
+  int value;
+  std::atomic<int>* live;
+};
+
+}  // namespace
+
+TEST(RcuTest, PublishTest) {
+  std::atomic<int> live{0};
+  {
+    RcuCell<Counted> cell(std::make_unique<const Counted>(1, &live));
+    {
+      RcuReadLock lock;
+      EXPECT_EQ(cell.Load()->value, 1);
+    }
+    cell.Publish(std::make_unique<const Counted>(2, &live));
+    // no reader, the first object is gone right away
+    EXPECT_EQ(cell.RetiredCount(), 0u);
+    EXPECT_EQ(live.load(), 1);
+    RcuReadLock lock;
+    EXPECT_EQ(cell.Load()->value, 2);
+  }
+  EXPECT_EQ(live.load(), 0);
+}
+
+TEST(RcuTest, ReaderDelaysReclaimTest) {
+  std::atomic<int> live{0};
+  RcuCell<Counted> cell(std::make_unique<const Counted>(1, &live));
+  std::unique_ptr<RcuReadLock> lock = std::make_unique<RcuReadLock>();
+  const Counted* seen = cell.Load();
+
+  // writes from another thread do not wait for this reader
+  std::thread writer([&cell, &live] {
+    cell.Publish(std::make_unique<const Counted>(2, &live));
+    cell.Publish(std::make_unique<const Counted>(3, &live));
+  });
+  writer.join();
+  EXPECT_EQ(seen->value, 1);
+  EXPECT_EQ(cell.RetiredCount(), 2u);
+  EXPECT_EQ(live.load(), 3);
+
+  // nested locks keep the outer critical section
+  { RcuReadLock nested; }
+  cell.Reclaim();
+  EXPECT_EQ(cell.RetiredCount(), 2u);
+
+  lock.reset();
+  cell.Reclaim();
+  EXPECT_EQ(cell.RetiredCount(), 0u);
+  EXPECT_EQ(live.load(), 1);
+}
+
+TEST(RcuTest, ConcurrentTest) {
+  std::atomic<int> live{0};
+  RcuCell<Counted> cell(std::make_unique<const Counted>(0, &live));
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&cell, &stop] {
+      int last = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        RcuReadLock lock;
+        const int value = cell.Load()->value;
+        EXPECT_GE(value, last);
+        last = value;
+      }
+    });
+  }
+  for (int i = 1; i <= 2000; ++i) {
+    cell.Publish(std::make_unique<const Counted>(i, &live));
+  }
+  stop.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  cell.Reclaim();
+  EXPECT_EQ(cell.RetiredCount(), 0u);
+  EXPECT_EQ(live.load(), 1);
+}
+
+}  // namespace common
@@ -0,0 +1,296 @@
+#include "common/registry.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace registry {
+
+namespace {
+
+constexpr std::size_t kNumTypes =
+    static_cast<std::size_t>(TypeEnum::kEnum) + 1u;
+
+std::uint64_t HashName(std::string_view name) {
+  // FNV-1a
+  std::uint64_t hash = 0xCBF29CE484222325ull;
+  for (char c : name) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+const Value* Registry::Snapshot::Find(std::string_view name) const {
+  const Entry* entry = FindEntry(name);
+  return entry != nullptr ? &entry->value : nullptr;
+}
+
+const Registry::Entry* Registry::Snapshot::FindEntry(
+    std::string_view name) const {
+  if (index.empty()) {
+    return nullptr;
+  }
+  const std::uint64_t hash = HashName(name);
+  const std::size_t mask = index.size() - 1u;
+  for (std::size_t bucket = hash & mask;; bucket = (bucket + 1u) & mask) {
+    const std::uint32_t position = index[bucket];
+    if (position == 0u) {
+      return nullptr;
+    }
+    const Entry& entry = entries[position - 1u];
+    if (entry.hash == hash && entry.name == name) {
+      return &entry;
+    }
+  }
+}
+
+void Registry::Snapshot::AddEntry(std::string_view name, Value value) {
+  entries.push_back(Entry{std::string(name), HashName(name), std::move(value)});
+  // keep the load factor at or below one half
+  if (entries.size() * 2u > index.size()) {
+    RebuildIndex();
+    return;
+  }
+  const std::size_t mask = index.size() - 1u;
+  std::size_t bucket = entries.back().hash & mask;
+  while (index[bucket] != 0u) {
+    bucket = (bucket + 1u) & mask;
+  }
+  index[bucket] = static_cast<std::uint32_t>(entries.size());
+}
+
+void Registry::Snapshot::RebuildIndex() {
+  std::size_t size = 16u;
+  while (size < entries.size() * 2u) {
+    size <<= 1u;
+  }
+  index.assign(size, 0u);
+  const std::size_t mask = size - 1u;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    std::size_t bucket = entries[i].hash & mask;
+    while (index[bucket] != 0u) {
+      bucket = (bucket + 1u) & mask;
+    }
+    index[bucket] = static_cast<std::uint32_t>(i + 1u);
+  }
+}
+
+Registry::Registry()
+    : snapshot_(std::make_unique<const Snapshot>()),
+      generation_(0u),
+      notifying_(false),
+      queued_generation_(0u),
+      delivered_generation_(0u),
+      stop_(false),
+      next_subscription_id_(1u) {}
+
+Registry::~Registry() {
+  {
+    std::lock_guard<std::mutex> lock(notify_mutex_);
+    stop_ = true;
+  }
+  notify_wake_.notify_one();
+  if (notify_thread_.joinable()) {
+    notify_thread_.join();
+  }
+}
+
+common::ErrorOr<Value> Registry::GetValue(std::string_view name) const {
+  common::RcuReadLock lock;
+  const Value* value = snapshot_.Load()->Find(name);
+  if (value == nullptr) {
+    return common::Error::kNotFound;
+  }
+  return *value;
+}
+
+std::size_t Registry::size() const {
+  common::RcuReadLock lock;
+  return snapshot_.Load()->entries.size();
+}
+
+std::atomic<std::uint64_t>* Registry::Slot(std::size_t position) const {
+  while (slot_chunks_.size() <= position / kSlotsPerChunk) {
+    slot_chunks_.push_back(std::make_unique<SlotChunk>());
+  }
+  return &slot_chunks_[position / kSlotsPerChunk]
+              ->slots[position % kSlotsPerChunk];
+}
+
+common::ErrorOr<Value> Registry::RegisterValue(std::string_view name,
+                                               Value value) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  // writers are serialized, the current snapshot cannot be retired under us
+  const Snapshot* current = snapshot_.Load();
+  const Value* existing = current->Find(name);
+  if (existing != nullptr) {
+    if (!existing->HasSameType(value)) {
+      return common::Error::kInvalidArgument;
+    }
+    return *existing;
+  }
+  if (value.type() != TypeEnum::kString) {
+    Slot(current->entries.size())
+        ->store(value.Bits(), std::memory_order_relaxed);
+  }
+  std::unique_ptr<Snapshot> next = std::make_unique<Snapshot>(*current);
+  next->AddEntry(name, value);
+  PublishLocked(std::move(next),
+                {static_cast<std::uint32_t>(current->entries.size())});
+  return value;
+}
+
+common::ErrorOr<Value> Registry::SetValue(std::string_view name, Value value) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  const Snapshot* current = snapshot_.Load();
+  const Entry* existing = current->FindEntry(name);
+  if (existing == nullptr) {
+    return common::Error::kNotFound;
+  }
+  if (!existing->value.HasSameType(value)) {
+    return common::Error::kInvalidArgument;
+  }
+  const std::size_t position = existing - current->entries.data();
+  Value previous = existing->value;
+  if (value.type() != TypeEnum::kString) {
+    Slot(position)->store(value.Bits(), std::memory_order_relaxed);
+  }
+  std::unique_ptr<Snapshot> next = std::make_unique<Snapshot>(*current);
+  next->entries[position].value = std::move(value);
+  PublishLocked(std::move(next), {static_cast<std::uint32_t>(position)});
+  return previous;
+}
+
+common::ErrorOr<std::size_t> Registry::Apply(const RegistryUpdate& update) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  const Snapshot* current = snapshot_.Load();
+  std::vector<std::uint32_t> positions;
+  positions.reserve(update.changes_.size());
+  // check everything before changing anything
+  for (const Change& change : update.changes_) {
+    const Entry* existing = current->FindEntry(change.first);
+    if (existing == nullptr) {
+      return common::Error::kNotFound;
+    }
+    if (!existing->value.HasSameType(change.second)) {
+      return common::Error::kInvalidArgument;
+    }
+    positions.push_back(
+        static_cast<std::uint32_t>(existing - current->entries.data()));
+  }
+  if (positions.empty()) {
+    return std::size_t{0};
+  }
+  std::unique_ptr<Snapshot> next = std::make_unique<Snapshot>(*current);
+  for (std::size_t i = 0; i < positions.size(); ++i) {
+    const Value& value = update.changes_[i].second;
+    if (value.type() != TypeEnum::kString) {
+      Slot(positions[i])->store(value.Bits(), std::memory_order_relaxed);
+    }
+    next->entries[positions[i]].value = value;
+  }
+  PublishLocked(std::move(next), positions);
+  return positions.size();
+}
+
+void Registry::PublishLocked(std::unique_ptr<Snapshot> next,
+                             const std::vector<std::uint32_t>& positions) {
+  const std::uint64_t generation =
+      generation_.load(std::memory_order_relaxed) + 1u;
+  next->generation = generation;
+  snapshot_.Publish(std::move(next));
+  generation_.store(generation, std::memory_order_release);
+  if (!notifying_.load(std::memory_order_acquire)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(notify_mutex_);
+    pending_.insert(pending_.end(), positions.begin(), positions.end());
+    queued_generation_ = generation;
+  }
+  notify_wake_.notify_one();
+}
+
+Registry::SubscriptionId Registry::AddSubscription(TypeEnum type,
+                                                   Deliver deliver) {
+  SubscriptionId id;
+  {
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    id = next_subscription_id_++;
+    subscriptions_.push_back(Subscription{id, type, std::move(deliver)});
+  }
+  std::lock_guard<std::mutex> lock(notify_mutex_);
+  if (!notify_thread_.joinable()) {
+    notify_thread_ = std::thread(&Registry::NotifyLoop, this);
+    notifying_.store(true, std::memory_order_release);
+  }
+  return id;
+}
+
+void Registry::Unsubscribe(SubscriptionId id) {
+  std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+  subscriptions_.erase(
+      std::remove_if(subscriptions_.begin(), subscriptions_.end(),
+                     [id](const Subscription& subscription) {
+                       return subscription.id == id;
+                     }),
+      subscriptions_.end());
+}
+
+void Registry::WaitForNotifications() {
+  std::unique_lock<std::mutex> lock(notify_mutex_);
+  const std::uint64_t target = queued_generation_;
+  notify_done_.wait(lock,
+                    [this, target] { return delivered_generation_ >= target; });
+}
+
+void Registry::NotifyLoop() {
+  std::unique_lock<std::mutex> lock(notify_mutex_);
+  while (true) {
+    notify_wake_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    // everything queued while the previous wave ran goes into this one
+    std::vector<std::uint32_t> positions;
+    positions.swap(pending_);
+    const std::uint64_t target = queued_generation_;
+    lock.unlock();
+    DeliverChanges(std::move(positions));
+    lock.lock();
+    delivered_generation_ = target;
+    notify_done_.notify_all();
+  }
+}
+
+void Registry::DeliverChanges(std::vector<std::uint32_t> positions) {
+  std::sort(positions.begin(), positions.end());
+  positions.erase(std::unique(positions.begin(), positions.end()),
+                  positions.end());
+  // copied out of the snapshot so that callbacks run outside the read lock
+  std::array<std::vector<Change>, kNumTypes> changes;
+  std::uint64_t generation;
+  {
+    common::RcuReadLock lock;
+    const Snapshot* snapshot = snapshot_.Load();
+    generation = snapshot->generation;
+    for (std::uint32_t position : positions) {
+      const Entry& entry = snapshot->entries[position];
+      changes[static_cast<std::size_t>(entry.value.type())].emplace_back(
+          entry.name, entry.value);
+    }
+  }
+  std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+  for (const Subscription& subscription : subscriptions_) {
+    const std::vector<Change>& typed =
+        changes[static_cast<std::size_t>(subscription.type)];
+    if (!typed.empty()) {
+      subscription.deliver(generation, typed);
+    }
+  }
+}
+
+}  // namespace registry
@@ -0,0 +1,320 @@
+#ifndef REGISTRY_REGISTRY_H_
+#define REGISTRY_REGISTRY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/error.h"
+#include "common/error_or.h"
+#include "common/rcu.h"
+#include "common/type_traits.h"
+#include "common/value.h"
+
+namespace registry {
+
+/// @class RegistryHandle
+/// A registered scalar or enum value, resolved by name once with
+/// Registry::Resolve(). Reading it is a single relaxed atomic load, with no
+/// hashing or RCU critical section. Handles stay valid as long as their
+/// registry.
+template <typename T>
+class RegistryHandle {
+  static_assert(internal::IsScalarValue<T>::value,
+                "Handles hold scalars and enums, read strings with "
+                "Registry::Get()");
+
+ public:
+  T Get() const {
+    return Value::FromBits<T>(slot_->load(std::memory_order_relaxed));
+  }
+
+ private:
+  friend class Registry;
+
+  explicit RegistryHandle(const std::atomic<std::uint64_t>* slot)
+      : slot_(slot) {}
+
+  const std::atomic<std::uint64_t>* slot_;
+};
+
+/// Changes delivered to a Registry subscription. Changes are coalesced: a
+/// name appears once, with its value at @p generation, however many times it
+/// changed since the previous batch.
+template <typename T>
+struct ChangeBatch {
+  std::uint64_t generation;
+  std::vector<std::pair<std::string, T>> changes;
+};
+
+/// @class RegistryUpdate
+/// Values to change together with Registry::Apply(), which publishes them as
+/// one snapshot and one notification batch
+class RegistryUpdate {
+ public:
+  template <typename T>
+  RegistryUpdate& Set(std::string_view name, T value) {
+    static_assert(!std::is_same<T, std::string_view>::value,
+                  "Set strings as std::string, like Registry::Set()");
+    changes_.emplace_back(std::string(name), Value(value));
+    return *this;
+  }
+
+  std::size_t size() const { return changes_.size(); }
+  bool empty() const { return changes_.empty(); }
+
+ private:
+  friend class Registry;
+
+  std::vector<std::pair<std::string, Value>> changes_;
+};
+
+/// @class Registry
+/// Named, typed values. Readers look values up without taking a mutex or
+/// allocating: they load an immutable snapshot of every entry inside an
+/// RcuReadLock. Writers serialize on a mutex, copy the snapshot, change the
+/// copy and publish it; the snapshot they replaced is deleted once no reader
+/// can see it, so updates never wait for readers. Updates cost a copy of
+/// the snapshot and are meant to be rare compared to reads.
+///
+/// Scalars and enums are also mirrored into a dense array of atomic words,
+/// in registration order, that RegistryHandle reads directly. The array is
+/// allocated in page sized chunks that never move, eight values to a cache
+/// line: values change rarely, so packing them keeps more of them cached
+/// for readers rather than padding against false sharing.
+///
+/// Every published snapshot increments generation(), so a cache of values
+/// is checked with one relaxed load. Subscriptions receive changes in
+/// batches from a notifier thread, started by the first Subscribe(): writers
+/// only queue the positions they changed, and each wave reads the latest
+/// values of everything queued since the previous one.
+class Registry {
+ public:
+  using SubscriptionId = std::uint64_t;
+
+  Registry();
+  ~Registry();
+
+  Registry(const Registry&) = delete;
+  Registry& operator=(const Registry&) = delete;
+
+  /// Adds @p name with the value @p default_value. Registering a name again
+  /// with the same type keeps the current value.
+  /// @return  the current value, or Error::kInvalidArgument if @p name is
+  ///          registered with another type
+  template <typename T>
+  common::ErrorOr<T> Register(std::string_view name,
+                              T default_value = TypeTrait<T>::default_value) {
+    static_assert(!std::is_same<T, std::string_view>::value,
+                  "A view would outlive the snapshot, use std::string");
+    common::ErrorOr<Value> value = RegisterValue(name, Value(default_value));
+    if (value.HasError()) {
+      return value.ErrorOrDie();
+    }
+    return value.ValueOrDie().template Get<T>();
+  }
+
+  /// Changes the value of a registered name
+  /// @return  the previous value, Error::kNotFound if @p name is not
+  ///          registered or Error::kInvalidArgument if it has another type
+  template <typename T>
+  common::ErrorOr<T> Set(std::string_view name, T value) {
+    static_assert(!std::is_same<T, std::string_view>::value,
+                  "A view would outlive the snapshot, use std::string");
+    common::ErrorOr<Value> previous = SetValue(name, Value(value));
+    if (previous.HasError()) {
+      return previous.ErrorOrDie();
+    }
+    return previous.ValueOrDie().template Get<T>();
+  }
+
+  /// Changes every value of @p update at once: either all of them are set,
+  /// in a single snapshot and notification batch, or none is. A name set
+  /// more than once takes its last value.
+  /// @return  the number of values set, Error::kNotFound if a name is not
+  ///          registered or Error::kInvalidArgument if it has another type
+  common::ErrorOr<std::size_t> Apply(const RegistryUpdate& update);
+
+  /// @return  the number of snapshots published so far. A relaxed load: it
+  ///          tells that values changed, read them with Get() or a handle.
+  std::uint64_t generation() const {
+    return generation_.load(std::memory_order_relaxed);
+  }
+
+  /// Calls @p callback on the notifier thread with the registrations and
+  /// changes of entries of type T, checked like Get<T>(), that are named in
+  /// @p names, or of every such entry if @p names is empty. Only changes
+  /// published after the call are delivered. Callbacks run one at a time and
+  /// may change the registry, but must not subscribe, unsubscribe or wait
+  /// for notifications.
+  /// @return  the id to pass to Unsubscribe()
+  template <typename T>
+  SubscriptionId Subscribe(std::function<void(const ChangeBatch<T>&)> callback,
+                           std::vector<std::string> names = {}) {
+    return AddSubscription(
+        TypeTrait<T>::type,
+        [callback = std::move(callback), names = std::move(names)](
+            std::uint64_t generation, const std::vector<Change>& changes) {
+          ChangeBatch<T> batch{generation, {}};
+          for (const Change& change : changes) {
+            if (change.second.template Is<T>() &&
+                (names.empty() || std::find(names.begin(), names.end(),
+                                            change.first) != names.end())) {
+              batch.changes.emplace_back(
+                  change.first, change.second.template Get<T>().ValueOrDie());
+            }
+          }
+          if (!batch.changes.empty()) {
+            callback(batch);
+          }
+        });
+  }
+
+  /// Removes a subscription. Once this returns its callback is not running
+  /// and will not be called again.
+  void Unsubscribe(SubscriptionId id);
+
+  /// Blocks until every change published before the call has been delivered
+  /// to the subscriptions.
+  void WaitForNotifications();
+
+  /// Lock-free lookup, checked against TypeTrait<T>::type. Reading a
+  /// std::string copies it, every other type is read without allocating.
+  /// @return  the value, Error::kNotFound if @p name is not registered or
+  ///          Error::kInvalidArgument if it has another type
+  template <typename T>
+  common::ErrorOr<T> Get(std::string_view name) const {
+    static_assert(!std::is_same<T, std::string_view>::value,
+                  "A view would outlive the snapshot, use std::string");
+    common::RcuReadLock lock;
+    const Value* value = snapshot_.Load()->Find(name);
+    if (value == nullptr) {
+      return common::Error::kNotFound;
+    }
+    return value->Get<T>();
+  }
+
+  /// Resolves @p name to a handle, checked against TypeTrait<T>::type. Meant
+  /// to be called once, e.g. at startup; it takes the writer mutex.
+  /// @return  the handle, Error::kNotFound if @p name is not registered or
+  ///          Error::kInvalidArgument if it has another type
+  template <typename T>
+  common::ErrorOr<RegistryHandle<T>> Resolve(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    const Snapshot* snapshot = snapshot_.Load();
+    const Entry* entry = snapshot->FindEntry(name);
+    if (entry == nullptr) {
+      return common::Error::kNotFound;
+    }
+    if (!entry->value.template Is<T>()) {
+      return common::Error::kInvalidArgument;
+    }
+    return RegistryHandle<T>(Slot(entry - snapshot->entries.data()));
+  }
+
+  /// Calls @p f with the name and value of every entry, in registration
+  /// order, from a single snapshot. @p f runs inside an RcuReadLock and must
+  /// not keep references to its arguments.
+  template <typename F>
+  void ForEach(F&& f) const {
+    common::RcuReadLock lock;
+    for (const Entry& entry : snapshot_.Load()->entries) {
+      f(std::string_view(entry.name), entry.value);
+    }
+  }
+
+  /// @return  a copy of the value of @p name, or Error::kNotFound
+  common::ErrorOr<Value> GetValue(std::string_view name) const;
+
+  /// @return  the number of registered names
+  std::size_t size() const;
+
+ private:
+  struct Entry {
+    std::string name;
+    std::uint64_t hash;
+    Value value;
+  };
+
+  // Immutable once published. Entries keep their registration order, the
+  // index is open addressing over entry positions.
+  struct Snapshot {
+    const Value* Find(std::string_view name) const;
+    // nullptr if absent
+    const Entry* FindEntry(std::string_view name) const;
+    void AddEntry(std::string_view name, Value value);
+    void RebuildIndex();
+
+    std::vector<Entry> entries;
+    // entry position + 1, 0 for empty buckets; size is a power of two
+    std::vector<std::uint32_t> index;
+    std::uint64_t generation = 0u;
+  };
+
+  using Change = std::pair<std::string, Value>;
+  using Deliver =
+      std::function<void(std::uint64_t, const std::vector<Change>&)>;
+
+  struct Subscription {
+    SubscriptionId id;
+    TypeEnum type;
+    Deliver deliver;
+  };
+
+  common::ErrorOr<Value> RegisterValue(std::string_view name, Value value);
+  common::ErrorOr<Value> SetValue(std::string_view name, Value value);
+  // Publishes @p next, which changed the entries at @p positions, as the
+  // next generation. Called with write_mutex_ held.
+  void PublishLocked(std::unique_ptr<Snapshot> next,
+                     const std::vector<std::uint32_t>& positions);
+  SubscriptionId AddSubscription(TypeEnum type, Deliver deliver);
+  void NotifyLoop();
+  void DeliverChanges(std::vector<std::uint32_t> positions);
+
+  constexpr static std::size_t kSlotsPerChunk = 512u;
+
+  struct alignas(64) SlotChunk {
+    std::atomic<std::uint64_t> slots[kSlotsPerChunk];
+  };
+
+  // the handle slot of the entry at @p position, allocated on demand
+  std::atomic<std::uint64_t>* Slot(std::size_t position) const;
+
+  common::RcuCell<Snapshot> snapshot_;
+  // serializes writers and guards slot_chunks_, never taken by readers
+  mutable std::mutex write_mutex_;
+  mutable std::vector<std::unique_ptr<SlotChunk>> slot_chunks_;
+  std::atomic<std::uint64_t> generation_;
+
+  // set once there is a subscription, writers queue nothing before
+  std::atomic<bool> notifying_;
+  // guards the queue and the notifier thread state
+  std::mutex notify_mutex_;
+  std::condition_variable notify_wake_;
+  std::condition_variable notify_done_;
+  // entry positions changed since the last wave, possibly repeated
+  std::vector<std::uint32_t> pending_;
+  std::uint64_t queued_generation_;
+  std::uint64_t delivered_generation_;
+  bool stop_;
+  std::thread notify_thread_;
+
+  // held while callbacks run, so that Unsubscribe() waits for them
+  std::mutex subscriptions_mutex_;
+  std::vector<Subscription> subscriptions_;
+  SubscriptionId next_subscription_id_;
+};
+
+}  // namespace registry
+
+#endif  // REGISTRY_REGISTRY_H_
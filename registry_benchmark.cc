@@ -0,0 +1,104 @@
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "common/registry.h"
+
+namespace registry {
+namespace {
+
+constexpr int kEntries = 10000;
+
+std::string Name(int i) { return "service.setting." + std::to_string(i); }
+
+Registry& SharedRegistry() {
+  static Registry* registry = [] {
+    Registry* registry = new Registry();
+    for (int i = 0; i < kEntries; ++i) {
+      registry->Register<int64_t>(Name(i), i);
+    }
+    return registry;
+  }();
+  return *registry;
+}
+
+void BM_GetByName(benchmark::State& state) {
+  const Registry& registry = SharedRegistry();
+  const std::string name = Name(state.thread_index() * 97 % kEntries);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(registry.Get<int64_t>(name));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetByName)->ThreadRange(1, 8);
+
+void BM_GetByHandle(benchmark::State& state) {
+  const RegistryHandle<int64_t> handle =
+      SharedRegistry()
+          .Resolve<int64_t>(Name(state.thread_index() * 97 % kEntries))
+          .ValueOrDie();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(handle.Get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetByHandle)->ThreadRange(1, 8);
+
+// Updates one entry from a background thread while the benchmark threads
+// read, started and stopped by benchmark thread 0
+class BackgroundWriter {
+ public:
+  explicit BackgroundWriter(const benchmark::State& state)
+      : owner_(state.thread_index() == 0) {
+    if (owner_) {
+      stop_.store(false);
+      thread_ = std::thread([] {
+        for (int64_t i = 0; !stop_.load(std::memory_order_relaxed); ++i) {
+          SharedRegistry().Set<int64_t>(Name(0), i);
+        }
+      });
+    }
+  }
+
+  ~BackgroundWriter() {
+    if (owner_) {
+      stop_.store(true);
+      thread_.join();
+    }
+  }
+
+ private:
+  static std::atomic<bool> stop_;
+  const bool owner_;
+  std::thread thread_;
+};
+
+std::atomic<bool> BackgroundWriter::stop_{false};
+
+void BM_GetByNameWhileWriting(benchmark::State& state) {
+  const Registry& registry = SharedRegistry();
+  const std::string name = Name(state.thread_index() * 97 % kEntries);
+  BackgroundWriter writer(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(registry.Get<int64_t>(name));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetByNameWhileWriting)->ThreadRange(1, 8);
+
+void BM_GetByHandleWhileWriting(benchmark::State& state) {
+  const RegistryHandle<int64_t> handle =
+      SharedRegistry()
+          .Resolve<int64_t>(Name(state.thread_index() * 97 % kEntries))
+          .ValueOrDie();
+  BackgroundWriter writer(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(handle.Get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetByHandleWhileWriting)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace registry
@@ -0,0 +1,350 @@
+#include "common/registry_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace registry {
+
+namespace {
+
+constexpr std::uint8_t kNumTypes =
+    static_cast<std::uint8_t>(TypeEnum::kEnum) + 1u;
+
+std::uint64_t Checksum(const char* data, std::size_t size) {
+  // FNV-1a
+  std::uint64_t hash = 0xCBF29CE484222325ull;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+std::size_t AlignUp(std::size_t offset, std::size_t alignment) {
+  return (offset + alignment - 1u) / alignment * alignment;
+}
+
+template <typename T>
+void Put(std::string* out, std::size_t offset, const T& value) {
+  std::memcpy(&(*out)[offset], &value, sizeof(value));
+}
+
+struct PendingEntry {
+  std::string_view name;
+  std::uint8_t type;
+  std::uint64_t bits;
+};
+
+}  // namespace
+
+common::ErrorOr<std::string> SerializeSnapshot(const Registry& registry) {
+  // names and string values are copied while the registry snapshot is held
+  std::string names;
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> name_spans;
+  std::vector<PendingEntry> entries;
+  registry.ForEach([&](std::string_view name, const Value& value) {
+    PendingEntry entry{std::string_view(),
+                       static_cast<std::uint8_t>(value.type()), value.Bits()};
+    if (value.type() == TypeEnum::kString) {
+      const std::string_view text =
+          value.Get<std::string_view>().ValueOrDie();
+      entry.bits = static_cast<std::uint64_t>(names.size()) << 32 |
+                   static_cast<std::uint64_t>(text.size());
+      names.append(text.data(), text.size());
+    }
+    name_spans.emplace_back(names.size(), name.size());
+    names.append(name.data(), name.size());
+    entries.push_back(entry);
+  });
+  // name offsets, name sizes, string value spans and the count are stored
+  // in 32 bits
+  if (entries.size() > std::numeric_limits<std::uint32_t>::max() ||
+      names.size() > std::numeric_limits<std::uint32_t>::max()) {
+    return common::Error::kOutOfRange;
+  }
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    entries[i].name =
+        std::string_view(names.data() + name_spans[i].first,
+                         static_cast<std::size_t>(name_spans[i].second));
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const PendingEntry& a, const PendingEntry& b) {
+              return a.name < b.name;
+            });
+
+  const std::size_t count = entries.size();
+  SnapshotHeader header;
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.count = static_cast<std::uint32_t>(count);
+  header.index_offset = sizeof(SnapshotHeader);
+  header.values_offset =
+      AlignUp(header.index_offset + count * 2u * sizeof(std::uint32_t), 8u);
+  header.types_offset = header.values_offset + count * sizeof(std::uint64_t);
+  header.names_offset = header.types_offset + count;
+  header.file_size = header.names_offset + names.size();
+
+  std::string out(header.file_size, '\0');
+  for (std::size_t i = 0; i < count; ++i) {
+    const PendingEntry& entry = entries[i];
+    const std::uint32_t name[2] = {
+        static_cast<std::uint32_t>(entry.name.data() - names.data()),
+        static_cast<std::uint32_t>(entry.name.size())};
+    Put(&out, header.index_offset + i * sizeof(name), name);
+    Put(&out, header.values_offset + i * sizeof(std::uint64_t), entry.bits);
+    out[header.types_offset + i] = static_cast<char>(entry.type);
+  }
+  std::memcpy(&out[header.names_offset], names.data(), names.size());
+  header.checksum = Checksum(out.data() + sizeof(SnapshotHeader),
+                             out.size() - sizeof(SnapshotHeader));
+  Put(&out, 0u, header);
+  return out;
+}
+
+common::ErrorOr<std::size_t> WriteSnapshot(const Registry& registry,
+                                           const std::string& path) {
+  const common::ErrorOr<std::string> serialized = SerializeSnapshot(registry);
+  if (serialized.HasError()) {
+    return serialized.ErrorOrDie();
+  }
+  const std::string& data = serialized.ValueOrDie();
+  // unique, so that concurrent writers of @p path do not share it
+  std::string temporary = path + ".XXXXXX";
+  const int fd = mkstemp(&temporary[0]);
+  if (fd < 0) {
+    return common::Error::kUnavailable;
+  }
+  // mkstemp() creates the file readable by its owner only
+  bool written = fchmod(fd, 0644) == 0;
+  for (std::size_t offset = 0u; written && offset < data.size();) {
+    const ssize_t result =
+        write(fd, data.data() + offset, data.size() - offset);
+    if (result < 0 && errno != EINTR) {
+      written = false;
+    } else if (result > 0) {
+      offset += static_cast<std::size_t>(result);
+    }
+  }
+  // the data reaches the disk before the rename can
+  written = written && fsync(fd) == 0;
+  if (close(fd) != 0 || !written ||
+      std::rename(temporary.c_str(), path.c_str()) != 0) {
+    unlink(temporary.c_str());
+    return common::Error::kUnavailable;
+  }
+  return data.size();
+}
+
+RegistrySnapshot::RegistrySnapshot(const char* data, std::size_t size,
+                                   bool mapped)
+    : data_(data),
+      size_(size),
+      mapped_(mapped),
+      count_(0u),
+      index_(nullptr),
+      values_(nullptr),
+      types_(nullptr),
+      names_(nullptr),
+      names_size_(0u) {}
+
+RegistrySnapshot::RegistrySnapshot(RegistrySnapshot&& other) noexcept
+    : RegistrySnapshot(nullptr, 0u, false) {
+  *this = std::move(other);
+}
+
+RegistrySnapshot& RegistrySnapshot::operator=(
+    RegistrySnapshot&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    data_ = other.data_;
+    size_ = other.size_;
+    mapped_ = other.mapped_;
+    count_ = other.count_;
+    index_ = other.index_;
+    values_ = other.values_;
+    types_ = other.types_;
+    names_ = other.names_;
+    names_size_ = other.names_size_;
+    other.mapped_ = false;
+    other.data_ = nullptr;
+    other.size_ = 0u;
+    other.count_ = 0u;
+  }
+  return *this;
+}
+
+RegistrySnapshot::~RegistrySnapshot() { Unmap(); }
+
+void RegistrySnapshot::Unmap() {
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+    mapped_ = false;
+  }
+}
+
+common::ErrorOr<RegistrySnapshot> RegistrySnapshot::Open(
+    const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return errno == ENOENT ? common::Error::kNotFound
+                           : common::Error::kUnavailable;
+  }
+  struct stat status;
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    return common::Error::kUnavailable;
+  }
+  const std::size_t size = static_cast<std::size_t>(status.st_size);
+  if (size < sizeof(SnapshotHeader)) {
+    close(fd);
+    return common::Error::kInvalidArgument;
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file alive
+  close(fd);
+  if (data == MAP_FAILED) {
+    return common::Error::kUnavailable;
+  }
+  return Create(static_cast<const char*>(data), size, true);
+}
+
+common::ErrorOr<RegistrySnapshot> RegistrySnapshot::FromBuffer(
+    const void* data, std::size_t size) {
+  if (reinterpret_cast<std::uintptr_t>(data) % 8u != 0u) {
+    return common::Error::kInvalidArgument;
+  }
+  return Create(static_cast<const char*>(data), size, false);
+}
+
+common::ErrorOr<RegistrySnapshot> RegistrySnapshot::Create(const char* data,
+                                                           std::size_t size,
+                                                           bool mapped) {
+  // owns the mapping from here on, also on error
+  RegistrySnapshot snapshot(data, size, mapped);
+  if (size < sizeof(SnapshotHeader)) {
+    return common::Error::kInvalidArgument;
+  }
+  SnapshotHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  const std::uint64_t count = header.count;
+  // each check is written so that it cannot overflow
+  if (std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) != 0 ||
+      header.version != kSnapshotVersion || header.file_size != size ||
+      header.index_offset < sizeof(SnapshotHeader) ||
+      header.index_offset % 4u != 0u || header.index_offset > size ||
+      (size - header.index_offset) / 8u < count ||
+      header.values_offset < header.index_offset + count * 8u ||
+      header.values_offset % 8u != 0u || header.values_offset > size ||
+      (size - header.values_offset) / 8u < count ||
+      header.types_offset < header.values_offset + count * 8u ||
+      header.types_offset > size || size - header.types_offset < count ||
+      header.names_offset < header.types_offset + count ||
+      header.names_offset > size) {
+    return common::Error::kInvalidArgument;
+  }
+  snapshot.count_ = header.count;
+  snapshot.index_ =
+      reinterpret_cast<const std::uint32_t*>(data + header.index_offset);
+  snapshot.values_ =
+      reinterpret_cast<const std::uint64_t*>(data + header.values_offset);
+  snapshot.types_ =
+      reinterpret_cast<const std::uint8_t*>(data + header.types_offset);
+  snapshot.names_ = data + header.names_offset;
+  snapshot.names_size_ = size - header.names_offset;
+  return snapshot;
+}
+
+common::ErrorOr<std::size_t> RegistrySnapshot::Validate() const {
+  // a moved from snapshot has no data
+  if (data_ == nullptr || size_ < sizeof(SnapshotHeader)) {
+    return common::Error::kInvalidArgument;
+  }
+  SnapshotHeader header;
+  std::memcpy(&header, data_, sizeof(header));
+  if (Checksum(data_ + sizeof(SnapshotHeader),
+               size_ - sizeof(SnapshotHeader)) != header.checksum) {
+    return common::Error::kInvalidArgument;
+  }
+  std::string_view previous;
+  for (std::size_t i = 0; i < count_; ++i) {
+    common::ErrorOr<std::string_view> name = NameAt(i);
+    if (name.HasError()) {
+      return name.ErrorOrDie();
+    }
+    if (i > 0u && !(previous < name.ValueOrDie())) {
+      return common::Error::kInvalidArgument;
+    }
+    previous = name.ValueOrDie();
+    if (types_[i] >= kNumTypes) {
+      return common::Error::kInvalidArgument;
+    }
+    if (types_[i] == static_cast<std::uint8_t>(TypeEnum::kString) &&
+        StringAt(i).HasError()) {
+      return common::Error::kInvalidArgument;
+    }
+  }
+  return count_;
+}
+
+common::ErrorOr<std::string_view> RegistrySnapshot::NameAt(
+    std::size_t i) const {
+  if (i >= count_) {
+    return common::Error::kInvalidArgument;
+  }
+  return NamesAreaView(index_[2u * i], index_[2u * i + 1u]);
+}
+
+common::ErrorOr<TypeEnum> RegistrySnapshot::TypeAt(std::size_t i) const {
+  if (i >= count_ || types_[i] >= kNumTypes) {
+    return common::Error::kInvalidArgument;
+  }
+  return static_cast<TypeEnum>(types_[i]);
+}
+
+common::ErrorOr<std::size_t> RegistrySnapshot::Find(
+    std::string_view name) const {
+  std::size_t low = 0u;
+  std::size_t high = count_;
+  while (low < high) {
+    const std::size_t mid = low + (high - low) / 2u;
+    common::ErrorOr<std::string_view> candidate = NameAt(mid);
+    if (candidate.HasError()) {
+      return candidate.ErrorOrDie();
+    }
+    const int order = candidate.ValueOrDie().compare(name);
+    if (order == 0) {
+      return mid;
+    }
+    if (order < 0) {
+      low = mid + 1u;
+    } else {
+      high = mid;
+    }
+  }
+  return common::Error::kNotFound;
+}
+
+common::ErrorOr<std::string_view> RegistrySnapshot::NamesAreaView(
+    std::uint64_t offset, std::uint64_t size) const {
+  if (offset > names_size_ || size > names_size_ - offset) {
+    return common::Error::kInvalidArgument;
+  }
+  return std::string_view(names_ + offset, static_cast<std::size_t>(size));
+}
+
+common::ErrorOr<std::string_view> RegistrySnapshot::StringAt(
+    std::size_t i) const {
+  return NamesAreaView(values_[i] >> 32, values_[i] & 0xFFFFFFFFu);
+}
+
+}  // namespace registry
@@ -0,0 +1,172 @@
+#ifndef REGISTRY_REGISTRY_SNAPSHOT_H_
+#define REGISTRY_REGISTRY_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "common/error.h"
+#include "common/error_or.h"
+#include "common/registry.h"
+#include "common/type_traits.h"
+#include "common/value.h"
+
+namespace registry {
+
+/// Binary snapshot of registry values, read in place from a mapped file.
+/// All offsets are from the start of the file, integers are in host byte
+/// order and the magic doubles as a byte order check.
+///
+///   header   SnapshotHeader
+///   index    count x {uint32 name offset, uint32 name size}, sorted by name
+///   values   count x uint64, 8 byte aligned: Value::Bits(), or for strings
+///            the offset of the string in the names area << 32 | its size
+///   types    count x uint8 TypeEnum
+///   names    names and string values, name and string offsets are
+///            relative to the start of this area
+///
+/// Entry i of the values and types columns belongs to index entry i. Enums
+/// are stored as their integer value; the enum type is not recorded. The
+/// names area is limited to 4 GiB by its 32 bit offsets.
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t count;
+  std::uint64_t file_size;
+  // FNV-1a of every byte after the header
+  std::uint64_t checksum;
+  std::uint64_t index_offset;
+  std::uint64_t values_offset;
+  std::uint64_t types_offset;
+  std::uint64_t names_offset;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64u, "SnapshotHeader is 64 bytes");
+
+constexpr char kSnapshotMagic[8] = {'R', 'E', 'G', 'S', 'N', 'A', 'P', '\x01'};
+constexpr std::uint32_t kSnapshotVersion = 1u;
+
+/// @return  the snapshot of every entry of @p registry, or
+///          Error::kOutOfRange if the registry has 2^32 entries or more, or
+///          names and string values of 4 GiB or more
+common::ErrorOr<std::string> SerializeSnapshot(const Registry& registry);
+
+/// Writes SerializeSnapshot() to @p path, through a uniquely named temporary
+/// file that is synced and then renamed over @p path, so that readers never
+/// map a partial file, even after a crash. The file is created with mode 0644.
+/// @return  the size of the file, Error::kOutOfRange if the registry does
+///          not fit the format, or Error::kUnavailable if it could not be
+///          written
+common::ErrorOr<std::size_t> WriteSnapshot(const Registry& registry,
+                                           const std::string& path);
+
+/// @class RegistrySnapshot
+/// Read-only view of a snapshot, mapped from a file or over a caller owned
+/// buffer. Opening checks only the header; every lookup bounds checks what
+/// it reads, so a corrupt file yields Error::kInvalidArgument on access
+/// rather than on open. Validate() checks everything up front. Lookups are a
+/// binary search over the sorted index and never allocate or copy, except
+/// Get<std::string>().
+class RegistrySnapshot {
+ public:
+  /// Maps @p path read-only
+  /// @return  the snapshot, Error::kNotFound if the file does not exist,
+  ///          Error::kUnavailable if it cannot be mapped or
+  ///          Error::kInvalidArgument if the header is invalid
+  static common::ErrorOr<RegistrySnapshot> Open(const std::string& path);
+
+  /// Views @p size bytes at @p data, which must be 8 byte aligned and
+  /// outlive the snapshot
+  static common::ErrorOr<RegistrySnapshot> FromBuffer(const void* data,
+                                                      std::size_t size);
+
+  RegistrySnapshot(RegistrySnapshot&& other) noexcept;
+  RegistrySnapshot& operator=(RegistrySnapshot&& other) noexcept;
+  ~RegistrySnapshot();
+
+  RegistrySnapshot(const RegistrySnapshot&) = delete;
+  RegistrySnapshot& operator=(const RegistrySnapshot&) = delete;
+
+  std::size_t size() const { return count_; }
+
+  /// Checks the checksum, every offset and size, the types and the order of
+  /// the index
+  /// @return  the number of entries, or Error::kInvalidArgument, also if the
+  ///          snapshot was moved from
+  common::ErrorOr<std::size_t> Validate() const;
+
+  /// @return  the name of entry @p i, in name order, or
+  ///          Error::kInvalidArgument if it is out of bounds
+  common::ErrorOr<std::string_view> NameAt(std::size_t i) const;
+
+  /// @return  the type of entry @p i, or Error::kInvalidArgument
+  common::ErrorOr<TypeEnum> TypeAt(std::size_t i) const;
+
+  /// Typed lookup, checked against TypeTrait<T>::type. T may also be
+  /// std::string_view, which points into the snapshot.
+  /// @return  the value, Error::kNotFound if @p name is absent or
+  ///          Error::kInvalidArgument if it has another type or is corrupt
+  template <typename T>
+  common::ErrorOr<T> Get(std::string_view name) const {
+    static_assert(!std::is_same<T, common::Error>::value,
+                  "ErrorOr<Error> is ambiguous");
+    common::ErrorOr<std::size_t> index = Find(name);
+    if (index.HasError()) {
+      return index.ErrorOrDie();
+    }
+    const std::size_t i = index.ValueOrDie();
+    constexpr TypeEnum kType = StoredType<T>();
+    if (types_[i] != static_cast<std::uint8_t>(kType)) {
+      return common::Error::kInvalidArgument;
+    }
+    if constexpr (kType == TypeEnum::kString) {
+      common::ErrorOr<std::string_view> text = StringAt(i);
+      if (text.HasError()) {
+        return text.ErrorOrDie();
+      }
+      return T(text.ValueOrDie());
+    } else {
+      return Value::FromBits<T>(values_[i]);
+    }
+  }
+
+ private:
+  template <typename T>
+  static constexpr TypeEnum StoredType() {
+    if constexpr (std::is_same<T, std::string_view>::value) {
+      return TypeEnum::kString;
+    } else {
+      return TypeTrait<T>::type;
+    }
+  }
+
+  RegistrySnapshot(const char* data, std::size_t size, bool mapped);
+
+  static common::ErrorOr<RegistrySnapshot> Create(const char* data,
+                                                  std::size_t size,
+                                                  bool mapped);
+
+  // @return  the position of @p name in the index
+  common::ErrorOr<std::size_t> Find(std::string_view name) const;
+  common::ErrorOr<std::string_view> NamesAreaView(std::uint64_t offset,
+                                                  std::uint64_t size) const;
+  common::ErrorOr<std::string_view> StringAt(std::size_t i) const;
+  void Unmap();
+
+  const char* data_;
+  std::size_t size_;
+  // whether data_ is an mmap() owned by this snapshot
+  bool mapped_;
+  std::size_t count_;
+  const std::uint32_t* index_;
+  const std::uint64_t* values_;
+  const std::uint8_t* types_;
+  const char* names_;
+  std::size_t names_size_;
+};
+
+}  // namespace registry
+
+#endif  // REGISTRY_REGISTRY_SNAPSHOT_H_
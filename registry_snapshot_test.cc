@@ -0,0 +1,221 @@
+#include "common/registry_snapshot.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Level { kLow, kHigh };
+
+}  // namespace test_namespace
+
+namespace common {
+
+template <>
+struct EnumTrait<test_namespace::Level> {
+  constexpr static size_t num_values() { return 2; }
+  constexpr static test_namespace::Level default_value() {
+    return test_namespace::Level::kLow;
+  }
+  constexpr static const char* to_string(test_namespace::Level) {
+    return "Level";
+  }
+};
+
+}  // namespace common
+
+namespace registry {
+
+namespace {
+
+void Fill(Registry* registry) {
+  registry->Register<int32_t>("int32", -32);
+  registry->Register<uint32_t>("uint32", 32u);
+  registry->Register<int64_t>("int64", -(int64_t{1} << 40));
+  registry->Register<uint64_t>("uint64", ~uint64_t{0});
+  registry->Register<bool>("bool", true);
+  registry->Register<char>("char", 'c');
+  registry->Register<std::string>("string", "a string value");
+  registry->Register<std::string>("empty", "");
+  registry->Register<float>("float", 0.5f);
+  registry->Register<double>("double", -2.25);
+  registry->Register<test_namespace::Level>("enum",
+                                            test_namespace::Level::kHigh);
+}
+
+// 8 byte aligned copy of @p data
+std::vector<uint64_t> Aligned(const std::string& data) {
+  std::vector<uint64_t> buffer((data.size() + 7u) / 8u);
+  std::memcpy(buffer.data(), data.data(), data.size());
+  return buffer;
+}
+
+}  // namespace
+
+TEST(RegistrySnapshotTest, RoundTripTest) {
+  Registry registry;
+  Fill(&registry);
+  const std::string path = testing::TempDir() + "/registry_snapshot_test";
+  ASSERT_TRUE(WriteSnapshot(registry, path).HasValue());
+
+  common::ErrorOr<RegistrySnapshot> opened = RegistrySnapshot::Open(path);
+  ASSERT_TRUE(opened.HasValue());
+  const RegistrySnapshot& snapshot = opened.ValueOrDie();
+  EXPECT_EQ(snapshot.size(), 11u);
+  EXPECT_EQ(snapshot.Validate().ValueOrDie(), 11u);
+
+  EXPECT_EQ(snapshot.Get<int32_t>("int32").ValueOrDie(), -32);
+  EXPECT_EQ(snapshot.Get<uint32_t>("uint32").ValueOrDie(), 32u);
+  EXPECT_EQ(snapshot.Get<int64_t>("int64").ValueOrDie(), -(int64_t{1} << 40));
+  EXPECT_EQ(snapshot.Get<uint64_t>("uint64").ValueOrDie(), ~uint64_t{0});
+  EXPECT_TRUE(snapshot.Get<bool>("bool").ValueOrDie());
+  EXPECT_EQ(snapshot.Get<char>("char").ValueOrDie(), 'c');
+  EXPECT_EQ(snapshot.Get<std::string_view>("string").ValueOrDie(),
+            "a string value");
+  EXPECT_EQ(snapshot.Get<std::string>("empty").ValueOrDie(), "");
+  EXPECT_EQ(snapshot.Get<float>("float").ValueOrDie(), 0.5f);
+  EXPECT_EQ(snapshot.Get<double>("double").ValueOrDie(), -2.25);
+  EXPECT_EQ(snapshot.Get<test_namespace::Level>("enum").ValueOrDie(),
+            test_namespace::Level::kHigh);
+
+  EXPECT_EQ(snapshot.Get<int32_t>("missing").ErrorOrDie(),
+            common::Error::kNotFound);
+  EXPECT_EQ(snapshot.Get<int64_t>("int32").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+
+  // the index is sorted by name
+  EXPECT_EQ(snapshot.NameAt(0).ValueOrDie(), "bool");
+  EXPECT_EQ(snapshot.TypeAt(0).ValueOrDie(), TypeEnum::kBoolean);
+  EXPECT_EQ(snapshot.NameAt(11).ErrorOrDie(), common::Error::kInvalidArgument);
+  std::remove(path.c_str());
+}
+
+TEST(RegistrySnapshotTest, MoveTest) {
+  Registry registry;
+  Fill(&registry);
+  const std::string path = testing::TempDir() + "/registry_snapshot_move";
+  ASSERT_TRUE(WriteSnapshot(registry, path).HasValue());
+  RegistrySnapshot snapshot = RegistrySnapshot::Open(path).MoveValueOrDie();
+  RegistrySnapshot moved = std::move(snapshot);
+  EXPECT_EQ(moved.Get<int32_t>("int32").ValueOrDie(), -32);
+  EXPECT_EQ(snapshot.size(), 0u);
+  EXPECT_EQ(snapshot.Validate().ErrorOrDie(), common::Error::kInvalidArgument);
+  EXPECT_EQ(snapshot.Get<int32_t>("int32").ErrorOrDie(),
+            common::Error::kNotFound);
+  std::remove(path.c_str());
+}
+
+TEST(RegistrySnapshotTest, WriteSnapshotTest) {
+  Registry registry;
+  Fill(&registry);
+  const std::string directory =
+      testing::TempDir() + "/registry_snapshot_write";
+  ASSERT_EQ(mkdir(directory.c_str(), 0755), 0);
+  const std::string path = directory + "/snapshot";
+  ASSERT_TRUE(WriteSnapshot(registry, path).HasValue());
+  registry.Set<int32_t>("int32", 5);
+  const std::size_t size = WriteSnapshot(registry, path).ValueOrDie();
+
+  struct stat status;
+  ASSERT_EQ(stat(path.c_str(), &status), 0);
+  EXPECT_EQ(static_cast<std::size_t>(status.st_size), size);
+  EXPECT_EQ(status.st_mode & 0777, 0644u);
+  EXPECT_EQ(RegistrySnapshot::Open(path).ValueOrDie().Get<int32_t>("int32")
+                .ValueOrDie(),
+            5);
+  // no temporary file is left behind
+  std::vector<std::string> names;
+  DIR* dir = opendir(directory.c_str());
+  ASSERT_NE(dir, nullptr);
+  while (const dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') {
+      names.emplace_back(entry->d_name);
+    }
+  }
+  closedir(dir);
+  EXPECT_EQ(names, std::vector<std::string>{"snapshot"});
+
+  EXPECT_EQ(WriteSnapshot(registry, directory + "/missing/snapshot")
+                .ErrorOrDie(),
+            common::Error::kUnavailable);
+  std::remove(path.c_str());
+  rmdir(directory.c_str());
+}
+
+TEST(RegistrySnapshotTest, OpenErrorsTest) {
+  EXPECT_EQ(RegistrySnapshot::Open(testing::TempDir() + "/does_not_exist")
+                .ErrorOrDie(),
+            common::Error::kNotFound);
+
+  Registry registry;
+  Fill(&registry);
+  const std::string data = SerializeSnapshot(registry).ValueOrDie();
+  std::vector<uint64_t> buffer = Aligned(data);
+  const std::size_t size = data.size();
+  EXPECT_TRUE(RegistrySnapshot::FromBuffer(buffer.data(), size).HasValue());
+  EXPECT_EQ(RegistrySnapshot::FromBuffer(buffer.data(), size - 1u)
+                .ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(RegistrySnapshot::FromBuffer(buffer.data(), 10u).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+
+  buffer[0] ^= 1u;  // magic
+  EXPECT_EQ(RegistrySnapshot::FromBuffer(buffer.data(), size).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+TEST(RegistrySnapshotTest, CorruptionTest) {
+  Registry registry;
+  Fill(&registry);
+  const std::string data = SerializeSnapshot(registry).ValueOrDie();
+  SnapshotHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  // a name pointing past the end of the file
+  std::vector<uint64_t> buffer = Aligned(data);
+  char* bytes = reinterpret_cast<char*>(buffer.data());
+  const uint32_t bad_offset = 1u << 30;
+  std::memcpy(bytes + header.index_offset, &bad_offset, sizeof(bad_offset));
+  RegistrySnapshot snapshot =
+      RegistrySnapshot::FromBuffer(buffer.data(), data.size())
+          .MoveValueOrDie();
+  // lookups that hit the corrupt entry fail, the others still work
+  EXPECT_EQ(snapshot.NameAt(0).ErrorOrDie(), common::Error::kInvalidArgument);
+  EXPECT_EQ(snapshot.Validate().ErrorOrDie(), common::Error::kInvalidArgument);
+
+  // a flipped value byte is caught by the checksum only
+  buffer = Aligned(data);
+  bytes = reinterpret_cast<char*>(buffer.data());
+  bytes[header.values_offset] ^= 0x40;
+  snapshot = RegistrySnapshot::FromBuffer(buffer.data(), data.size())
+                 .MoveValueOrDie();
+  EXPECT_TRUE(snapshot.Get<bool>("bool").HasValue());
+  EXPECT_EQ(snapshot.Validate().ErrorOrDie(), common::Error::kInvalidArgument);
+}
+
+TEST(RegistrySnapshotTest, ManyEntriesTest) {
+  Registry registry;
+  for (int32_t i = 0; i < 2000; ++i) {
+    registry.Register<int32_t>("key." + std::to_string(i), i);
+  }
+  const std::string data = SerializeSnapshot(registry).ValueOrDie();
+  std::vector<uint64_t> buffer = Aligned(data);
+  RegistrySnapshot snapshot =
+      RegistrySnapshot::FromBuffer(buffer.data(), data.size())
+          .MoveValueOrDie();
+  EXPECT_EQ(snapshot.Validate().ValueOrDie(), 2000u);
+  for (int32_t i = 0; i < 2000; ++i) {
+    EXPECT_EQ(snapshot.Get<int32_t>("key." + std::to_string(i)).ValueOrDie(),
+              i);
+  }
+}
+
+}  // namespace registry
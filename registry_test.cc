@@ -0,0 +1,322 @@
+#include "common/registry.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Mode { kOff, kOn, kAuto };
+
+}  // namespace test_namespace
+
+namespace common {
+
+template <>
+struct EnumTrait<test_namespace::Mode> {
+  constexpr static size_t num_values() { return 3; }
+  constexpr static test_namespace::Mode default_value() {
+    return test_namespace::Mode::kAuto;
+  }
+  constexpr static const char* to_string(test_namespace::Mode) {
+    return "Mode";
+  }
+};
+
+}  // namespace common
+
+namespace registry {
+
+TEST(RegistryTest, RegisterTest) {
+  Registry registry;
+  EXPECT_EQ(registry.Register<int32_t>("threads").ValueOrDie(), 0);
+  EXPECT_EQ(registry.Register<double>("ratio", 0.5).ValueOrDie(), 0.5);
+  EXPECT_EQ(registry.Register<std::string>("name").ValueOrDie(), "");
+  EXPECT_EQ(registry.Register<test_namespace::Mode>("mode").ValueOrDie(),
+            test_namespace::Mode::kAuto);
+  EXPECT_EQ(registry.size(), 4u);
+
+  // registering again keeps the value, another type is refused
+  EXPECT_EQ(registry.Register<double>("ratio", 2.0).ValueOrDie(), 0.5);
+  EXPECT_EQ(registry.Register<float>("ratio").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(registry.size(), 4u);
+}
+
+TEST(RegistryTest, GetSetTest) {
+  Registry registry;
+  registry.Register<int64_t>("limit", 10);
+  registry.Register<std::string>("path", "/tmp");
+  EXPECT_EQ(registry.Get<int64_t>("limit").ValueOrDie(), 10);
+  EXPECT_EQ(registry.Get<std::string>("path").ValueOrDie(), "/tmp");
+  EXPECT_EQ(registry.Get<int64_t>("missing").ErrorOrDie(),
+            common::Error::kNotFound);
+  EXPECT_EQ(registry.Get<int32_t>("limit").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+
+  EXPECT_EQ(registry.Set<int64_t>("limit", 20).ValueOrDie(), 10);
+  EXPECT_EQ(registry.Get<int64_t>("limit").ValueOrDie(), 20);
+  const std::string long_path = "/a/path/longer/than/the/inline/capacity";
+  EXPECT_EQ(registry.Set<std::string>("path", long_path).ValueOrDie(), "/tmp");
+  EXPECT_EQ(registry.Get<std::string>("path").ValueOrDie(), long_path);
+  EXPECT_EQ(registry.Set<int64_t>("missing", 1).ErrorOrDie(),
+            common::Error::kNotFound);
+  EXPECT_EQ(registry.Set<bool>("limit", true).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+
+  EXPECT_EQ(registry.GetValue("limit").ValueOrDie(), Value(int64_t{20}));
+  EXPECT_EQ(registry.GetValue("missing").ErrorOrDie(),
+            common::Error::kNotFound);
+}
+
+TEST(RegistryTest, HandleTest) {
+  Registry registry;
+  registry.Register<int32_t>("threads", 4);
+  registry.Register<float>("ratio", 0.25f);
+  registry.Register<test_namespace::Mode>("mode");
+  registry.Register<std::string>("name", "x");
+
+  RegistryHandle<int32_t> threads =
+      registry.Resolve<int32_t>("threads").ValueOrDie();
+  RegistryHandle<float> ratio = registry.Resolve<float>("ratio").ValueOrDie();
+  RegistryHandle<test_namespace::Mode> mode =
+      registry.Resolve<test_namespace::Mode>("mode").ValueOrDie();
+  EXPECT_EQ(threads.Get(), 4);
+  EXPECT_EQ(ratio.Get(), 0.25f);
+  EXPECT_EQ(mode.Get(), test_namespace::Mode::kAuto);
+
+  registry.Set<int32_t>("threads", -8);
+  registry.Set<float>("ratio", 1.5f);
+  registry.Set<test_namespace::Mode>("mode", test_namespace::Mode::kOn);
+  EXPECT_EQ(threads.Get(), -8);
+  EXPECT_EQ(ratio.Get(), 1.5f);
+  EXPECT_EQ(mode.Get(), test_namespace::Mode::kOn);
+
+  EXPECT_EQ(registry.Resolve<int32_t>("missing").ErrorOrDie(),
+            common::Error::kNotFound);
+  EXPECT_EQ(registry.Resolve<int64_t>("threads").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(registry.Resolve<char>("name").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+TEST(RegistryTest, HandlesSurviveGrowthTest) {
+  Registry registry;
+  registry.Register<uint64_t>("first", 7u);
+  RegistryHandle<uint64_t> first =
+      registry.Resolve<uint64_t>("first").ValueOrDie();
+  for (int32_t i = 0; i < 2000; ++i) {
+    registry.Register<int32_t>("key" + std::to_string(i), i);
+  }
+  RegistryHandle<int32_t> last =
+      registry.Resolve<int32_t>("key1999").ValueOrDie();
+  EXPECT_EQ(first.Get(), 7u);
+  EXPECT_EQ(last.Get(), 1999);
+  registry.Set<uint64_t>("first", 8u);
+  EXPECT_EQ(first.Get(), 8u);
+}
+
+TEST(RegistryTest, ManyEntriesTest) {
+  Registry registry;
+  for (int32_t i = 0; i < 1000; ++i) {
+    registry.Register<int32_t>("key" + std::to_string(i), i);
+  }
+  EXPECT_EQ(registry.size(), 1000u);
+  for (int32_t i = 0; i < 1000; ++i) {
+    EXPECT_EQ(registry.Get<int32_t>("key" + std::to_string(i)).ValueOrDie(),
+              i);
+  }
+}
+
+TEST(RegistryTest, ConcurrentTest) {
+  Registry registry;
+  registry.Register<uint64_t>("counter");
+  registry.Register<std::string>("label", "label-0");
+  const RegistryHandle<uint64_t> handle =
+      registry.Resolve<uint64_t>("counter").ValueOrDie();
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&registry, &stop, handle] {
+      uint64_t last = 0u;
+      uint64_t last_handle = 0u;
+      while (!stop.load(std::memory_order_relaxed)) {
+        const uint64_t value =
+            registry.Get<uint64_t>("counter").ValueOrDie();
+        EXPECT_GE(value, last);
+        last = value;
+        const uint64_t handle_value = handle.Get();
+        EXPECT_GE(handle_value, last_handle);
+        last_handle = handle_value;
+        EXPECT_EQ(registry.Get<std::string>("label").ValueOrDie().substr(0, 6),
+                  "label-");
+      }
+    });
+  }
+  for (uint64_t i = 1u; i <= 1000u; ++i) {
+    registry.Set<uint64_t>("counter", i);
+    registry.Set<std::string>("label", "label-" + std::to_string(i) +
+                                           "-with-a-long-suffix");
+  }
+  stop.store(true);
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(registry.Get<uint64_t>("counter").ValueOrDie(), 1000u);
+}
+
+TEST(RegistryTest, GenerationTest) {
+  Registry registry;
+  EXPECT_EQ(registry.generation(), 0u);
+  registry.Register<int32_t>("a");
+  registry.Register<int32_t>("b");
+  EXPECT_EQ(registry.generation(), 2u);
+  registry.Set<int32_t>("a", 1);
+  EXPECT_EQ(registry.generation(), 3u);
+  // failed writes and registering again publish nothing
+  registry.Set<int32_t>("missing", 1);
+  registry.Register<int32_t>("a");
+  EXPECT_EQ(registry.generation(), 3u);
+}
+
+TEST(RegistryTest, ApplyTest) {
+  Registry registry;
+  registry.Register<int32_t>("a");
+  registry.Register<std::string>("b");
+  const RegistryHandle<int32_t> handle =
+      registry.Resolve<int32_t>("a").ValueOrDie();
+  const uint64_t generation = registry.generation();
+
+  RegistryUpdate update;
+  update.Set<int32_t>("a", 1).Set<std::string>("b", "x").Set<int32_t>("a", 2);
+  EXPECT_EQ(registry.Apply(update).ValueOrDie(), 3u);
+  EXPECT_EQ(registry.generation(), generation + 1u);
+  EXPECT_EQ(registry.Get<int32_t>("a").ValueOrDie(), 2);
+  EXPECT_EQ(handle.Get(), 2);
+  EXPECT_EQ(registry.Get<std::string>("b").ValueOrDie(), "x");
+
+  // nothing is changed if any value is refused
+  RegistryUpdate missing;
+  missing.Set<int32_t>("a", 3).Set<int32_t>("missing", 3);
+  EXPECT_EQ(registry.Apply(missing).ErrorOrDie(), common::Error::kNotFound);
+  RegistryUpdate mistyped;
+  mistyped.Set<int32_t>("a", 3).Set<int32_t>("b", 3);
+  EXPECT_EQ(registry.Apply(mistyped).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(registry.Get<int32_t>("a").ValueOrDie(), 2);
+  EXPECT_EQ(registry.generation(), generation + 1u);
+  EXPECT_EQ(registry.Apply(RegistryUpdate()).ValueOrDie(), 0u);
+}
+
+TEST(RegistryTest, SubscribeTest) {
+  Registry registry;
+  registry.Register<int32_t>("a");
+  registry.Register<int32_t>("b");
+  registry.Register<double>("c");
+  std::vector<ChangeBatch<int32_t>> all;
+  std::vector<ChangeBatch<int32_t>> named;
+  std::vector<ChangeBatch<double>> doubles;
+  const Registry::SubscriptionId all_id = registry.Subscribe<int32_t>(
+      [&all](const ChangeBatch<int32_t>& batch) { all.push_back(batch); });
+  registry.Subscribe<int32_t>(
+      [&named](const ChangeBatch<int32_t>& batch) { named.push_back(batch); },
+      {"b"});
+  registry.Subscribe<double>([&doubles](const ChangeBatch<double>& batch) {
+    doubles.push_back(batch);
+  });
+
+  registry.Set<int32_t>("a", 1);
+  registry.WaitForNotifications();
+  ASSERT_EQ(all.size(), 1u);
+  EXPECT_EQ(all[0].generation, registry.generation());
+  ASSERT_EQ(all[0].changes.size(), 1u);
+  EXPECT_EQ(all[0].changes[0].first, "a");
+  EXPECT_EQ(all[0].changes[0].second, 1);
+  EXPECT_TRUE(named.empty());
+  EXPECT_TRUE(doubles.empty());
+
+  registry.Register<int32_t>("d", 4);
+  registry.Set<double>("c", 0.5);
+  registry.WaitForNotifications();
+  ASSERT_EQ(doubles.size(), 1u);
+  EXPECT_EQ(doubles[0].changes[0].second, 0.5);
+  size_t changes = 0u;
+  for (const ChangeBatch<int32_t>& batch : all) {
+    changes += batch.changes.size();
+  }
+  EXPECT_EQ(changes, 2u);
+  EXPECT_EQ(all.back().changes.back().first, "d");
+
+  registry.Unsubscribe(all_id);
+  registry.Set<int32_t>("a", 2);
+  registry.Set<int32_t>("b", 2);
+  registry.WaitForNotifications();
+  EXPECT_EQ(all.back().changes.back().first, "d");
+  ASSERT_FALSE(named.empty());
+  EXPECT_EQ(named.back().changes[0].first, "b");
+  EXPECT_EQ(named.back().changes[0].second, 2);
+}
+
+TEST(RegistryTest, CoalescedNotificationTest) {
+  constexpr int kCount = 10000;
+  Registry registry;
+  RegistryUpdate update;
+  for (int i = 0; i < kCount; ++i) {
+    registry.Register<int32_t>("value-" + std::to_string(i));
+    update.Set<int32_t>("value-" + std::to_string(i), i);
+    update.Set<int32_t>("value-" + std::to_string(i), i + 1);
+  }
+  std::atomic<int> batches{0};
+  std::vector<std::pair<std::string, int32_t>> changes;
+  registry.Subscribe<int32_t>([&](const ChangeBatch<int32_t>& batch) {
+    batches.fetch_add(1);
+    changes = batch.changes;
+  });
+  EXPECT_EQ(registry.Apply(update).ValueOrDie(), 2u * kCount);
+  registry.WaitForNotifications();
+  EXPECT_EQ(batches.load(), 1);
+  ASSERT_EQ(changes.size(), static_cast<size_t>(kCount));
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(changes[i].second, i + 1);
+  }
+
+  // separate writes coalesce into at most one wave each, and the last wave
+  // holds the last values
+  std::mutex mutex;
+  std::vector<int32_t> seen;
+  registry.Subscribe<int32_t>(
+      [&](const ChangeBatch<int32_t>& batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.push_back(batch.changes[0].second);
+      },
+      {"value-0"});
+  for (int i = 0; i < 1000; ++i) {
+    registry.Set<int32_t>("value-0", -i);
+  }
+  registry.WaitForNotifications();
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_FALSE(seen.empty());
+  EXPECT_LE(seen.size(), 1000u);
+  EXPECT_EQ(seen.back(), -999);
+}
+
+TEST(RegistryTest, CallbackWritesTest) {
+  Registry registry;
+  registry.Register<int32_t>("source");
+  registry.Register<int32_t>("mirror");
+  registry.Subscribe<int32_t>(
+      [&registry](const ChangeBatch<int32_t>& batch) {
+        registry.Set<int32_t>("mirror", batch.changes[0].second);
+      },
+      {"source"});
+  registry.Set<int32_t>("source", 7);
+  registry.WaitForNotifications();
+  // the mirror write is published by the callback before its wave ends
+  EXPECT_EQ(registry.Get<int32_t>("mirror").ValueOrDie(), 7);
+}
+
+}  // namespace registry
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <string>
+#include <type_traits>
 
 #include "common/enum_traits.h"
 
@@ -26,8 +27,8 @@ struct TypeTrait;
 
 template <>
 struct TypeTrait<int32_t> {
-  const static TypeEnum type = TypeEnum::kFloat;
-  const static int32_t default_value = 0;
+  constexpr static TypeEnum type = TypeEnum::kInt32;
+  constexpr static int32_t default_value = 0;
 };
 
 template <>
@@ -57,11 +58,13 @@ struct TypeTrait<bool> {
 template <>
 struct TypeTrait<char> {
   constexpr static TypeEnum type = TypeEnum::kChar;
+  constexpr static char default_value = '\0';
 };
 
 template <>
 struct TypeTrait<std::string> {
   constexpr static TypeEnum type = TypeEnum::kString;
+  constexpr static const char* default_value = "";
 };
 
 template <>
@@ -0,0 +1,36 @@
+#include "common/value.h"
+
+namespace registry {
+
+bool operator==(const Value& a, const Value& b) {
+  if (a.type_ != b.type_) {
+    return false;
+  }
+  switch (a.type_) {
+    case TypeEnum::kInt32:
+      return a.storage_.i32 == b.storage_.i32;
+    case TypeEnum::kUnsignedInt32:
+      return a.storage_.u32 == b.storage_.u32;
+    case TypeEnum::kInt64:
+      return a.storage_.i64 == b.storage_.i64;
+    case TypeEnum::kUnsignedInt64:
+      return a.storage_.u64 == b.storage_.u64;
+    case TypeEnum::kBoolean:
+      return a.storage_.boolean == b.storage_.boolean;
+    case TypeEnum::kChar:
+      return a.storage_.character == b.storage_.character;
+    case TypeEnum::kString:
+      return a.StringView() == b.StringView();
+    case TypeEnum::kFloat:
+      return a.storage_.f == b.storage_.f;
+    case TypeEnum::kDouble:
+      return a.storage_.d == b.storage_.d;
+    case TypeEnum::kEnum:
+      return a.storage_.enumeration.type == b.storage_.enumeration.type &&
+             a.storage_.enumeration.value == b.storage_.enumeration.value;
+      // no default. Let -werror=switch catch missing enum cases
+  }
+  return false;
+}
+
+}  // namespace registry
@@ -0,0 +1,280 @@
+#ifndef REGISTRY_VALUE_H_
+#define REGISTRY_VALUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "common/error.h"
+#include "common/error_or.h"
+#include "common/type_traits.h"
+
+namespace registry {
+namespace internal {
+
+template <typename T>
+struct IsScalarValue
+    : std::integral_constant<
+          bool, std::is_same<T, int32_t>::value ||
+                    std::is_same<T, uint32_t>::value ||
+                    std::is_same<T, int64_t>::value ||
+                    std::is_same<T, uint64_t>::value ||
+                    std::is_same<T, bool>::value ||
+                    std::is_same<T, char>::value ||
+                    std::is_same<T, float>::value ||
+                    std::is_same<T, double>::value || std::is_enum<T>::value> {
+};
+
+// One address per enum type, tells enums apart within TypeEnum::kEnum
+template <typename T>
+struct EnumTypeId {
+  static constexpr char kId = 0;
+};
+
+}  // namespace internal
+
+/// @class Value
+/// Holds a value of any type with a TypeTrait: the scalars, std::string and
+/// enums. Scalars and enums are stored inline and never allocate; strings of
+/// up to kInlineStringCapacity characters are stored inline too. Copying a
+/// value that is not a heap allocated string copies its bytes.
+class Value {
+ public:
+  constexpr static std::size_t kInlineStringCapacity = 15u;
+
+  /// TypeTrait<int32_t>::default_value
+  Value() : type_(TypeEnum::kInt32), heap_(false) { storage_.u64 = 0u; }
+
+  template <typename T, typename = typename std::enable_if<
+                            internal::IsScalarValue<T>::value>::type>
+  Value(T value) : type_(TypeTrait<T>::type), heap_(false) {
+    // narrower types leave no stale bytes in Bits()
+    storage_.u64 = 0u;
+    Store(value);
+  }
+
+  Value(std::string_view value) : type_(TypeEnum::kString) {
+    StoreString(value);
+  }
+  Value(const char* value) : Value(std::string_view(value)) {}
+  Value(const std::string& value) : Value(std::string_view(value)) {}
+
+  Value(const Value& other) : type_(other.type_), heap_(false) {
+    if (other.heap_) {
+      StoreString(other.StringView());
+    } else {
+      storage_ = other.storage_;
+    }
+  }
+
+  Value(Value&& other) noexcept
+      : type_(other.type_), heap_(other.heap_), storage_(other.storage_) {
+    if (other.heap_) {
+      // other keeps a valid, empty, inline string
+      other.heap_ = false;
+      other.storage_.small.size = 0u;
+    }
+  }
+
+  ~Value() {
+    if (heap_) {
+      delete[] storage_.large.data;
+    }
+  }
+
+  Value& operator=(const Value& other) {
+    if (this != &other) {
+      Value copy(other);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  Value& operator=(Value&& other) noexcept {
+    if (this != &other) {
+      if (heap_) {
+        delete[] storage_.large.data;
+      }
+      type_ = other.type_;
+      heap_ = other.heap_;
+      storage_ = other.storage_;
+      if (other.heap_) {
+        other.heap_ = false;
+        other.storage_.small.size = 0u;
+      }
+    }
+    return *this;
+  }
+
+  TypeEnum type() const { return type_; }
+
+  /// @return  true if both values hold the same type, including the enum
+  bool HasSameType(const Value& other) const {
+    return type_ == other.type_ &&
+           (type_ != TypeEnum::kEnum ||
+            storage_.enumeration.type == other.storage_.enumeration.type);
+  }
+
+  /// @return  true if the value holds a T. Enums must match exactly.
+  template <typename T>
+  bool Is() const {
+    if constexpr (std::is_same<T, std::string_view>::value) {
+      return type_ == TypeEnum::kString;
+    } else if constexpr (std::is_enum<T>::value) {
+      return type_ == TypeEnum::kEnum &&
+             storage_.enumeration.type == &internal::EnumTypeId<T>::kId;
+    } else {
+      return type_ == TypeTrait<T>::type;
+    }
+  }
+
+  /// Typed access, checked against TypeTrait<T>::type. T may also be
+  /// std::string_view, which views a string without copying it and is valid
+  /// until the value changes.
+  /// @return  the value, or Error::kInvalidArgument if it holds another type
+  template <typename T>
+  common::ErrorOr<T> Get() const {
+    static_assert(!std::is_same<T, common::Error>::value,
+                  "ErrorOr<Error> is ambiguous");
+    if (!Is<T>()) {
+      return common::Error::kInvalidArgument;
+    }
+    if constexpr (std::is_same<T, std::string>::value ||
+                  std::is_same<T, std::string_view>::value) {
+      return T(StringView());
+    } else {
+      return Load<T>();
+    }
+  }
+
+  /// The 64 bit payload of a value that is not a string, which FromBits()
+  /// turns back into a T. Lets scalars be kept in a std::atomic<uint64_t>.
+  uint64_t Bits() const { return storage_.u64; }
+
+  /// @param bits  Bits() of a value holding a T
+  template <typename T>
+  static T FromBits(uint64_t bits) {
+    static_assert(internal::IsScalarValue<T>::value, "T must be a scalar");
+    Value value;
+    value.storage_.u64 = bits;
+    if constexpr (std::is_same<T, bool>::value) {
+      // bits may come from a corrupt snapshot, loading a bool that is
+      // neither 0 nor 1 is undefined
+      unsigned char byte;
+      std::memcpy(&byte, &value.storage_.boolean, 1u);
+      return byte != 0u;
+    } else {
+      return value.Load<T>();
+    }
+  }
+
+  friend bool operator==(const Value& a, const Value& b);
+  friend bool operator!=(const Value& a, const Value& b) { return !(a == b); }
+
+ private:
+  struct Enumeration {
+    int64_t value;
+    const void* type;
+  };
+
+  struct SmallString {
+    char chars[kInlineStringCapacity];
+    uint8_t size;
+  };
+
+  struct LargeString {
+    char* data;
+    std::size_t size;
+  };
+
+  union Storage {
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    bool boolean;
+    char character;
+    float f;
+    double d;
+    Enumeration enumeration;
+    SmallString small;
+    LargeString large;
+  };
+
+  template <typename T>
+  void Store(T value) {
+    if constexpr (std::is_enum<T>::value) {
+      storage_.enumeration.value = static_cast<int64_t>(value);
+      storage_.enumeration.type = &internal::EnumTypeId<T>::kId;
+    } else if constexpr (std::is_same<T, int32_t>::value) {
+      storage_.i32 = value;
+    } else if constexpr (std::is_same<T, uint32_t>::value) {
+      storage_.u32 = value;
+    } else if constexpr (std::is_same<T, int64_t>::value) {
+      storage_.i64 = value;
+    } else if constexpr (std::is_same<T, uint64_t>::value) {
+      storage_.u64 = value;
+    } else if constexpr (std::is_same<T, bool>::value) {
+      storage_.boolean = value;
+    } else if constexpr (std::is_same<T, char>::value) {
+      storage_.character = value;
+    } else if constexpr (std::is_same<T, float>::value) {
+      storage_.f = value;
+    } else {
+      storage_.d = value;
+    }
+  }
+
+  template <typename T>
+  T Load() const {
+    if constexpr (std::is_enum<T>::value) {
+      return static_cast<T>(storage_.enumeration.value);
+    } else if constexpr (std::is_same<T, int32_t>::value) {
+      return storage_.i32;
+    } else if constexpr (std::is_same<T, uint32_t>::value) {
+      return storage_.u32;
+    } else if constexpr (std::is_same<T, int64_t>::value) {
+      return storage_.i64;
+    } else if constexpr (std::is_same<T, uint64_t>::value) {
+      return storage_.u64;
+    } else if constexpr (std::is_same<T, bool>::value) {
+      return storage_.boolean;
+    } else if constexpr (std::is_same<T, char>::value) {
+      return storage_.character;
+    } else if constexpr (std::is_same<T, float>::value) {
+      return storage_.f;
+    } else {
+      return storage_.d;
+    }
+  }
+
+  // sets heap_ and storage_, type_ must already be kString
+  void StoreString(std::string_view value) {
+    heap_ = value.size() > kInlineStringCapacity;
+    if (heap_) {
+      storage_.large.data = new char[value.size()];
+      storage_.large.size = value.size();
+      std::memcpy(storage_.large.data, value.data(), value.size());
+    } else {
+      storage_.small.size = static_cast<uint8_t>(value.size());
+      std::memcpy(storage_.small.chars, value.data(), value.size());
+    }
+  }
+
+  std::string_view StringView() const {
+    return heap_ ? std::string_view(storage_.large.data, storage_.large.size)
+                 : std::string_view(storage_.small.chars, storage_.small.size);
+  }
+
+  TypeEnum type_;
+  // kString stored in storage_.large
+  bool heap_;
+  Storage storage_;
+};
+
+}  // namespace registry
+
+#endif  // REGISTRY_VALUE_H_
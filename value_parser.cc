@@ -0,0 +1,45 @@
+#include "common/value_parser.h"
+
+namespace registry {
+
+namespace {
+
+template <typename T>
+common::ErrorOr<Value> ParseAs(std::string_view text) {
+  common::ErrorOr<T> value = ParseValue<T>(text);
+  if (value.HasError()) {
+    return value.ErrorOrDie();
+  }
+  return Value(value.ValueOrDie());
+}
+
+}  // namespace
+
+common::ErrorOr<Value> ParseValue(TypeEnum type, std::string_view text) {
+  switch (type) {
+    case TypeEnum::kInt32:
+      return ParseAs<int32_t>(text);
+    case TypeEnum::kUnsignedInt32:
+      return ParseAs<uint32_t>(text);
+    case TypeEnum::kInt64:
+      return ParseAs<int64_t>(text);
+    case TypeEnum::kUnsignedInt64:
+      return ParseAs<uint64_t>(text);
+    case TypeEnum::kBoolean:
+      return ParseAs<bool>(text);
+    case TypeEnum::kChar:
+      return ParseAs<char>(text);
+    case TypeEnum::kString:
+      return Value(text);
+    case TypeEnum::kFloat:
+      return ParseAs<float>(text);
+    case TypeEnum::kDouble:
+      return ParseAs<double>(text);
+    case TypeEnum::kEnum:
+      return common::Error::kInvalidArgument;
+      // no default. Let -werror=switch catch missing enum cases
+  }
+  return common::Error::kInvalidArgument;
+}
+
+}  // namespace registry
@@ -0,0 +1,168 @@
+#ifndef REGISTRY_VALUE_PARSER_H_
+#define REGISTRY_VALUE_PARSER_H_
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "common/enum_from_string.h"
+#include "common/error.h"
+#include "common/error_or.h"
+#include "common/error_or_batch.h"
+#include "common/type_traits.h"
+#include "common/value.h"
+
+namespace registry {
+namespace internal {
+
+template <typename T>
+common::ErrorOr<T> ParseNumber(std::string_view text) {
+  const char* begin = text.data();
+  const char* end = text.data() + text.size();
+  // from_chars takes no '+', but a minus sign on an unsigned number must
+  // still be rejected
+  if (begin != end && *begin == '+' && end - begin > 1 && begin[1] != '-') {
+    ++begin;
+  }
+  T value{};
+  const std::from_chars_result result = std::from_chars(begin, end, value);
+  if (result.ec == std::errc::result_out_of_range) {
+    return common::Error::kOutOfRange;
+  }
+  if (result.ec != std::errc() || result.ptr != end) {
+    return common::Error::kInvalidArgument;
+  }
+  return value;
+}
+
+}  // namespace internal
+
+/// Parses the text form of a T, for every type with a TypeTrait and for
+/// std::string_view. Parsing is locale independent and does not allocate,
+/// except to return a std::string. The text must hold exactly the value, with
+/// no surrounding whitespace:
+///   integers  decimal, optionally signed
+///   floating  std::from_chars general format, e.g. "1.5", "-2e10", "inf"
+///   bool      "true", "false", "1" or "0"
+///   char      a single character
+///   string    the text itself
+///   enum      EnumTrait<T>::to_string() of a value, see FromString()
+/// @return  the value, Error::kOutOfRange if a number does not fit in T or
+///          Error::kInvalidArgument if the text is not a T
+template <typename T>
+common::ErrorOr<T> ParseValue(std::string_view text) {
+  static_assert(!std::is_same<T, common::Error>::value,
+                "ErrorOr<Error> is ambiguous");
+  if constexpr (std::is_same<T, std::string_view>::value ||
+                std::is_same<T, std::string>::value) {
+    return T(text);
+  } else if constexpr (std::is_same<T, bool>::value) {
+    if (text == "true" || text == "1") {
+      return true;
+    }
+    if (text == "false" || text == "0") {
+      return false;
+    }
+    return common::Error::kInvalidArgument;
+  } else if constexpr (std::is_same<T, char>::value) {
+    if (text.size() != 1u) {
+      return common::Error::kInvalidArgument;
+    }
+    return text[0];
+  } else if constexpr (std::is_enum<T>::value) {
+    common::ErrorOr<T> value = common::FromString<T>(text);
+    if (value.HasError()) {
+      return common::Error::kInvalidArgument;
+    }
+    return value;
+  } else {
+    static_assert(internal::IsScalarValue<T>::value,
+                  "T must have a TypeTrait");
+    return internal::ParseNumber<T>(text);
+  }
+}
+
+/// Parses @p text as a value of @p type. Enums need their type, parse them
+/// with ParseValue<T>() instead.
+/// @return  the value, Error::kOutOfRange or Error::kInvalidArgument as for
+///          ParseValue<T>(), which is also returned for TypeEnum::kEnum
+common::ErrorOr<Value> ParseValue(TypeEnum type, std::string_view text);
+
+/// Calls @p f with each line of @p buffer, without its line break ("\n" or
+/// "\r\n"). A line break at the end of the buffer does not start another
+/// line.
+template <typename F>
+void ForEachLine(std::string_view buffer, F&& f) {
+  const char* begin = buffer.data();
+  const char* const end = buffer.data() + buffer.size();
+  while (begin != end) {
+    const char* newline = static_cast<const char*>(
+        std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+    const char* line_end = newline != nullptr ? newline : end;
+    std::size_t size = static_cast<std::size_t>(line_end - begin);
+    if (size != 0u && begin[size - 1u] == '\r') {
+      --size;
+    }
+    f(std::string_view(begin, size));
+    begin = newline != nullptr ? newline + 1 : end;
+  }
+}
+
+/// Parses every line of @p buffer as a T in one pass, see ParseValue<T>()
+/// @return  one value or error per line, in order
+template <typename T>
+common::ErrorOrBatch<T, common::Error> ParseLines(std::string_view buffer) {
+  common::ErrorOrBatch<T, common::Error> batch;
+  ForEachLine(buffer, [&batch](std::string_view line) {
+    batch.PushBack(ParseValue<T>(line));
+  });
+  return batch;
+}
+
+/// Calls @p f(key, value) for each "key=value" line of @p buffer, with
+/// spaces and tabs around the key and the value removed. Empty lines and
+/// lines starting with '#' are skipped.
+/// @return  the number of lines passed to @p f, or Error::kInvalidArgument
+///          at the first line without '=' or with an empty key
+template <typename F>
+common::ErrorOr<std::size_t> ForEachKeyValue(std::string_view buffer, F&& f) {
+  constexpr std::string_view kBlank = " \t";
+  const auto trim = [kBlank](std::string_view text) {
+    const std::size_t first = text.find_first_not_of(kBlank);
+    if (first == std::string_view::npos) {
+      return std::string_view();
+    }
+    return text.substr(first, text.find_last_not_of(kBlank) - first + 1u);
+  };
+  std::size_t count = 0u;
+  bool valid = true;
+  ForEachLine(buffer, [&](std::string_view line) {
+    line = trim(line);
+    if (!valid || line.empty() || line[0] == '#') {
+      return;
+    }
+    const std::size_t equals = line.find('=');
+    const std::string_view key =
+        equals == std::string_view::npos ? std::string_view()
+                                         : trim(line.substr(0, equals));
+    if (key.empty()) {
+      valid = false;
+      return;
+    }
+    f(key, trim(line.substr(equals + 1u)));
+    ++count;
+  });
+  if (!valid) {
+    return common::Error::kInvalidArgument;
+  }
+  return count;
+}
+
+}  // namespace registry
+
+#endif  // REGISTRY_VALUE_PARSER_H_
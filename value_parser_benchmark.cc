@@ -0,0 +1,107 @@
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/value_parser.h"
+
+namespace registry {
+namespace {
+
+constexpr int kLines = 100000;
+
+const std::string& IntegerLines() {
+  static const std::string* lines = [] {
+    std::mt19937_64 random(1);
+    std::string* text = new std::string();
+    for (int i = 0; i < kLines; ++i) {
+      *text += std::to_string(static_cast<int64_t>(random()) >> (i % 48));
+      *text += '\n';
+    }
+    return text;
+  }();
+  return *lines;
+}
+
+const std::string& DoubleLines() {
+  static const std::string* lines = [] {
+    std::mt19937_64 random(2);
+    std::uniform_real_distribution<double> distribution(-1e6, 1e6);
+    std::string* text = new std::string();
+    for (int i = 0; i < kLines; ++i) {
+      *text += std::to_string(distribution(random));
+      *text += '\n';
+    }
+    return text;
+  }();
+  return *lines;
+}
+
+void BM_ParseLinesInt64(benchmark::State& state) {
+  const std::string& text = IntegerLines();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseLines<int64_t>(text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseLinesInt64);
+
+// the same lines without building a batch
+void BM_ParseValueInt64(benchmark::State& state) {
+  const std::string& text = IntegerLines();
+  for (auto _ : state) {
+    int64_t sum = 0;
+    ForEachLine(text, [&sum](std::string_view line) {
+      sum += ParseValue<int64_t>(line).ValueOrDie();
+    });
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseValueInt64);
+
+void BM_StrtollInt64(benchmark::State& state) {
+  const std::string& text = IntegerLines();
+  for (auto _ : state) {
+    int64_t sum = 0;
+    const char* begin = text.c_str();
+    const char* end = begin + text.size();
+    while (begin < end) {
+      char* next = nullptr;
+      sum += std::strtoll(begin, &next, 10);
+      begin = next + 1;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_StrtollInt64);
+
+void BM_ParseLinesDouble(benchmark::State& state) {
+  const std::string& text = DoubleLines();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ParseLines<double>(text));
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseLinesDouble);
+
+void BM_StrtodDouble(benchmark::State& state) {
+  const std::string& text = DoubleLines();
+  for (auto _ : state) {
+    double sum = 0;
+    const char* begin = text.c_str();
+    const char* end = begin + text.size();
+    while (begin < end) {
+      char* next = nullptr;
+      sum += std::strtod(begin, &next);
+      begin = next + 1;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_StrtodDouble);
+
+}  // namespace
+}  // namespace registry
@@ -0,0 +1,145 @@
+#include "common/value_parser.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/enum_reflection.h"
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Codec { kNone, kGzip, kZstd };
+
+}  // namespace test_namespace
+
+COMMON_REFLECT_ENUM(test_namespace::Codec, test_namespace::Codec::kNone)
+
+namespace registry {
+
+namespace {
+
+template <typename T>
+common::Error ParseError(std::string_view text) {
+  return ParseValue<T>(text).ErrorOrDie();
+}
+
+}  // namespace
+
+TEST(ValueParserTest, IntegerTest) {
+  EXPECT_EQ(ParseValue<int32_t>("42").ValueOrDie(), 42);
+  EXPECT_EQ(ParseValue<int32_t>("-42").ValueOrDie(), -42);
+  EXPECT_EQ(ParseValue<int32_t>("+42").ValueOrDie(), 42);
+  EXPECT_EQ(ParseValue<int32_t>("-2147483648").ValueOrDie(),
+            std::numeric_limits<int32_t>::min());
+  EXPECT_EQ(ParseError<int32_t>("2147483648"), common::Error::kOutOfRange);
+  EXPECT_EQ(ParseValue<uint32_t>("4294967295").ValueOrDie(), 4294967295u);
+  EXPECT_EQ(ParseError<uint32_t>("4294967296"), common::Error::kOutOfRange);
+  EXPECT_EQ(ParseError<uint32_t>("-1"), common::Error::kInvalidArgument);
+  EXPECT_EQ(ParseError<uint32_t>("+-1"), common::Error::kInvalidArgument);
+  EXPECT_EQ(ParseValue<int64_t>("-9223372036854775808").ValueOrDie(),
+            std::numeric_limits<int64_t>::min());
+  EXPECT_EQ(ParseValue<uint64_t>("18446744073709551615").ValueOrDie(),
+            std::numeric_limits<uint64_t>::max());
+  EXPECT_EQ(ParseError<uint64_t>("18446744073709551616"),
+            common::Error::kOutOfRange);
+
+  for (const char* text : {"", "+", "-", " 1", "1 ", "1x", "0x10", "1.0"}) {
+    EXPECT_EQ(ParseError<int32_t>(text), common::Error::kInvalidArgument)
+        << text;
+  }
+}
+
+TEST(ValueParserTest, FloatingTest) {
+  EXPECT_EQ(ParseValue<float>("1.5").ValueOrDie(), 1.5f);
+  EXPECT_EQ(ParseValue<double>("-2.25e3").ValueOrDie(), -2250.0);
+  EXPECT_EQ(ParseValue<double>("+0.5").ValueOrDie(), 0.5);
+  EXPECT_TRUE(std::isinf(ParseValue<double>("inf").ValueOrDie()));
+  EXPECT_EQ(ParseError<float>("1e60"), common::Error::kOutOfRange);
+  EXPECT_EQ(ParseError<double>("1.5.2"), common::Error::kInvalidArgument);
+  EXPECT_EQ(ParseError<double>(""), common::Error::kInvalidArgument);
+}
+
+TEST(ValueParserTest, OtherTypesTest) {
+  EXPECT_TRUE(ParseValue<bool>("true").ValueOrDie());
+  EXPECT_TRUE(ParseValue<bool>("1").ValueOrDie());
+  EXPECT_FALSE(ParseValue<bool>("false").ValueOrDie());
+  EXPECT_FALSE(ParseValue<bool>("0").ValueOrDie());
+  EXPECT_EQ(ParseError<bool>("True"), common::Error::kInvalidArgument);
+
+  EXPECT_EQ(ParseValue<char>("x").ValueOrDie(), 'x');
+  EXPECT_EQ(ParseError<char>("xy"), common::Error::kInvalidArgument);
+  EXPECT_EQ(ParseError<char>(""), common::Error::kInvalidArgument);
+
+  EXPECT_EQ(ParseValue<std::string>(" as is ").ValueOrDie(), " as is ");
+  EXPECT_EQ(ParseValue<std::string_view>("").ValueOrDie(), "");
+
+  EXPECT_EQ(ParseValue<test_namespace::Codec>("kZstd").ValueOrDie(),
+            test_namespace::Codec::kZstd);
+  EXPECT_EQ(ParseError<test_namespace::Codec>("zstd"),
+            common::Error::kInvalidArgument);
+}
+
+TEST(ValueParserTest, TypeEnumTest) {
+  EXPECT_EQ(ParseValue(TypeEnum::kInt32, "-7").ValueOrDie(),
+            Value(int32_t{-7}));
+  EXPECT_EQ(ParseValue(TypeEnum::kUnsignedInt64, "7").ValueOrDie(),
+            Value(uint64_t{7}));
+  EXPECT_EQ(ParseValue(TypeEnum::kDouble, "0.25").ValueOrDie(), Value(0.25));
+  EXPECT_EQ(ParseValue(TypeEnum::kString, "text").ValueOrDie(), Value("text"));
+  EXPECT_EQ(ParseValue(TypeEnum::kChar, "c").ValueOrDie(), Value('c'));
+  EXPECT_EQ(ParseValue(TypeEnum::kInt32, "4294967296").ErrorOrDie(),
+            common::Error::kOutOfRange);
+  EXPECT_EQ(ParseValue(TypeEnum::kEnum, "kZstd").ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+TEST(ValueParserTest, ParseLinesTest) {
+  const common::ErrorOrBatch<int64_t, common::Error> batch =
+      ParseLines<int64_t>("1\n-2\r\nthree\n\n99999999999999999999\n5\n");
+  ASSERT_EQ(batch.size(), 6u);
+  EXPECT_EQ(batch.ValueOrDie(0), 1);
+  EXPECT_EQ(batch.ValueOrDie(1), -2);
+  EXPECT_EQ(batch.ErrorOrDie(2), common::Error::kInvalidArgument);
+  EXPECT_EQ(batch.ErrorOrDie(3), common::Error::kInvalidArgument);
+  EXPECT_EQ(batch.ErrorOrDie(4), common::Error::kOutOfRange);
+  EXPECT_EQ(batch.ValueOrDie(5), 5);
+  EXPECT_EQ(batch.ErrorCount(), 3u);
+
+  EXPECT_EQ(ParseLines<int32_t>("").size(), 0u);
+  EXPECT_EQ(ParseLines<int32_t>("7").size(), 1u);
+}
+
+TEST(ValueParserTest, KeyValueTest) {
+  std::vector<std::pair<std::string, std::string>> entries;
+  const auto collect = [&entries](std::string_view key,
+                                  std::string_view value) {
+    entries.emplace_back(std::string(key), std::string(value));
+  };
+  EXPECT_EQ(ForEachKeyValue("# comment\n"
+                            "threads = 8\n"
+                            "\n"
+                            "  name=\tserver one \r\n"
+                            "empty=\n"
+                            "url=a=b",
+                            collect)
+                .ValueOrDie(),
+            4u);
+  ASSERT_EQ(entries.size(), 4u);
+  EXPECT_EQ(entries[0], std::make_pair(std::string("threads"),
+                                       std::string("8")));
+  EXPECT_EQ(entries[1], std::make_pair(std::string("name"),
+                                       std::string("server one")));
+  EXPECT_EQ(entries[2], std::make_pair(std::string("empty"), std::string()));
+  EXPECT_EQ(entries[3], std::make_pair(std::string("url"),
+                                       std::string("a=b")));
+
+  EXPECT_EQ(ForEachKeyValue("a=1\nno equals\nb=2", collect).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(ForEachKeyValue(" = 1", collect).ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+}  // namespace registry
@@ -0,0 +1,126 @@
+#include "common/value.h"
+
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace test_namespace {
+
+enum class Color { kRed, kGreen, kBlue };
+
+enum class Shape : uint8_t { kCircle, kSquare };
+
+}  // namespace test_namespace
+
+namespace registry {
+
+TEST(ValueTest, SizeTest) {
+  static_assert(sizeof(Value) <= 24u, "");
+  EXPECT_EQ(Value().type(), TypeEnum::kInt32);
+  EXPECT_EQ(Value().Get<int32_t>().ValueOrDie(),
+            TypeTrait<int32_t>::default_value);
+}
+
+TEST(ValueTest, ScalarTest) {
+  EXPECT_EQ(Value(int32_t{-3}).Get<int32_t>().ValueOrDie(), -3);
+  EXPECT_EQ(Value(uint32_t{3}).Get<uint32_t>().ValueOrDie(), 3u);
+  EXPECT_EQ(Value(-(int64_t{1} << 40)).Get<int64_t>().ValueOrDie(),
+            -(int64_t{1} << 40));
+  EXPECT_EQ(Value(~uint64_t{0}).Get<uint64_t>().ValueOrDie(), ~uint64_t{0});
+  EXPECT_TRUE(Value(true).Get<bool>().ValueOrDie());
+  EXPECT_EQ(Value('x').Get<char>().ValueOrDie(), 'x');
+  EXPECT_EQ(Value(1.5f).Get<float>().ValueOrDie(), 1.5f);
+  EXPECT_EQ(Value(2.25).Get<double>().ValueOrDie(), 2.25);
+
+  EXPECT_EQ(Value(1.5f).type(), TypeEnum::kFloat);
+  EXPECT_EQ(Value(int32_t{1}).type(), TypeEnum::kInt32);
+  EXPECT_EQ(Value(true).type(), TypeEnum::kBoolean);
+}
+
+TEST(ValueTest, TypeMismatchTest) {
+  const Value value(int32_t{7});
+  EXPECT_TRUE(value.Is<int32_t>());
+  EXPECT_FALSE(value.Is<int64_t>());
+  EXPECT_EQ(value.Get<int64_t>().ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(value.Get<float>().ErrorOrDie(), common::Error::kInvalidArgument);
+  EXPECT_EQ(value.Get<std::string>().ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(Value("7").Get<int32_t>().ErrorOrDie(),
+            common::Error::kInvalidArgument);
+}
+
+TEST(ValueTest, EnumTest) {
+  const Value value(test_namespace::Color::kBlue);
+  EXPECT_EQ(value.type(), TypeEnum::kEnum);
+  EXPECT_TRUE(value.Is<test_namespace::Color>());
+  EXPECT_FALSE(value.Is<test_namespace::Shape>());
+  EXPECT_EQ(value.Get<test_namespace::Color>().ValueOrDie(),
+            test_namespace::Color::kBlue);
+  EXPECT_EQ(value.Get<test_namespace::Shape>().ErrorOrDie(),
+            common::Error::kInvalidArgument);
+  EXPECT_EQ(value, Value(test_namespace::Color::kBlue));
+  EXPECT_NE(value, Value(test_namespace::Color::kRed));
+  // same underlying value, different enum
+  EXPECT_NE(Value(test_namespace::Color::kGreen),
+            Value(test_namespace::Shape::kSquare));
+}
+
+TEST(ValueTest, StringTest) {
+  const std::string small = "short";
+  const std::string large = "longer than the inline capacity";
+  static_assert(Value::kInlineStringCapacity < 31u, "");
+
+  Value a(small);
+  Value b(large);
+  EXPECT_EQ(a.type(), TypeEnum::kString);
+  EXPECT_EQ(a.Get<std::string>().ValueOrDie(), small);
+  EXPECT_EQ(b.Get<std::string>().ValueOrDie(), large);
+  EXPECT_EQ(b.Get<std::string_view>().ValueOrDie(), large);
+  EXPECT_EQ(Value("").Get<std::string>().ValueOrDie(), "");
+  EXPECT_EQ(Value(std::string(Value::kInlineStringCapacity, 'a'))
+                .Get<std::string>()
+                .ValueOrDie(),
+            std::string(Value::kInlineStringCapacity, 'a'));
+
+  Value copy(b);
+  EXPECT_EQ(copy, b);
+  EXPECT_NE(copy.Get<std::string_view>().ValueOrDie().data(),
+            b.Get<std::string_view>().ValueOrDie().data());
+
+  Value moved(std::move(copy));
+  EXPECT_EQ(moved.Get<std::string>().ValueOrDie(), large);
+
+  a = b;
+  EXPECT_EQ(a.Get<std::string>().ValueOrDie(), large);
+  b = Value(int64_t{5});
+  EXPECT_EQ(b.Get<int64_t>().ValueOrDie(), 5);
+  a = small;
+  EXPECT_EQ(a.Get<std::string>().ValueOrDie(), small);
+  a = std::move(moved);
+  EXPECT_EQ(a.Get<std::string>().ValueOrDie(), large);
+  const Value& self = a;
+  a = self;
+  EXPECT_EQ(a.Get<std::string>().ValueOrDie(), large);
+}
+
+TEST(ValueTest, EqualityTest) {
+  EXPECT_EQ(Value(int32_t{1}), Value(int32_t{1}));
+  EXPECT_NE(Value(int32_t{1}), Value(int64_t{1}));
+  EXPECT_NE(Value(int32_t{1}), Value(int32_t{2}));
+  EXPECT_EQ(Value("abc"), Value(std::string("abc")));
+  EXPECT_NE(Value("abc"), Value("abd"));
+}
+
+TEST(ValueTest, HasSameTypeTest) {
+  EXPECT_TRUE(Value(int32_t{1}).HasSameType(Value(int32_t{2})));
+  EXPECT_FALSE(Value(int32_t{1}).HasSameType(Value(uint32_t{1})));
+  EXPECT_TRUE(Value("a").HasSameType(Value(std::string(40, 'b'))));
+  EXPECT_TRUE(Value(test_namespace::Color::kRed)
+                  .HasSameType(Value(test_namespace::Color::kBlue)));
+  EXPECT_FALSE(Value(test_namespace::Color::kRed)
+                   .HasSameType(Value(test_namespace::Shape::kCircle)));
+}
+
+}  // namespace registry